@@ -11,6 +11,7 @@ endif()
 # ----------------------------------------------------------------------------
 # Set options
 option(ENABLE_KOOLANG_TESTING "Build and run tests")
+option(ENABLE_KOOLANG_ALLOC_STATS "Count the heap allocations for --stats")
 
 # -----------------------------------------------------------------------------
 # Set policy
@@ -48,7 +49,8 @@ function(target_compiler_settings target)
     target_compile_definitions(
     ${target}
     PRIVATE $<$<CONFIG:Debug>:KOOLANG_DEBUG_MODE>
-            $<$<CONFIG:RelWithDebugInfo>:KOOLANG_DEBUG_MODE> VERSION="1.0")
+            $<$<CONFIG:RelWithDebugInfo>:KOOLANG_DEBUG_MODE>
+            $<$<BOOL:${ENABLE_KOOLANG_ALLOC_STATS}>:KOOLANG_COUNT_ALLOCATIONS> VERSION="1.0")
 
     target_compile_options(
     ${target}
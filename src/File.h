@@ -11,14 +11,8 @@
 struct File
 
 {
-    enum class FileState {
-        NOT_LOADED,
-        LOADED,
-    };
-
     std::string Filepath;
     std::string Content;
-    FileState State = FileState::NOT_LOADED;
     std::vector<logger::Record> ErrMsgs;
     std::vector<logger::Record> WarnMsgs;
     std::vector<logger::Record> OtherMsgs;
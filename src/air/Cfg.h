@@ -0,0 +1,85 @@
+#ifndef KOOLANG_AIR_CFG_H
+#define KOOLANG_AIR_CFG_H
+
+#include "util/Index.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace air {
+
+enum class TermType : std::uint8_t {
+    // Returns the operand
+    RET,
+    // Jumps to the only successor
+    BR,
+    // Jumps to the first successor if the operand is true, otherwise to the second one
+    COND_BR,
+    UNREACHABLE,
+};
+
+/*
+Basic blocks of the function. Every array is indexed by the block or the edge:
+ - instructions of the block B are [Start[B], Start[B + 1]), its parameters (PARAM instructions) come first
+ - successors of the block B are Succ[SuccStart[B]..SuccStart[B + 1]), the index into Succ is the edge
+ - values passed to the parameters of the target of the edge E are Args[ArgStart[E]..ArgStart[E + 1])
+The empty Cfg is the single block which returns the result instruction.
+*/
+struct Cfg {
+    std::vector<Index> Start;
+    std::vector<TermType> Term;
+    std::vector<Index> TermOperand;
+
+    std::vector<Index> SuccStart;
+    std::vector<Index> Succ;
+
+    std::vector<Index> ArgStart;
+    std::vector<Index> Args;
+
+    [[nodiscard]] bool IsEmpty() const { return Term.empty(); }
+
+    // Returns the number of blocks, the empty Cfg has one block
+    [[nodiscard]] Index BlocksCount() const { return IsEmpty() ? 1 : static_cast<Index>(Term.size()); }
+
+    [[nodiscard]] std::span<const Index> GetSuccessors(Index block) const {
+        if (IsEmpty()) {
+            return {};
+        }
+
+        return std::span(Succ).subspan(SuccStart[block], SuccStart[block + 1] - SuccStart[block]);
+    }
+
+    [[nodiscard]] Index GetFirstEdge(Index block) const { return IsEmpty() ? 0 : SuccStart[block]; }
+
+    [[nodiscard]] std::span<const Index> GetArgs(Index edge) const {
+        return std::span(Args).subspan(ArgStart[edge], ArgStart[edge + 1] - ArgStart[edge]);
+    }
+
+    // Returns the block of the instruction
+    [[nodiscard]] Index GetBlock(Index inst) const {
+        if (IsEmpty()) {
+            return 0;
+        }
+
+        const auto iter = std::upper_bound(Start.begin(), Start.end(), inst);
+        return static_cast<Index>(std::distance(Start.begin(), iter) - 1);
+    }
+};
+
+// Calls the function for the operand of every terminator and for every branch argument.
+template <typename Fn> inline void forEachTermOperand(const Cfg& cfg, Fn fn) {
+    for (const Index operand : cfg.TermOperand) {
+        if (!isNull(operand)) {
+            fn(operand);
+        }
+    }
+
+    for (const Index arg : cfg.Args) {
+        fn(arg);
+    }
+}
+
+}
+
+#endif
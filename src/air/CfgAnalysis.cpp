@@ -0,0 +1,177 @@
+#include "CfgAnalysis.h"
+#include <algorithm>
+#include <utility>
+
+namespace air {
+
+bool DomTree::Dominates(Index dominator, Index block) const {
+    if (!IsReachable(block) || !IsReachable(dominator)) {
+        return false;
+    }
+
+    // dominators are always earlier in the reverse post order
+    while (RpoIndex[block] > RpoIndex[dominator]) {
+        block = Idom[block];
+    }
+
+    return block == dominator;
+}
+
+Predecessors computePredecessors(const Cfg& cfg) {
+    const Index count = cfg.BlocksCount();
+
+    Predecessors preds;
+    preds.PredStart.assign(count + 1, 0);
+
+    for (const Index succ : cfg.Succ) {
+        preds.PredStart[succ + 1] += 1;
+    }
+
+    for (Index block = 0; block < count; block++) {
+        preds.PredStart[block + 1] += preds.PredStart[block];
+    }
+
+    std::vector<Index> fill(preds.PredStart.begin(), preds.PredStart.end() - 1);
+    preds.Pred.resize(cfg.Succ.size());
+
+    for (Index block = 0; block < count; block++) {
+        for (const Index succ : cfg.GetSuccessors(block)) {
+            preds.Pred[fill[succ]++] = block;
+        }
+    }
+
+    return preds;
+}
+
+DomTree computeDominators(const Cfg& cfg, const Predecessors& preds) {
+    const Index count = cfg.BlocksCount();
+
+    DomTree dom;
+    dom.Idom.assign(count, MAX_INDEX);
+    dom.RpoIndex.assign(count, MAX_INDEX);
+
+    // post order without recursion, the pair is the block and the next successor
+    std::vector<std::pair<Index, Index>> stack;
+    std::vector<bool> visited(count, false);
+
+    stack.emplace_back(0, 0);
+    visited[0] = true;
+
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const auto succs    = cfg.GetSuccessors(block);
+
+        if (next < succs.size()) {
+            const Index succ = succs[next++];
+
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.emplace_back(succ, 0);
+            }
+            continue;
+        }
+
+        dom.Rpo.push_back(block);
+        stack.pop_back();
+    }
+
+    std::reverse(dom.Rpo.begin(), dom.Rpo.end());
+    for (Index i = 0; i < dom.Rpo.size(); i++) {
+        dom.RpoIndex[dom.Rpo[i]] = i;
+    }
+
+    auto intersect = [&](Index lhs, Index rhs) {
+        while (lhs != rhs) {
+            while (dom.RpoIndex[lhs] > dom.RpoIndex[rhs]) {
+                lhs = dom.Idom[lhs];
+            }
+            while (dom.RpoIndex[rhs] > dom.RpoIndex[lhs]) {
+                rhs = dom.Idom[rhs];
+            }
+        }
+        return lhs;
+    };
+
+    // the entry is its own dominator during the computation
+    dom.Idom[0] = 0;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (Index i = 1; i < dom.Rpo.size(); i++) {
+            const Index block = dom.Rpo[i];
+            Index newIdom     = MAX_INDEX;
+
+            for (const Index pred : preds.Get(block)) {
+                if (dom.Idom[pred] == MAX_INDEX) {
+                    continue;
+                }
+
+                newIdom = (newIdom == MAX_INDEX) ? pred : intersect(pred, newIdom);
+            }
+
+            if (dom.Idom[block] != newIdom) {
+                dom.Idom[block] = newIdom;
+                changed         = true;
+            }
+        }
+    }
+
+    dom.Idom[0] = MAX_INDEX;
+    return dom;
+}
+
+LoopInfo computeLoops(const Cfg& cfg, const Predecessors& preds, const DomTree& dom) {
+    const Index count = cfg.BlocksCount();
+
+    LoopInfo loops;
+    loops.BlockLoop.assign(count, MAX_INDEX);
+
+    std::vector<Index> worklist;
+
+    // outer headers come first in the reverse post order, so the inner loops overwrite the block loop
+    for (const Index header : dom.Rpo) {
+        worklist.clear();
+
+        for (const Index pred : preds.Get(header)) {
+            // back edge
+            if (dom.Dominates(header, pred)) {
+                worklist.push_back(pred);
+            }
+        }
+
+        if (worklist.empty()) {
+            continue;
+        }
+
+        const auto loop    = static_cast<Index>(loops.Header.size());
+        const Index parent = loops.BlockLoop[header];
+
+        loops.Header.push_back(header);
+        loops.Parent.push_back(parent);
+        loops.Depth.push_back((parent == MAX_INDEX) ? 1 : loops.Depth[parent] + 1);
+
+        loops.BlockLoop[header] = loop;
+
+        // walk backwards from the latches to the header
+        while (!worklist.empty()) {
+            const Index block = worklist.back();
+            worklist.pop_back();
+
+            if (loops.BlockLoop[block] == loop || !dom.IsReachable(block)) {
+                continue;
+            }
+
+            loops.BlockLoop[block] = loop;
+
+            for (const Index pred : preds.Get(block)) {
+                worklist.push_back(pred);
+            }
+        }
+    }
+
+    return loops;
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef KOOLANG_AIR_CFGANALYSIS_H
+#define KOOLANG_AIR_CFGANALYSIS_H
+
+#include "Cfg.h"
+#include "util/Index.h"
+#include <span>
+#include <vector>
+
+namespace air {
+
+// Predecessors of the block B are Pred[PredStart[B]..PredStart[B + 1])
+struct Predecessors {
+    std::vector<Index> PredStart;
+    std::vector<Index> Pred;
+
+    [[nodiscard]] std::span<const Index> Get(Index block) const {
+        return std::span(Pred).subspan(PredStart[block], PredStart[block + 1] - PredStart[block]);
+    }
+};
+
+struct DomTree {
+    // immediate dominator of the block, MAX_INDEX for the entry and unreachable blocks
+    std::vector<Index> Idom;
+    // reachable blocks in the reverse post order
+    std::vector<Index> Rpo;
+    // position of the block in Rpo, MAX_INDEX for unreachable blocks
+    std::vector<Index> RpoIndex;
+
+    [[nodiscard]] bool IsReachable(Index block) const { return RpoIndex[block] != MAX_INDEX; }
+    [[nodiscard]] bool Dominates(Index dominator, Index block) const;
+};
+
+// Natural loops, irreducible control flow is not detected.
+struct LoopInfo {
+    // header block of the loop
+    std::vector<Index> Header;
+    // enclosing loop, MAX_INDEX for the outermost loops
+    std::vector<Index> Parent;
+    std::vector<std::uint32_t> Depth;
+
+    // innermost loop of the block or MAX_INDEX
+    std::vector<Index> BlockLoop;
+
+    [[nodiscard]] Index LoopsCount() const { return static_cast<Index>(Header.size()); }
+    [[nodiscard]] std::uint32_t GetBlockDepth(Index block) const {
+        return (BlockLoop[block] == MAX_INDEX) ? 0 : Depth[BlockLoop[block]];
+    }
+};
+
+Predecessors computePredecessors(const Cfg& cfg);
+
+// Iterative algorithm by Cooper, Harvey and Kennedy
+DomTree computeDominators(const Cfg& cfg, const Predecessors& preds);
+
+LoopInfo computeLoops(const Cfg& cfg, const Predecessors& preds, const DomTree& dom);
+
+}
+
+#endif
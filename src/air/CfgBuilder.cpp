@@ -0,0 +1,101 @@
+#include "CfgBuilder.h"
+#include <cassert>
+
+namespace air {
+
+void CfgBuilder::Begin(Index block) {
+    Cfg& cfg = m_air.Blocks;
+
+    assert(m_terminated && block == cfg.Term.size() && block < m_blocksCount);
+
+    if (m_air.Inst.empty()) {
+        // reserve zero index
+        m_air.Inst.emplace_back(NULL_INDEX);
+        m_air.Type.emplace_back();
+    }
+
+    cfg.Start.push_back(static_cast<Index>(m_air.Inst.size()));
+    m_current    = block;
+    m_terminated = false;
+}
+
+Index CfgBuilder::AddParam(Index ty) {
+    assert(!m_terminated);
+    assert(m_air.Blocks.Start.back() == m_air.Inst.size() || m_air.Type.back() == InstType::PARAM);
+
+    return Add(InstType::PARAM, InstData::CreateTyOp(ty, m_current));
+}
+
+Index CfgBuilder::Add(InstType type, InstData data) {
+    assert(!m_terminated);
+
+    m_air.Inst.push_back(data);
+    m_air.Type.push_back(type);
+    return static_cast<Index>(m_air.Inst.size() - 1);
+}
+
+void CfgBuilder::Br(Index target, std::span<const Index> args) {
+    Terminate(TermType::BR, NULL_INDEX);
+    AddEdge(target, args);
+}
+
+void CfgBuilder::CondBr(
+    Index cond, Index thenBlock, std::span<const Index> thenArgs, Index elseBlock, std::span<const Index> elseArgs
+) {
+    Terminate(TermType::COND_BR, cond);
+    AddEdge(thenBlock, thenArgs);
+    AddEdge(elseBlock, elseArgs);
+}
+
+void CfgBuilder::Ret(Index value) { Terminate(TermType::RET, value); }
+
+void CfgBuilder::Unreachable() { Terminate(TermType::UNREACHABLE, NULL_INDEX); }
+
+void CfgBuilder::Finish() {
+    Cfg& cfg = m_air.Blocks;
+
+    assert(m_terminated && cfg.Term.size() == m_blocksCount);
+
+    cfg.Start.push_back(static_cast<Index>(m_air.Inst.size()));
+    cfg.SuccStart.push_back(static_cast<Index>(cfg.Succ.size()));
+    cfg.ArgStart.push_back(static_cast<Index>(cfg.Args.size()));
+}
+
+void CfgBuilder::Terminate(TermType type, Index operand) {
+    Cfg& cfg = m_air.Blocks;
+
+    assert(!m_terminated);
+
+    cfg.Term.push_back(type);
+    cfg.TermOperand.push_back(operand);
+    cfg.SuccStart.push_back(static_cast<Index>(cfg.Succ.size()));
+    m_terminated = true;
+}
+
+void CfgBuilder::AddEdge(Index target, std::span<const Index> args) {
+    Cfg& cfg = m_air.Blocks;
+
+    assert(target < m_blocksCount);
+
+    cfg.Succ.push_back(target);
+    cfg.ArgStart.push_back(static_cast<Index>(cfg.Args.size()));
+    cfg.Args.insert(cfg.Args.end(), args.begin(), args.end());
+}
+
+Index paramsCount(const Air& air, Index block) {
+    if (air.Blocks.IsEmpty()) {
+        return 0;
+    }
+
+    const Index start = air.Blocks.Start[block];
+    const Index end   = air.Blocks.Start[block + 1];
+
+    Index count = 0;
+    while (start + count < end && air.Type[start + count] == InstType::PARAM) {
+        count += 1;
+    }
+
+    return count;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef KOOLANG_AIR_CFGBUILDER_H
+#define KOOLANG_AIR_CFGBUILDER_H
+
+#include "Inst.h"
+#include "util/Index.h"
+#include <span>
+
+namespace air {
+
+// Appends basic blocks to the AIR. Blocks are filled one by one in the order of their creation, so the instructions of
+// every block stay contiguous.
+class CfgBuilder {
+public:
+    CfgBuilder(Air& air)
+        : m_air(air) { }
+
+    [[nodiscard]] Index CreateBlock() { return m_blocksCount++; }
+
+    // Starts the next block, the previous one must be terminated
+    void Begin(Index block);
+
+    // Parameters must be added before other instructions of the block
+    Index AddParam(Index ty);
+    Index Add(InstType type, InstData data);
+
+    void Br(Index target, std::span<const Index> args = {});
+    void CondBr(
+        Index cond, Index thenBlock, std::span<const Index> thenArgs, Index elseBlock, std::span<const Index> elseArgs
+    );
+    void Ret(Index value);
+    void Unreachable();
+
+    // Closes the arrays, all blocks must be terminated
+    void Finish();
+
+private:
+    Air& m_air;
+
+    Index m_blocksCount = 0;
+    Index m_current     = MAX_INDEX;
+    bool m_terminated   = true;
+
+    void Terminate(TermType type, Index operand);
+    void AddEdge(Index target, std::span<const Index> args);
+};
+
+// Returns the number of parameters of the block
+Index paramsCount(const Air& air, Index block);
+
+}
+
+#endif
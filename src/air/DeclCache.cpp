@@ -0,0 +1,509 @@
+#include "DeclCache.h"
+#include "Module.h"
+#include "ModuleManager.h"
+#include "Sema.h"
+#include "util/BinaryStream.h"
+#include "util/file.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace air {
+
+namespace {
+
+    // "KAIR"
+    constexpr std::uint32_t MAGIC = 0x5249414b;
+
+    constexpr std::uint64_t K0 = 0x9e3779b97f4a7c15;
+    constexpr std::uint64_t K1 = 0xbf58476d1ce4e5b9;
+
+    std::uint64_t mix(std::uint64_t hash, std::uint64_t value) { return std::rotl(hash ^ (value * K0), 29) * K1; }
+
+    bool isStoredType(Index type) { return isNull(type) || Pool::IsKnownKey(type); }
+
+    // Returns the names which resolve to the decl inside the module, sorted to keep the file deterministic
+    std::vector<std::string> getLookupNames(const Module* mod, const symbol::Record* rec) {
+        std::vector<std::string> names;
+
+        if (rec->Mod == mod && mod->FindTopDecl(rec->Name) == rec) {
+            names.push_back(rec->Name);
+        }
+
+        for (const auto& [name, imported] : mod->ImportedDecls) {
+            if (imported == rec && mod->FindTopDecl(name) == rec) {
+                names.push_back(name);
+            }
+        }
+
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+}
+
+DeclCache::DeclCache(ModuleManager& manager, std::filesystem::path cacheDir)
+    : m_manager(manager)
+    , m_dir(std::move(cacheDir)) {
+    for (const auto& mod : manager.GetModules()) {
+        m_paths[mod->SystemPath.string()] = mod.get();
+    }
+}
+
+bool DeclCache::GetDependencies(const symbol::Record* rec, std::vector<symbol::Record*>& dependencies) {
+    const Entry* entry = Find(rec);
+    if (isNull(entry)) {
+        return false;
+    }
+
+    for (const auto& dependency : entry->Dependencies) {
+        symbol::Record* depRec = Resolve(dependency);
+
+        if (isNull(depRec)) {
+            return false;
+        }
+
+        // the changed imports or a new local decl make the name refer to other decl
+        for (const auto& name : dependency.Names) {
+            if (rec->Mod->FindTopDecl(name) != depRec) {
+                return false;
+            }
+        }
+
+        dependencies.push_back(depRec);
+    }
+
+    return true;
+}
+
+bool DeclCache::Restore(Sema* sema, const std::vector<symbol::Record*>& dependencies) {
+    symbol::Record* rec = sema->GetRecord();
+    const Entry* entry  = Find(rec);
+
+    if (isNull(entry) || entry->Dependencies.size() != dependencies.size()) {
+        return false;
+    }
+
+    // the decl sees the dependencies only through their signatures
+    for (std::size_t i = 0; i < dependencies.size(); i++) {
+        if (GetSignature(m_manager.InternPool, dependencies[i]) != entry->Dependencies[i].Signature) {
+            return false;
+        }
+    }
+
+    Air air;
+    air.Inst.reserve(entry->Insts.size());
+    air.Type.reserve(entry->Types.size());
+
+    for (std::size_t i = 0; i < entry->Insts.size(); i++) {
+        const InstType type = entry->Types[i];
+        InstData data       = entry->Insts[i];
+
+        if (type == InstType::CONSTANT) {
+            if (data.Data >= entry->Values.size()) {
+                return false;
+            }
+
+            data = InstData::CreatePoolIndex(DecodeValue(m_manager.InternPool, entry->Values[data.Data]));
+        } else if (type == InstType::SYMBOL) {
+            if (data.Sym.Decl >= dependencies.size()) {
+                return false;
+            }
+
+            data = InstData::CreateSymbol(dependencies[data.Sym.Decl]->Id, data.Sym.Ty);
+        }
+
+        air.Inst.push_back(data);
+        air.Type.push_back(type);
+    }
+
+    std::vector<Index> references;
+    references.reserve(entry->References.size());
+
+    for (const Index reference : entry->References) {
+        if (reference >= dependencies.size()) {
+            return false;
+        }
+
+        references.push_back(dependencies[reference]->Id);
+    }
+
+    rec->Ty         = entry->Ty;
+    rec->Val        = DecodeValue(m_manager.InternPool, entry->Val);
+    rec->AirInst    = entry->AirInst;
+    rec->IsComptime = entry->IsComptime;
+
+    sema->Reuse(std::move(air), std::move(references));
+    m_restored.insert(rec->Id);
+
+    return true;
+}
+
+void DeclCache::Store() {
+    using symbol::Record;
+
+    for (const auto& mod : m_manager.GetModules()) {
+        // the decls of the interface aren't analyzed, the module keeps its entries
+        if (mod->CompStatus == Module::Status::INTERFACE) {
+            continue;
+        }
+
+        ModuleEntries& previous = m_modules[mod.get()];
+        if (!previous.Loaded) {
+            Load(mod.get(), previous);
+        }
+
+        ModuleEntries current { .Loaded = true, .Entries = {}, .Decls = {} };
+        bool changed = false;
+
+        for (const auto& sema : mod->Semas) {
+            const Record* rec = sema.GetRecord();
+            const std::string name(rec->Name);
+
+            const bool isAnalyzed = rec->StatusDecl == Record::State::COMPLETE
+                && rec->StatusBody == Record::State::COMPLETE && !m_restored.contains(rec->Id);
+
+            if (isAnalyzed) {
+                changed = true;
+
+                Entry entry;
+                if (Encode(sema, entry)) {
+                    current.Entries[name] = std::move(entry);
+                }
+
+                continue;
+            }
+
+            // restored decls and decls which weren't needed by this compilation keep their entries
+            const auto iter = previous.Entries.find(name);
+            if (iter != previous.Entries.end() && iter->second.Fingerprint == rec->Fingerprint) {
+                current.Entries[name] = std::move(iter->second);
+            }
+        }
+
+        changed = changed || current.Entries.size() != previous.Entries.size();
+
+        if (changed && !Write(mod.get(), current)) {
+            KOOLANG_WARN_MSG("Cannot write the cache file '{}'", GetPath(mod.get()).string());
+        }
+
+        previous = std::move(current);
+    }
+}
+
+std::uint64_t DeclCache::GetSignature(const Pool& pool, const symbol::Record* rec) {
+    if (!isStoredType(rec->Ty)) {
+        return 0;
+    }
+
+    std::uint64_t signature = mix(K0, static_cast<std::uint64_t>(rec->StatusDecl));
+    signature               = mix(signature, rec->Ty);
+    signature               = mix(signature, static_cast<std::uint64_t>(rec->IsComptime));
+
+    // comptime values are copied to the decls which reference them
+    if (rec->IsComptime) {
+        Value value;
+        if (!EncodeValue(pool, rec->Val, value)) {
+            return 0;
+        }
+
+        signature = mix(signature, value.Ty);
+        signature = mix(signature, value.Val);
+    }
+
+    // 0 is reserved for the unknown signature
+    return signature == 0 ? 1 : signature;
+}
+
+const DeclCache::Entry* DeclCache::Find(const symbol::Record* rec) {
+    if (rec->Fingerprint == 0) {
+        return nullptr;
+    }
+
+    ModuleEntries& entries = m_modules[rec->Mod];
+    if (!entries.Loaded) {
+        Load(rec->Mod, entries);
+    }
+
+    const Entry* entry = rec->Ordinal < entries.Decls.size() ? entries.Decls[rec->Ordinal] : nullptr;
+    return (isNull(entry) || entry->Fingerprint != rec->Fingerprint) ? nullptr : entry;
+}
+
+symbol::Record* DeclCache::Resolve(const Dependency& dependency) const {
+    const auto modIter = m_paths.find(dependency.Module);
+    if (modIter == m_paths.end()) {
+        return nullptr;
+    }
+
+    const Module* mod = modIter->second;
+    const auto& scope = mod->Map.GetNamespace(mod->NamespaceIndex);
+    const auto iter   = scope.Decls.find(dependency.Name);
+
+    return (iter == scope.Decls.end()) ? nullptr : iter->second;
+}
+
+bool DeclCache::Encode(const Sema& sema, Entry& entry) const {
+    const symbol::Record* rec = sema.GetRecord();
+    const Air& air            = sema.GetAir();
+    const Pool& pool          = m_manager.InternPool;
+
+    if (rec->Fingerprint == 0 || !isStoredType(rec->Ty) || !air.Blocks.IsEmpty()
+        || !EncodeValue(pool, rec->Val, entry.Val)) {
+        return false;
+    }
+
+    entry.Fingerprint = rec->Fingerprint;
+    entry.IsComptime  = rec->IsComptime;
+    entry.Ty          = rec->Ty;
+    entry.AirInst     = rec->AirInst;
+
+    // record id -> position in the Dependencies
+    std::unordered_map<Index, Index> positions;
+
+    for (const Index id : sema.GetReferences()) {
+        const auto [iter, inserted] = positions.try_emplace(id, static_cast<Index>(entry.Dependencies.size()));
+
+        if (inserted) {
+            const symbol::Record* depRec   = m_manager.Map.GetRecord(id);
+            const std::uint64_t signature  = GetSignature(pool, depRec);
+            std::vector<std::string> names = getLookupNames(rec->Mod, depRec);
+
+            if (signature == 0 || names.empty()) {
+                return false;
+            }
+
+            entry.Dependencies.push_back(
+                { depRec->Mod->SystemPath.string(), std::string(depRec->Name), signature, std::move(names) }
+            );
+        }
+
+        entry.References.push_back(iter->second);
+    }
+
+    entry.Types = air.Type;
+    entry.Insts.reserve(air.Inst.size());
+
+    for (std::size_t i = 0; i < air.Inst.size(); i++) {
+        InstData data = air.Inst[i];
+
+        switch (air.Type[i]) {
+        case InstType::CONSTANT: {
+            Value value;
+            if (!EncodeValue(pool, data.Data, value)) {
+                return false;
+            }
+
+            data = InstData::CreatePoolIndex(static_cast<Index>(entry.Values.size()));
+            entry.Values.push_back(value);
+            break;
+        }
+        case InstType::SYMBOL: {
+            const auto iter = positions.find(data.Sym.Decl);
+            if (iter == positions.end() || !isStoredType(data.Sym.Ty)) {
+                return false;
+            }
+
+            data = InstData::CreateSymbol(iter->second, data.Sym.Ty);
+            break;
+        }
+        case InstType::LOAD:
+        case InstType::CAST:
+            if (!isStoredType(data.TyOp.Ty)) {
+                return false;
+            }
+            break;
+        case InstType::PARAM:
+            return false;
+        default:
+            break;
+        }
+
+        entry.Insts.push_back(data);
+    }
+
+    return true;
+}
+
+std::filesystem::path DeclCache::GetPath(const Module* mod) const {
+    std::uint64_t hash = K1;
+    for (const char character : mod->SystemPath.string()) {
+        hash = mix(hash, static_cast<std::uint8_t>(character));
+    }
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << ".air";
+
+    return m_dir / "air" / name.str();
+}
+
+void DeclCache::Load(const Module* mod, ModuleEntries& entries) const {
+    entries.Loaded = true;
+    entries.Entries.clear();
+    entries.Decls.clear();
+
+    std::ifstream input(GetPath(mod), std::ios::binary);
+    if (!input.is_open()) {
+        return;
+    }
+
+    const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    BinaryReader reader(data);
+
+    const auto readValue = [&reader]() {
+        const auto ty = reader.Get<Index>();
+        return Value { ty, reader.Get<std::uint64_t>() };
+    };
+
+    if (reader.Get<std::uint32_t>() != MAGIC || reader.Get<std::uint32_t>() != FORMAT_VERSION
+        || reader.GetStr() != VERSION || reader.GetStr() != mod->SystemPath.string()) {
+        return;
+    }
+
+    const std::uint32_t entriesCount = reader.GetCount(sizeof(std::uint64_t));
+
+    for (std::uint32_t i = 0; i < entriesCount && reader.IsOk(); i++) {
+        const std::string name = reader.GetStr();
+        Entry entry;
+
+        entry.Fingerprint = reader.Get<std::uint64_t>();
+        entry.IsComptime  = reader.Get<std::uint8_t>() != 0;
+        entry.Ty          = reader.Get<Index>();
+        entry.AirInst     = reader.Get<Index>();
+        entry.Val         = readValue();
+
+        const std::uint32_t dependenciesCount = reader.GetCount(sizeof(std::uint64_t));
+        for (std::uint32_t dep = 0; dep < dependenciesCount; dep++) {
+            Dependency& dependency = entry.Dependencies.emplace_back();
+            dependency.Module      = reader.GetStr();
+            dependency.Name        = reader.GetStr();
+            dependency.Signature   = reader.Get<std::uint64_t>();
+
+            const std::uint32_t namesCount = reader.GetCount(sizeof(std::uint32_t));
+            for (std::uint32_t nameIdx = 0; nameIdx < namesCount; nameIdx++) {
+                dependency.Names.push_back(reader.GetStr());
+            }
+        }
+
+        const std::uint32_t referencesCount = reader.GetCount(sizeof(Index));
+        for (std::uint32_t ref = 0; ref < referencesCount; ref++) {
+            entry.References.push_back(reader.Get<Index>());
+        }
+
+        const std::uint32_t instCount = reader.GetCount(sizeof(InstType) + sizeof(InstData));
+        for (std::uint32_t inst = 0; inst < instCount; inst++) {
+            entry.Types.push_back(reader.Get<InstType>());
+
+            const auto raw = reader.Get<std::uint64_t>();
+            std::memcpy(static_cast<void*>(&entry.Insts.emplace_back(NULL_INDEX)), &raw, sizeof(InstData));
+        }
+
+        const std::uint32_t valuesCount = reader.GetCount(sizeof(Index) + sizeof(std::uint64_t));
+        for (std::uint32_t value = 0; value < valuesCount; value++) {
+            entry.Values.push_back(readValue());
+        }
+
+        entries.Entries[name] = std::move(entry);
+    }
+
+    // the damaged file is ignored
+    if (!reader.IsOk()) {
+        entries.Entries.clear();
+        return;
+    }
+
+    entries.Decls.assign(mod->Semas.size(), nullptr);
+    for (std::size_t i = 0; i < mod->Semas.size(); i++) {
+        const auto iter = entries.Entries.find(std::string(mod->Semas[i].GetRecord()->Name));
+
+        if (iter != entries.Entries.end()) {
+            entries.Decls[i] = &iter->second;
+        }
+    }
+}
+
+bool DeclCache::Write(const Module* mod, const ModuleEntries& entries) const {
+    BinaryWriter writer;
+
+    const auto writeValue = [&writer](Value value) {
+        writer.Put(value.Ty);
+        writer.Put(value.Val);
+    };
+
+    writer.Put(MAGIC);
+    writer.Put(FORMAT_VERSION);
+    writer.PutStr(VERSION);
+    writer.PutStr(mod->SystemPath.string());
+    writer.Put(static_cast<std::uint32_t>(entries.Entries.size()));
+
+    for (const auto& [name, entry] : entries.Entries) {
+        writer.PutStr(name);
+        writer.Put(entry.Fingerprint);
+        writer.Put(static_cast<std::uint8_t>(entry.IsComptime));
+        writer.Put(entry.Ty);
+        writer.Put(entry.AirInst);
+        writeValue(entry.Val);
+
+        writer.Put(static_cast<std::uint32_t>(entry.Dependencies.size()));
+        for (const auto& dependency : entry.Dependencies) {
+            writer.PutStr(dependency.Module);
+            writer.PutStr(dependency.Name);
+            writer.Put(dependency.Signature);
+
+            writer.Put(static_cast<std::uint32_t>(dependency.Names.size()));
+            for (const auto& depName : dependency.Names) {
+                writer.PutStr(depName);
+            }
+        }
+
+        writer.Put(static_cast<std::uint32_t>(entry.References.size()));
+        for (const Index reference : entry.References) {
+            writer.Put(reference);
+        }
+
+        writer.Put(static_cast<std::uint32_t>(entry.Insts.size()));
+        for (std::size_t i = 0; i < entry.Insts.size(); i++) {
+            writer.Put(entry.Types[i]);
+            writer.Put(entry.Insts[i]);
+        }
+
+        writer.Put(static_cast<std::uint32_t>(entry.Values.size()));
+        for (const Value value : entry.Values) {
+            writeValue(value);
+        }
+    }
+
+    return writeFileAtomic(GetPath(mod), writer.GetData());
+}
+
+bool DeclCache::EncodeValue(const Pool& pool, Index poolIndex, Value& value) {
+    if (Pool::IsKnownKey(poolIndex)) {
+        value = { NULL_INDEX, poolIndex };
+        return true;
+    }
+
+    if (pool.GetKeyRef(poolIndex).Tag != pool::KeyTag::TYPE_VALUE) {
+        return false;
+    }
+
+    const auto tyVal = pool.GetTypeValue(poolIndex);
+    if (isNull(tyVal.Ty) || !Pool::IsKnownKey(tyVal.Ty)) {
+        return false;
+    }
+
+    value = { tyVal.Ty, pool.Values.at(tyVal.Val) };
+    return true;
+}
+
+Index DeclCache::DecodeValue(Pool& pool, Value value) {
+    if (isNull(value.Ty)) {
+        return Pool::IsKnownKey(static_cast<Index>(value.Val)) ? static_cast<Index>(value.Val) : NULL_INDEX;
+    }
+
+    return pool.Put(PoolKey::CreateTypeValue(value.Ty, pool.AddValue(value.Val)));
+}
+
+}
@@ -0,0 +1,113 @@
+#ifndef KOOLANG_AIR_DECLCACHE_H
+#define KOOLANG_AIR_DECLCACHE_H
+
+#include "Inst.h"
+#include "Pool.h"
+#include "symbol/Record.h"
+#include "util/Index.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace air {
+
+class ModuleManager;
+class Sema;
+struct Module;
+
+// On-disk cache of the analyzed decls, one file per module. Every decl stores the hash of its tokens, the decls it
+// referenced with their signatures and its AIR. The decl with the same tokens is not analyzed again if the signatures
+// of its dependencies didn't change, so an edit of one function analyzes only that function and its dependents.
+class DeclCache {
+public:
+    DeclCache(ModuleManager& manager, std::filesystem::path cacheDir);
+
+    // Returns false if the decl with the same tokens isn't cached, otherwise returns the decls it referenced
+    bool GetDependencies(const symbol::Record* rec, std::vector<symbol::Record*>& dependencies);
+
+    // Restores the analysis of the decl if the signatures of its dependencies didn't change. The dependencies are the
+    // records returned by GetDependencies and must be analyzed already.
+    bool Restore(Sema* sema, const std::vector<symbol::Record*>& dependencies);
+
+    // Writes the modules with newly analyzed decls
+    void Store();
+
+    [[nodiscard]] std::size_t GetRestoredCount() const { return m_restored.size(); }
+
+    // Returns the hash of the type and the comptime value of the decl, the part other decls depend on. Returns 0 if
+    // the decl uses types which can't be stored.
+    [[nodiscard]] static std::uint64_t GetSignature(const Pool& pool, const symbol::Record* rec);
+
+    // Pool index independent of the order of the analysis. Ty is NULL_INDEX for the constexpr keys.
+    struct Value {
+        Index Ty;
+        std::uint64_t Val;
+    };
+
+    // Returns false if the value isn't a known key or a value of a known type
+    [[nodiscard]] static bool EncodeValue(const Pool& pool, Index poolIndex, Value& value);
+    [[nodiscard]] static Index DecodeValue(Pool& pool, Value value);
+
+private:
+    static constexpr std::uint32_t FORMAT_VERSION = 2;
+
+    struct Dependency {
+        std::string Module;
+        std::string Name;
+        std::uint64_t Signature;
+        // names under which the decl found the dependency, the local decls and the imports can change what they name
+        std::vector<std::string> Names;
+    };
+
+    struct Entry {
+        std::uint64_t Fingerprint = 0;
+        bool IsComptime           = true;
+        Index Ty                  = NULL_INDEX;
+        Index AirInst             = NULL_INDEX;
+        Value Val                 = { NULL_INDEX, NULL_INDEX };
+
+        std::vector<Dependency> Dependencies;
+        // positions in the Dependencies
+        std::vector<Index> References;
+
+        // CONSTANT refers to the Values and SYMBOL to the Dependencies
+        std::vector<InstType> Types;
+        std::vector<InstData> Insts;
+        std::vector<Value> Values;
+    };
+
+    struct ModuleEntries {
+        bool Loaded = false;
+        std::unordered_map<std::string, Entry> Entries;
+        // entry of every decl of the module by its ordinal, nullptr if the decl isn't cached
+        std::vector<const Entry*> Decls;
+    };
+
+    ModuleManager& m_manager;
+    std::filesystem::path m_dir;
+
+    std::unordered_map<std::string, Module*> m_paths;
+    std::unordered_map<const Module*, ModuleEntries> m_modules;
+
+    // records restored from the cache
+    std::unordered_set<Index> m_restored;
+
+    // Returns the cached entry with the same tokens or nullptr
+    const Entry* Find(const symbol::Record* rec);
+
+    // Returns the record of the dependency or nullptr
+    symbol::Record* Resolve(const Dependency& dependency) const;
+
+    [[nodiscard]] bool Encode(const Sema& sema, Entry& entry) const;
+    [[nodiscard]] std::filesystem::path GetPath(const Module* mod) const;
+
+    void Load(const Module* mod, ModuleEntries& entries) const;
+    [[nodiscard]] bool Write(const Module* mod, const ModuleEntries& entries) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "ImportResolver.h"
+#include <mutex>
+#include <system_error>
+
+namespace air {
+
+namespace fs = std::filesystem;
+
+std::optional<fs::path> ImportResolver::Resolve(const fs::path& searchPath, const fs::path& filepathWithoutExt) {
+    if (filepathWithoutExt.empty()) {
+        return std::nullopt;
+    }
+
+    fs::path dir = searchPath;
+
+    // every part except the last one is a directory
+    auto part = filepathWithoutExt.begin();
+    for (; std::next(part) != filepathWithoutExt.end(); ++part) {
+        if (Lookup(dir, part->string()) != Kind::DIRECTORY) {
+            return std::nullopt;
+        }
+        dir /= *part;
+    }
+
+    const std::string name = part->string();
+
+    // the directory is the module only with the 'mod.k' file
+    if (Lookup(dir, name) == Kind::DIRECTORY) {
+        if (Lookup(dir / name, "mod.k") != Kind::FILE) {
+            return std::nullopt;
+        }
+
+        return filepathWithoutExt / "mod.k";
+    }
+
+    if (Lookup(dir, name + ".k") != Kind::FILE) {
+        return std::nullopt;
+    }
+
+    return fs::path(filepathWithoutExt).replace_extension(".k");
+}
+
+std::optional<ImportResolver::Kind> ImportResolver::Lookup(const fs::path& dir, std::string_view name) {
+    const Listing& listing = GetListing(dir);
+
+    const auto iter = listing.find(name);
+    if (iter == listing.end()) {
+        return std::nullopt;
+    }
+
+    return iter->second;
+}
+
+const ImportResolver::Listing& ImportResolver::GetListing(const fs::path& dir) {
+    const std::string key = dir.string();
+
+    {
+        std::shared_lock lock(m_mutex);
+
+        const auto iter = m_listings.find(key);
+        if (iter != m_listings.end()) {
+            return *iter->second;
+        }
+    }
+
+    // the directory is listed without the lock, the first listing of the directory is kept
+    auto listing = std::make_unique<Listing>();
+
+    std::error_code ec;
+    for (fs::directory_iterator iter(dir, ec), end; !ec && iter != end; iter.increment(ec)) {
+        // the type is usually known from the listing, the symlinks are followed
+        std::error_code typeEc;
+        if (iter->is_directory(typeEc)) {
+            listing->emplace(iter->path().filename().string(), Kind::DIRECTORY);
+        } else if (iter->is_regular_file(typeEc)) {
+            listing->emplace(iter->path().filename().string(), Kind::FILE);
+        }
+    }
+
+    std::unique_lock lock(m_mutex);
+    return *m_listings.try_emplace(key, std::move(listing)).first->second;
+}
+
+}
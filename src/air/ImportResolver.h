@@ -0,0 +1,43 @@
+#ifndef KOOLANG_AIR_IMPORTRESOLVER_H
+#define KOOLANG_AIR_IMPORTRESOLVER_H
+
+#include "util/string_hash.h"
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace air {
+
+// Resolves the import paths to the files. Every directory is listed once when it's searched for the first time, the
+// missing directories are cached as empty, so the next lookups don't touch the disk. The listings never change, so the
+// lookups share the lock. Every build has its own resolver and sees the new files.
+class ImportResolver {
+public:
+    // Returns the path of the file relative to the search path, 'a/b.k' or 'a/b/mod.k' for the import 'a/b'
+    std::optional<std::filesystem::path>
+    Resolve(const std::filesystem::path& searchPath, const std::filesystem::path& filepathWithoutExt);
+
+private:
+    enum class Kind {
+        FILE,
+        DIRECTORY,
+    };
+
+    using Listing = std::unordered_map<std::string, Kind, string_hash, std::equal_to<>>;
+
+    // Returns the kind of the entry in the directory, nullopt if the entry doesn't exist
+    std::optional<Kind> Lookup(const std::filesystem::path& dir, std::string_view name);
+    const Listing& GetListing(const std::filesystem::path& dir);
+
+    std::shared_mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<const Listing>, string_hash, std::equal_to<>> m_listings;
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef KOOLANG_AIR_INST_H
 #define KOOLANG_AIR_INST_H
 
+#include "air/Cfg.h"
 #include "air/InstData.h"
 #include "util/Index.h"
 #include <unordered_map>
@@ -90,15 +91,52 @@ enum class InstType : std::uint8_t {
     // TODO: attributes
     // CALL_INLINE,
 
+    /// CONTROL FLOW //////////////////////////////////////////////////////////////////////////////
+
+    /*
+    Block parameter (phi), the value is passed by the predecessors.
+    Uses field 'TyOp', the operand is the block.
+    */
+    PARAM,
 };
 
 struct Air {
     std::vector<InstData> Inst;
     std::vector<InstType> Type;
+
+    // empty for the straight-line code
+    Cfg Blocks;
 };
 
 static_assert(sizeof(InstType) == 1, "Enum InstType must have size 1 byte");
 
+// Calls the function for every operand of the instruction.
+template <typename Fn> inline void forEachOperand(const Air& air, Index inst, Fn fn) {
+    switch (air.Type[inst]) {
+    case InstType::CONSTANT:
+    case InstType::SYMBOL:
+    case InstType::PARAM:
+        break;
+    case InstType::LOAD:
+    case InstType::CAST:
+        fn(air.Inst[inst].TyOp.Operand);
+        break;
+    case InstType::ADD:
+    case InstType::SUB:
+    case InstType::MUL:
+    case InstType::DIV:
+    case InstType::MOD:
+    case InstType::BIT_AND:
+    case InstType::BIT_OR:
+    case InstType::BIT_SHL:
+    case InstType::BIT_SHR:
+    case InstType::BIT_XOR:
+        fn(air.Inst[inst].BinOp.Lhs);
+        fn(air.Inst[inst].BinOp.Rhs);
+        break;
+    }
+}
+
 }
 
 #endif
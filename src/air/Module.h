@@ -3,13 +3,17 @@
 
 #include "File.h"
 #include "air/Inst.h"
+#include "air/ModuleInterface.h"
 #include "air/Sema.h"
 #include "kir/Inst.h"
 #include "symbol/SymbolMap.h"
 #include "util/Index.h"
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
@@ -29,13 +33,18 @@ struct Module {
         NOT_LOADED,
         NOT_EXISTS,
         ERROR,
+        // the pub decls are loaded from the interface of the library, the module has no KIR and no Semas
+        INTERFACE,
     };
 
     Status CompStatus = Status::NOT_LOADED;
     std::filesystem::path SystemPath;
     std::filesystem::path* NamespacePath;
 
+    // the content is released when the file is parsed, the messages of the front end are already printed
     File FileData;
+    // hash of the tokens of the file
+    std::uint64_t SourceHash = 0;
 
     // if the file is mod then the index is the current module index otherwise it's the parent module index
     Index NamespaceIndex;
@@ -44,30 +53,51 @@ struct Module {
 
     std::vector<Module*> Imports;
 
-    std::vector<Air> Airs;
+    // decl named by the import, e.g. 'import a::b::{c, d = e}' where a/b.k defines c and e
+    struct ImportedItem {
+        // name in the module, the alias or the name of the decl
+        std::string Name;
+        Module* From;
+        std::string Item;
+    };
+
+    std::vector<ImportedItem> ImportedItems;
+    // name -> record of the imported decl, resolved by ModuleManager::GenAir
+    std::unordered_map<std::string, symbol::Record*> ImportedDecls;
+    // the sources the interface of the INTERFACE module was written from, the importers' interfaces record them too
+    std::vector<kmi::Import> InterfaceImports;
+
+    // null until the decl is analyzed
+    std::vector<std::unique_ptr<Air>> Airs;
     std::vector<Sema> Semas;
 
-    // TODO: maybe unique_ptr -> release when we have Air ?
-    kir::Kir Kir;
+    // Shared with the query database. Released by ModuleManager::GenAir when no decl of the module can be analyzed
+    // anymore, the Semas mustn't be analyzed afterwards. Over the memory budget it's spilled to the file and loaded
+    // again when a decl of the module is analyzed.
+    std::shared_ptr<const kir::Kir> Kir;
+    // bytes of the KIR held in the memory budget of the build while the KIR is loaded
+    std::size_t KirBytes = 0;
+    // the file with the spilled KIR, empty if the KIR was never spilled
+    std::filesystem::path KirSpill;
 
-    Sema* GetSema(Index kirInst) {
-        Index leftBound = 0;
-        auto rightBound = static_cast<Index>(Semas.size() - 1);
+    void ReleaseKir() { Kir.reset(); }
 
-        while (leftBound <= rightBound) {
-            const Index mid         = leftBound + (rightBound - leftBound) / 2;
-            const Index semaKirInst = Semas.at(mid).GetKirInst();
+    // The backends release the AIR of the decl after they emitted it
+    void ReleaseAir(const symbol::Record* rec) { Airs.at(rec->Ordinal).reset(); }
 
-            if (semaKirInst == kirInst) {
-                return &Semas.at(mid);
-            } else if (semaKirInst < kirInst) {
-                leftBound = mid + 1;
-            } else {
-                rightBound = mid - 1;
-            }
+    [[nodiscard]] Sema* GetSema(const symbol::Record* rec) { return &Semas.at(rec->Ordinal); }
+
+    // Returns the top decl visible under the name or nullptr, the decls of the module hide the imported decls
+    [[nodiscard]] symbol::Record* FindTopDecl(const std::string& name) const {
+        const auto& scope = Map.GetNamespace(NamespaceIndex);
+        const auto iter   = scope.Decls.find(name);
+
+        if (iter != scope.Decls.end()) {
+            return iter->second;
         }
-        KOOLANG_WARN_MSG("{}", kirInst);
-        return nullptr;
+
+        const auto imported = ImportedDecls.find(name);
+        return (imported == ImportedDecls.end()) ? nullptr : imported->second;
     }
 };
 }
@@ -0,0 +1,192 @@
+#include "ModuleInterface.h"
+#include "Module.h"
+#include "ast/Tokenizer.h"
+#include "util/BinaryStream.h"
+#include "util/file.h"
+#include <algorithm>
+#include <system_error>
+
+namespace air::kmi {
+
+namespace {
+
+    // "KKMI"
+    constexpr std::uint32_t MAGIC          = 0x494d4b4b;
+    constexpr std::uint32_t FORMAT_VERSION = 2;
+
+    // The source is checked by its size and modification time, so the importers don't read it
+    bool getSourceStamp(const std::filesystem::path& source, std::uint64_t& size, std::int64_t& time) {
+        std::error_code ec;
+
+        size = std::filesystem::file_size(source, ec);
+        if (ec) {
+            return false;
+        }
+
+        const auto writeTime = std::filesystem::last_write_time(source, ec);
+        time                 = static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+        return !ec;
+    }
+
+    // Returns false if the source is already collected
+    bool addImport(std::vector<Import>& imports, Import import) {
+        const auto isSame = [&import](const Import& other) { return other.Path == import.Path; };
+
+        if (std::any_of(imports.begin(), imports.end(), isSame)) {
+            return false;
+        }
+
+        imports.push_back(std::move(import));
+        return true;
+    }
+
+    // Collects every module reachable through the imports, the interfaces give the imports they were written from
+    void collectImports(const Module* root, const Module* mod, std::vector<Import>& imports) {
+        for (const Module* importMod : mod->Imports) {
+            if (importMod == root || !addImport(imports, { importMod->SystemPath.string(), importMod->SourceHash })) {
+                continue;
+            }
+
+            if (importMod->CompStatus == Module::Status::INTERFACE) {
+                for (const Import& import : importMod->InterfaceImports) {
+                    addImport(imports, import);
+                }
+            } else {
+                collectImports(root, importMod, imports);
+            }
+        }
+    }
+
+    bool isImportUnchanged(const Import& import) {
+        File file;
+        file.Filepath = import.Path;
+
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(import.Path, ec)) {
+            return false;
+        }
+
+        file.Content = std::string(MappedFile(import.Path).GetView());
+
+        const ast::TokenList tokens = ast::Tokenizer(file).Tokenize();
+        return file.ErrMsgs.empty() && tokens.Hash == import.TokensHash;
+    }
+
+}
+
+std::filesystem::path getPath(const std::filesystem::path& source) {
+    return std::filesystem::path(source).replace_extension(".kmi");
+}
+
+bool write(const Module* mod, const Pool& pool) {
+    using symbol::Record;
+
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceTime  = 0;
+    if (!getSourceStamp(mod->SystemPath, sourceSize, sourceTime)) {
+        return false;
+    }
+
+    std::vector<Decl> decls;
+
+    for (const auto& sema : mod->Semas) {
+        const Record* rec = sema.GetRecord();
+        if (rec->IsPub != ast::Vis::GLOBAL) {
+            continue;
+        }
+
+        Decl decl { .Name = rec->Name, .Kind = rec->Kind, .Ty = rec->Ty, .Val = { NULL_INDEX, 0 } };
+
+        const bool isStored = rec->StatusDecl == Record::State::COMPLETE && rec->IsComptime
+                           && Pool::IsKnownKey(rec->Ty) && DeclCache::EncodeValue(pool, rec->Val, decl.Val);
+        if (!isStored) {
+            return false;
+        }
+
+        decls.push_back(std::move(decl));
+    }
+
+    std::vector<Import> imports;
+    collectImports(mod, mod, imports);
+
+    BinaryWriter writer;
+    writer.Put(MAGIC);
+    writer.Put(FORMAT_VERSION);
+    writer.PutStr(VERSION);
+    writer.Put(sourceSize);
+    writer.Put(sourceTime);
+    writer.Put(mod->SourceHash);
+    writer.Put(static_cast<std::uint32_t>(decls.size()));
+
+    for (const Decl& decl : decls) {
+        writer.PutStr(decl.Name);
+        writer.Put(decl.Kind);
+        writer.Put(decl.Ty);
+        writer.Put(decl.Val.Ty);
+        writer.Put(decl.Val.Val);
+    }
+
+    writer.Put(static_cast<std::uint32_t>(imports.size()));
+    for (const Import& import : imports) {
+        writer.PutStr(import.Path);
+        writer.Put(import.TokensHash);
+    }
+
+    return writeFileAtomic(getPath(mod->SystemPath), writer.GetData());
+}
+
+bool load(const std::filesystem::path& source, Interface& moduleInterface) {
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceTime  = 0;
+    if (!getSourceStamp(source, sourceSize, sourceTime)) {
+        return false;
+    }
+
+    const MappedFile file(getPath(source));
+    BinaryReader reader(file.GetView());
+
+    if (reader.Get<std::uint32_t>() != MAGIC || reader.Get<std::uint32_t>() != FORMAT_VERSION
+        || reader.GetStr() != VERSION || reader.Get<std::uint64_t>() != sourceSize
+        || reader.Get<std::int64_t>() != sourceTime || !reader.IsOk()) {
+        return false;
+    }
+
+    moduleInterface.SourceHash = reader.Get<std::uint64_t>();
+
+    // name size, kind, type and value
+    const std::uint32_t count = reader.GetCount(sizeof(std::uint32_t) + 1 + sizeof(Index) * 2 + sizeof(std::uint64_t));
+
+    moduleInterface.Decls.clear();
+    moduleInterface.Decls.reserve(count);
+
+    for (std::uint32_t i = 0; i < count && reader.IsOk(); i++) {
+        Decl& decl = moduleInterface.Decls.emplace_back();
+
+        decl.Name    = reader.GetStr();
+        decl.Kind    = reader.Get<kir::InstType>();
+        decl.Ty      = reader.Get<Index>();
+        decl.Val.Ty  = reader.Get<Index>();
+        decl.Val.Val = reader.Get<std::uint64_t>();
+    }
+
+    // path size and tokens hash
+    const std::uint32_t importsCount = reader.GetCount(sizeof(std::uint32_t) + sizeof(std::uint64_t));
+
+    moduleInterface.Imports.clear();
+    moduleInterface.Imports.reserve(importsCount);
+
+    for (std::uint32_t i = 0; i < importsCount && reader.IsOk(); i++) {
+        Import& import    = moduleInterface.Imports.emplace_back();
+        import.Path       = reader.GetStr();
+        import.TokensHash = reader.Get<std::uint64_t>();
+    }
+
+    // the damaged file is ignored
+    if (!reader.IsOk()) {
+        return false;
+    }
+
+    return std::all_of(moduleInterface.Imports.begin(), moduleInterface.Imports.end(), isImportUnchanged);
+}
+
+}
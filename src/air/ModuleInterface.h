@@ -0,0 +1,53 @@
+#ifndef KOOLANG_AIR_MODULEINTERFACE_H
+#define KOOLANG_AIR_MODULEINTERFACE_H
+
+#include "DeclCache.h"
+#include "kir/Inst.h"
+#include "util/Index.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Interface of the library module, the '.kmi' file next to its source. It has the names, the types and the comptime
+// values of the pub decls, the values refer only to the known keys of the pool. The importers load the interface
+// instead of parsing and analyzing the source while neither the source nor the sources it imports change.
+//
+//   magic | format version | compiler version | source size | source time | tokens hash | decls | imports
+namespace air::kmi {
+
+struct Decl {
+    std::string Name;
+    kir::InstType Kind;
+    Index Ty;
+    DeclCache::Value Val;
+};
+
+// source the values depend on, directly or through other imports
+struct Import {
+    std::string Path;
+    // hash of the tokens of the source when the interface was written
+    std::uint64_t TokensHash;
+};
+
+struct Interface {
+    // hash of the tokens of the source
+    std::uint64_t SourceHash = 0;
+    std::vector<Decl> Decls;
+    std::vector<Import> Imports;
+};
+
+// Returns the path of the interface of the source
+std::filesystem::path getPath(const std::filesystem::path& source);
+
+// Returns false if a pub decl isn't analyzed or isn't a comptime value of a known type, the library objects aren't
+// emitted yet, so the importers can use only the values. The file is written atomically.
+bool write(const Module* mod, const Pool& pool);
+
+// Returns false if the interface doesn't exist, is from a different version, the source changed or the tokens of an
+// import changed. The imports are tokenized, their comments and whitespace don't matter.
+bool load(const std::filesystem::path& source, Interface& moduleInterface);
+
+}
+
+#endif
@@ -1,37 +1,155 @@
 #include "ModuleManager.h"
+#include "DeclCache.h"
+#include "ModuleInterface.h"
 #include "Sema.h"
-#include "ast/Parser.h"
-#include "kir/AstGen.h"
+#include "SemaScheduler.h"
+#include "ast/ImportScanner.h"
+#include "kir/Cache.h"
+#include "logger/Stats.h"
+#include "logger/Trace.h"
 #include "terminal/globals.h"
+#include "util/hash_combine.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace air {
 
-ModuleManager::ModuleManager() {
+namespace {
+
+    std::size_t getProcessId() {
+#ifdef _WIN32
+        return static_cast<std::size_t>(::_getpid());
+#else
+        return static_cast<std::size_t>(::getpid());
+#endif
+    }
+
+    // The KIR is released after the analysis of the module, so it's reported when the module is prepared
+    void reportKirStats(const Module* mod) {
+        using namespace logger::stats;
+
+        addVector("kir", "inst", mod->Kir->Inst);
+        addVector("kir", "type", mod->Kir->Type);
+        addVector("kir", "extra", mod->Kir->Extra);
+        addStrings("kir", "strings", mod->Kir->Strings);
+        addVector("kir", "imports", mod->Kir->Imports);
+        addVector("kir", "import aliases", mod->Kir->ImportAliases);
+        addVector("kir", "decl hashes", mod->Kir->DeclHashes);
+
+        addSample("module kir instructions", mod->Kir->Inst.size());
+    }
+
+    query::DeclKey getDeclKey(const symbol::Record* rec) {
+        return { .Path = rec->Mod->SystemPath.string(), .Name = std::string(rec->Name) };
+    }
+
+    // Returns the hash of the decls the names of the module refer to, the local decls hide the imported ones
+    std::uint64_t computeScope(const Module* mod) {
+        std::vector<std::string> names;
+
+        for (const auto& [name, rec] : mod->Map.GetNamespace(mod->NamespaceIndex).Decls) {
+            if (rec->Mod == mod) {
+                names.emplace_back(name);
+            }
+        }
+
+        for (const auto& [name, rec] : mod->ImportedDecls) {
+            names.push_back(name + '=' + rec->Mod->SystemPath.string() + "::" + std::string(rec->Name));
+        }
+
+        // the order of the maps isn't stable
+        std::sort(names.begin(), names.end());
+
+        std::size_t scope = names.size();
+        for (const auto& name : names) {
+            hash_combine(scope, name);
+        }
+
+        return scope;
+    }
+
+    // Reads the signatures from the records analyzed by the build
+    class BuildAnalyzer : public query::Analyzer {
+    public:
+        explicit BuildAnalyzer(ModuleManager& manager)
+            : m_manager(manager) {
+            for (const auto& mod : manager.GetModules()) {
+                m_modules[mod->SystemPath.string()] = mod.get();
+            }
+        }
+
+        std::vector<query::DeclKey> GetDependencies(const query::DeclKey& decl) override {
+            symbol::Record* rec = Find(decl);
+            std::vector<query::DeclKey> dependencies;
+
+            // the decls of the interfaces are complete, their input is the signature
+            if (rec->Mod->CompStatus == Module::Status::INTERFACE) {
+                return dependencies;
+            }
+
+            for (const Index id : rec->Mod->GetSema(rec)->GetReferences()) {
+                dependencies.push_back(getDeclKey(m_manager.Map.GetRecord(id)));
+            }
+
+            return dependencies;
+        }
+
+        std::uint64_t GetSignature(const query::DeclKey& decl) override {
+            return DeclCache::GetSignature(m_manager.InternPool, Find(decl));
+        }
+
+    private:
+        ModuleManager& m_manager;
+        std::unordered_map<std::string, Module*> m_modules;
+
+        // the keys are read only for the records of the build
+        symbol::Record* Find(const query::DeclKey& decl) const {
+            const Module* mod = m_modules.at(decl.Path);
+            return mod->Map.GetNamespace(mod->NamespaceIndex).Decls.at(decl.Name);
+        }
+    };
+
+}
+
+ModuleManager::ModuleManager(query::Database* database)
+    : m_ownDatabase(isNull(database) ? std::make_unique<query::Database>() : nullptr)
+    , m_database(isNull(database) ? m_ownDatabase.get() : database)
+    , m_budget(globals::g_config.MaxMemory) {
     m_includePaths.push_back(globals::g_config.WorkingDir);
     m_includePaths.insert(
         m_includePaths.end(), globals::g_config.ImportPaths.begin(), globals::g_config.ImportPaths.end()
     );
+
+    // the managers of the tests run in one process
+    static std::atomic<std::size_t> s_managers = 0;
+    m_spillDir = std::filesystem::temp_directory_path()
+               / std::format("koolang-spill-{}-{}", getProcessId(), s_managers.fetch_add(1));
+}
+
+ModuleManager::~ModuleManager() {
+    std::error_code ec;
+    std::filesystem::remove_all(m_spillDir, ec);
 }
 
 Module* ModuleManager::CreateModuleWithNamespace(
-    Index namespaceIndex, std::filesystem::path filepathWithoutExt, const std::filesystem::path& searchPath
+    Index namespaceIndex, const std::filesystem::path& filepath, const std::filesystem::path& searchPath
 ) {
     namespace fs = std::filesystem;
 
-    fs::path filepath;
-
-    if (fs::is_directory(searchPath / filepathWithoutExt)) {
-        filepath = filepathWithoutExt / "mod.k";
-    } else {
-        filepath = filepathWithoutExt.replace_extension(".k");
-    }
-
-    if (!fs::is_regular_file(searchPath / filepath)) {
-        return nullptr;
-    }
-
     Index currNamespace = namespaceIndex;
     fs::path currPath   = searchPath;
     Module* mod         = nullptr;
@@ -77,46 +195,106 @@ Module* ModuleManager::CreateModuleWithNamespace(
     return mod;
 }
 
-Module* ModuleManager::GetOrAddFile(const std::string& filepathRaw, Index namespaceIndex) {
+Module* ModuleManager::GetOrAddFile(const std::string& filepathRaw, Index namespaceIndex, bool isNewImporter) {
     namespace fs = std::filesystem;
 
-    // this method is used in GenZirJob
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     const fs::path filepathWithoutExt(filepathRaw);
 
-    Module* mod = nullptr;
+    // the search paths don't change, only the namespaces and the modules are created under the lock
+    std::optional<fs::path> parentPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
 
-    // search inside the given namespace
-    const Module* parentMod = Map.GetModule(namespaceIndex);
-    if (!isNull(parentMod)) {
-        const auto& path = parentMod->SystemPath.parent_path();
+        const Module* parentMod = Map.GetModule(namespaceIndex);
+        if (!isNull(parentMod)) {
+            parentPath = parentMod->SystemPath.parent_path();
+        }
+    }
+
+    Index searchNamespace      = namespaceIndex;
+    const fs::path* searchPath = nullptr;
+    std::optional<fs::path> filepath;
 
-        mod = CreateModuleWithNamespace(namespaceIndex, filepathWithoutExt, path);
+    // search inside the given namespace
+    if (parentPath.has_value()) {
+        filepath   = m_resolver.Resolve(*parentPath, filepathWithoutExt);
+        searchPath = &*parentPath;
     }
 
-    if (isNull(mod)) {
+    if (!filepath.has_value()) {
         // search inside root namespaces
+        searchNamespace = NULL_INDEX;
+
         for (const auto& path : m_includePaths) {
-            mod = CreateModuleWithNamespace(NULL_INDEX, filepathWithoutExt, path);
-            if (!isNull(mod)) {
+            filepath   = m_resolver.Resolve(path, filepathWithoutExt);
+            searchPath = &path;
+
+            if (filepath.has_value()) {
                 break;
             }
         }
     }
 
-    // generate kir for the module
-    if (!isNull(mod) && mod->CompStatus == Module::Status::NOT_LOADED) {
+    if (!filepath.has_value()) {
+        return nullptr;
+    }
+
+    // this method is used in GenZirJob
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Module* mod = CreateModuleWithNamespace(searchNamespace, *filepath, *searchPath);
+
+    if (isNull(mod)) {
+        return nullptr;
+    }
+
+    // generate kir for the module, the job picks the pending module when it starts
+    if (mod->CompStatus == Module::Status::NOT_LOADED) {
         mod->CompStatus = Module::Status::IN_PROGRESS;
-        m_pool.Spawn(ModuleManager::GenZirJob, ThreadContext { mod, this });
+        m_pending.push_back(PendingModule { .Mod = mod, .Importers = 1, .Order = m_discovered++ });
+        m_pool.Spawn(ModuleManager::LoadPendingJob, ThreadContext { nullptr, this });
+    } else if (isNewImporter) {
+        // the pending module unblocks one more importer
+        for (auto& pending : m_pending) {
+            if (pending.Mod == mod) {
+                pending.Importers++;
+                break;
+            }
+        }
+    }
+
+    return mod;
+}
+
+Module* ModuleManager::GetOrAddImport(
+    const std::string& path, Index namespaceIndex, bool isNewImporter, std::string& item
+) {
+    Module* mod = GetOrAddFile(path, namespaceIndex, isNewImporter);
+    if (!isNull(mod)) {
+        return mod;
+    }
+
+    // a::b::c where c is the decl of a/b.k
+    const std::size_t last = path.rfind('/');
+    if (last == std::string::npos) {
+        return nullptr;
+    }
+
+    mod = GetOrAddFile(path.substr(0, last), namespaceIndex, isNewImporter);
+    if (!isNull(mod)) {
+        item = path.substr(last + 1);
     }
 
     return mod;
 }
 
 Module* ModuleManager::GenZir() {
+    logger::trace::Scope scope("gen zir");
+
     std::filesystem::path path(globals::g_config.InputFile);
 
+    m_database->NewRevision();
+
     Module* mod = GetOrAddFile(path.stem());
 
     m_pool.Wait();
@@ -124,48 +302,157 @@ Module* ModuleManager::GenZir() {
     return mod;
 }
 
+std::size_t ModuleManager::EstimateFootprint(std::size_t sourceSize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_measuredSource == 0) {
+        return sourceSize * DEFAULT_FOOTPRINT_RATIO;
+    }
+
+    return static_cast<std::size_t>(
+        static_cast<double>(sourceSize) * static_cast<double>(m_measuredBytes) / static_cast<double>(m_measuredSource)
+    );
+}
+
+void ModuleManager::MeasureFootprint(std::size_t sourceSize, std::size_t footprint) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_measuredSource += sourceSize;
+    m_measuredBytes += footprint;
+}
+
+void ModuleManager::LoadPendingJob(ThreadContext context) {
+    ModuleManager* manager = context.Manager;
+
+    {
+        std::lock_guard<std::mutex> lock(manager->m_mutex);
+
+        // every job takes one module, so the list isn't empty
+        const auto next = std::max_element(
+            manager->m_pending.begin(), manager->m_pending.end(),
+            [](const PendingModule& a, const PendingModule& b) {
+                return a.Importers < b.Importers || (a.Importers == b.Importers && a.Order > b.Order);
+            }
+        );
+
+        context.Mod = next->Mod;
+        *next       = manager->m_pending.back();
+        manager->m_pending.pop_back();
+    }
+
+    GenZirJob(context);
+}
+
 void ModuleManager::GenZirJob(ModuleManager::ThreadContext context) {
     Module* mod = context.Mod;
 
-    std::fstream file(mod->SystemPath);
-    mod->FileData.Content = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    mod->FileData.State   = File::FileState::LOADED;
-    file.close();
+    const std::string systemPath = mod->SystemPath.lexically_normal().string();
+
+    // the open files of the editor replace the files on disk
+    const std::string* source = nullptr;
+    if (!isNull(context.Manager) && !isNull(context.Manager->m_sources)) {
+        const auto& sources = *context.Manager->m_sources;
+        const auto iter     = sources.find(systemPath);
+
+        source = (iter == sources.end()) ? nullptr : &iter->second;
+    }
+
+    if (isNull(source) && !isNull(context.Manager) && context.Manager->LoadInterface(mod)) {
+        return;
+    }
+
+    // the budget holds the content, the tokens and the AST until the KIR is generated, then the KIR until it's released
+    std::size_t footprint = 0;
+    if (!isNull(context.Manager)) {
+        std::error_code ec;
+        std::size_t sourceSize = isNull(source) ? std::filesystem::file_size(mod->SystemPath, ec) : source->size();
+        if (ec) {
+            sourceSize = 0;
+        }
+
+        footprint = context.Manager->EstimateFootprint(sourceSize);
+
+        logger::trace::Scope scope("memory wait", mod->FileData.Filepath);
+        context.Manager->m_budget.Acquire(footprint);
+    }
 
     {
-        ast::Ast ast;
+        logger::trace::Scope scope("read", mod->FileData.Filepath);
+
+        if (!isNull(source)) {
+            mod->FileData.Content = *source;
+        } else {
+            std::ifstream file(mod->SystemPath);
+            mod->FileData.Content
+                = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        }
+    }
+
+    // the leading imports start loading while the module is parsed, the KIR confirms them
+    std::vector<std::string> scanned;
+    if (!isNull(context.Manager)) {
         {
-            ast::Parser parser(mod->FileData, mod->SystemPath.string());
-            ast = parser.Parse();
+            logger::trace::Scope scope("scan imports", mod->FileData.Filepath);
+            scanned = ast::ImportScanner(mod->FileData.Content).Scan();
+        }
 
-            if (!mod->FileData.ErrMsgs.empty()) {
-                mod->CompStatus = Module::Status::ERROR;
-                mod->FileData.PrintMsgs();
-                return;
-            }
-        } // parser lifetime
+        for (const std::string& path : scanned) {
+            std::string item;
+            context.Manager->GetOrAddImport(path, mod->NamespaceIndex, true, item);
+        }
+    }
 
-        kir::AstGen gen(mod->Kir, ast);
-        gen.Generate();
+    // the file parsed alone doesn't keep the results
+    std::optional<query::Database> single;
+    query::Database* database = isNull(context.Manager) ? &single.emplace() : context.Manager->m_database;
 
-    } // ast lifetime
+    database->SetContent(systemPath, mod->FileData.Content);
+    const auto unit = database->GetKir(systemPath, mod->FileData);
 
-    mod->CompStatus = Module::Status::PREPARED;
+    if (!isNull(context.Manager)) {
+        mod->KirBytes = unit->IsValid ? unit->KirBytes : 0;
 
-    if (!mod->FileData.ErrMsgs.empty()) {
+        context.Manager->MeasureFootprint(mod->FileData.Content.size(), unit->Footprint);
+        context.Manager->m_budget.Release(footprint, mod->KirBytes);
+    }
+
+    if (!unit->IsValid) {
         mod->CompStatus = Module::Status::ERROR;
         mod->FileData.PrintMsgs();
         return;
     }
 
+    // the module shares the KIR with the database
+    mod->Kir        = std::shared_ptr<const kir::Kir>(unit, &unit->Kir);
+    mod->SourceHash = unit->TokensHash;
+    mod->CompStatus = Module::Status::PREPARED;
+
+    if (logger::stats::g_enabled) {
+        const std::string& content = mod->FileData.Content;
+
+        logger::stats::addMemory("source", "content", 1, content.size(), content.capacity());
+        logger::stats::addSample("module source bytes", content.size());
+    }
+
+    // the messages are printed and the long-running modes keep the content in the database
+    mod->FileData.Content = std::string();
+
     // allows to parse file without following imported files
     if (isNull(context.Manager)) {
         return;
     }
 
-    for (const auto strIndex : mod->Kir.Imports) {
-        const std::string& path = mod->Kir.Strings.at(strIndex);
-        Module* importMod       = context.Manager->GetOrAddFile(path, mod->NamespaceIndex);
+    if (!isNull(context.Manager->m_ownDatabase.get())) {
+        database->Forget(systemPath);
+    }
+
+    for (std::size_t i = 0; i < mod->Kir->Imports.size(); i++) {
+        const std::string& path = mod->Kir->Strings.at(mod->Kir->Imports[i]);
+        const Index alias       = mod->Kir->ImportAliases.at(i);
+        const bool isScanned    = std::find(scanned.begin(), scanned.end(), path) != scanned.end();
+
+        std::string item;
+        Module* importMod = context.Manager->GetOrAddImport(path, mod->NamespaceIndex, !isScanned, item);
 
         if (isNull(importMod)) {
             KOOLANG_ERR_MSG("Module not found \"{}\"", path);
@@ -175,17 +462,412 @@ void ModuleManager::GenZirJob(ModuleManager::ThreadContext context) {
             continue;
         }
 
-        mod->Imports.push_back(importMod);
+        // the namespace paths aren't analyzed yet, so only the aliases of the decls are bound
+        if (!item.empty()) {
+            std::string name = isNull(alias) ? item : mod->Kir->Strings.at(alias);
+            mod->ImportedItems.push_back(Module::ImportedItem { std::move(name), importMod, std::move(item) });
+        }
+
+        if (std::find(mod->Imports.begin(), mod->Imports.end(), importMod) == mod->Imports.end()) {
+            mod->Imports.push_back(importMod);
+        }
+    }
+
+    logger::trace::Scope scope("prepare module", mod->FileData.Filepath);
+    {
+        // the jobs share the symbol map, its records and namespaces are created under the lock
+        std::lock_guard<std::mutex> lock(context.Manager->m_mutex);
+        Sema::PrepareModule(mod);
+    }
+
+    if (logger::stats::g_enabled) {
+        reportKirStats(mod);
+    }
+
+    // the KIR waits in the file until GenAir analyzes the module
+    if (context.Manager->m_budget.IsOver()) {
+        context.Manager->SpillKir(mod);
+    }
+}
+
+void ModuleManager::ReleaseKir(Module* mod) {
+    // the spilled KIR isn't in the budget
+    if (!isNull(mod->Kir.get())) {
+        m_budget.Free(mod->KirBytes);
+    }
+
+    mod->ReleaseKir();
+    mod->KirBytes = 0;
+    mod->KirSpill.clear();
+}
+
+void ModuleManager::SpillKir(Module* mod) {
+#ifdef _WIN32
+    // the KIR cache isn't loaded on Windows yet
+    DISCARD_VALUE(mod);
+    return;
+#else
+    if (isNull(mod->Kir.get()) || isNull(m_ownDatabase.get())) {
+        return;
+    }
+
+    logger::trace::Scope scope("spill kir", mod->FileData.Filepath);
+
+    // the KIR is written once, the cache already has the KIR of the files without the tokenizer messages and the
+    // modules with the same tokens share the file
+    if (mod->KirSpill.empty()) {
+        const bool useCache     = (globals::g_config.Flags & globals::Config::NO_CACHE) == 0;
+        const std::uint64_t key = kir::cache::computeKey(mod->SourceHash);
+        const auto cachePath    = kir::cache::getPath(globals::g_config.CacheDir, key);
+        const auto spillPath    = kir::cache::getPath(m_spillDir, key);
+
+        std::error_code ec;
+        if (useCache && std::filesystem::exists(cachePath, ec)) {
+            mod->KirSpill = cachePath;
+        } else if (std::filesystem::exists(spillPath, ec) || kir::cache::store(spillPath, key, *mod->Kir, {}, false)) {
+            mod->KirSpill = spillPath;
+        } else {
+            return;
+        }
+    }
+
+    m_budget.Free(mod->KirBytes);
+    mod->ReleaseKir();
+#endif
+}
+
+void ModuleManager::LoadKir(Module* mod) {
+    if (!isNull(mod->Kir.get()) || mod->KirSpill.empty()) {
+        if (!isNull(mod->Kir.get())) {
+            m_loaded[mod] = m_kirUses++;
+        }
+        return;
+    }
+
+    logger::trace::Scope scope("load spilled kir", mod->FileData.Filepath);
+
+    auto kir = std::make_shared<kir::Kir>();
+    std::string messages;
+
+    // the records and the Semas refer to the instructions, the KIR can't be generated from the changed source
+    if (!kir::cache::load(mod->KirSpill, kir::cache::computeKey(mod->SourceHash), *kir, messages)) {
+        std::cout << "ERROR: Cannot load the spilled KIR of '" << mod->FileData.Filepath << '\'' << std::endl;
+        std::exit(1);
+    }
+
+    mod->Kir = std::move(kir);
+    m_budget.Keep(mod->KirBytes);
+    m_loaded[mod] = m_kirUses++;
+}
+
+void ModuleManager::SpillOverBudget() {
+    while (!m_loaded.empty() && m_budget.IsOver()) {
+        const auto oldest = std::min_element(m_loaded.begin(), m_loaded.end(), [](const auto& a, const auto& b) {
+            return a.second < b.second;
+        });
+
+        // the released KIR is skipped
+        SpillKir(oldest->first);
+        m_loaded.erase(oldest);
+    }
+}
+
+bool ModuleManager::LoadInterface(Module* mod) {
+    // the build without the caches analyzes the sources
+    if ((globals::g_config.Flags & globals::Config::NO_CACHE) != 0) {
+        return false;
+    }
+
+    kmi::Interface moduleInterface;
+    {
+        logger::trace::Scope scope("load interface", mod->FileData.Filepath);
+
+        if (!kmi::load(mod->SystemPath, moduleInterface)) {
+            return false;
+        }
+    }
+
+    // the symbol map is shared with the other jobs of the front end
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // the first module is the entry
+    if (m_modules.front().get() == mod) {
+        return false;
+    }
+
+    for (const kmi::Decl& decl : moduleInterface.Decls) {
+        symbol::Record* rec = Map.CreateRecord(
+            mod->NamespaceIndex, decl.Name, ast::Vis::GLOBAL, decl.Kind, NULL_INDEX, NULL_INDEX, mod
+        );
+
+        rec->Ty         = decl.Ty;
+        rec->Val        = DeclCache::DecodeValue(InternPool, decl.Val);
+        rec->IsComptime = true;
+        rec->StatusDecl = symbol::Record::State::COMPLETE;
+        rec->StatusBody = symbol::Record::State::COMPLETE;
+    }
+
+    mod->SourceHash       = moduleInterface.SourceHash;
+    mod->InterfaceImports = std::move(moduleInterface.Imports);
+    mod->CompStatus       = Module::Status::INTERFACE;
+    return true;
+}
+
+std::vector<symbol::Record*> ModuleManager::CollectRoots(Module* entry) {
+    using globals::Config;
+
+    std::vector<symbol::Record*> roots;
+
+    // tests are not separate decls yet, so the whole module is analyzed
+    const bool isTest = (globals::g_config.Flags & Config::TEST) != 0;
+    const bool isBin  = globals::g_config.Command == Config::Command::BUILD_BIN;
+
+    for (auto& sema : entry->Semas) {
+        symbol::Record* rec = sema.GetRecord();
+
+        if (isTest || (isBin && rec->Name == "main") || (!isBin && rec->IsPub == ast::Vis::GLOBAL)) {
+            roots.push_back(rec);
+        }
+    }
+
+    // errors of the entry module are still reported
+    if (roots.empty()) {
+        for (auto& sema : entry->Semas) {
+            roots.push_back(sema.GetRecord());
+        }
+    }
+
+    return roots;
+}
+
+void ModuleManager::GenAir(Module* entry) {
+    logger::trace::Scope scope("gen air");
+
+    // The decls of a module are demanded only by the module itself and its importers. A module is analyzed when all
+    // its importers are done, then nothing can demand its decls and its KIR is released. The modules of the import
+    // cycles never get there, they are analyzed together at the end.
+    struct Frontier {
+        std::vector<symbol::Record*> Worklist;
+        // importers which aren't done yet
+        std::size_t Importers = 0;
+        bool IsDone           = false;
+    };
+
+    std::unordered_map<Module*, Frontier> frontier;
+    for (const auto& mod : m_modules) {
+        frontier[mod.get()];
+
+        for (Module* import : mod->Imports) {
+            frontier[import].Importers++;
+        }
+    }
+
+    frontier[entry].Worklist = CollectRoots(entry);
+
+    // the records of the imported decls exist once every module is prepared
+    for (const auto& mod : m_modules) {
+        for (const auto& item : mod->ImportedItems) {
+            // the errors of the module are already reported
+            if (item.From->CompStatus == Module::Status::ERROR) {
+                continue;
+            }
+
+            const auto& decls = Map.GetNamespace(item.From->NamespaceIndex).Decls;
+            const auto found  = decls.find(item.Item);
+
+            if (found == decls.end()) {
+                KOOLANG_ERR_MSG("Imported decl not found \"{}\" in \"{}\"", item.Item, item.From->FileData.Filepath);
+                continue;
+            }
+
+            // the interface of the library has only the pub decls, so the source is checked the same way
+            if (found->second->IsPub != ast::Vis::GLOBAL) {
+                KOOLANG_ERR_MSG("Imported decl is private \"{}\" in \"{}\"", item.Item, item.From->FileData.Filepath);
+                continue;
+            }
+
+            mod->ImportedDecls[item.Name] = found->second;
+        }
+    }
+
+    std::vector<bool> visited;
+
+    const bool useCache = (globals::g_config.Flags & globals::Config::NO_CACHE) == 0;
+
+    DeclCache cache(*this, globals::g_config.CacheDir);
+    SemaScheduler scheduler(useCache ? &cache : nullptr, [this](Module* mod) { LoadKir(mod); });
+
+    for (const auto& mod : m_modules) {
+        if (!isNull(mod->Kir.get())) {
+            m_loaded[mod.get()] = m_kirUses++;
+        }
+    }
+
+    const auto analyze = [this, &frontier, &visited, &scheduler](std::vector<symbol::Record*>& worklist) {
+        while (!worklist.empty()) {
+            symbol::Record* rec = worklist.back();
+            worklist.pop_back();
+
+            if (rec->Id >= visited.size()) {
+                visited.resize(rec->Id + 1, false);
+            }
+
+            // the decls of the interfaces are complete and have no body
+            if (visited[rec->Id] || rec->Mod->CompStatus == Module::Status::INTERFACE) {
+                continue;
+            }
+            visited[rec->Id] = true;
+
+            // the decl could be already analyzed as a dependency of other decl
+            scheduler.AnalyzeDecl(rec);
+
+            Sema* sema = rec->Mod->GetSema(rec);
+            {
+                logger::trace::Scope body("analyze body", rec->Mod->FileData.Filepath, rec->Name);
+
+                // the restored decls don't read the KIR
+                if (rec->StatusBody == symbol::Record::State::NOT_ANALYZED) {
+                    LoadKir(rec->Mod);
+                }
+                sema->Analyze();
+            }
+
+            for (const Index id : sema->GetReferences()) {
+                symbol::Record* reference = Map.GetRecord(id);
+                Frontier& target          = frontier[reference->Mod];
+
+                // only the module and its importers reference the decls of the module
+                assert(!target.IsDone);
+                target.Worklist.push_back(reference);
+            }
+
+            SpillOverBudget();
+        }
+    };
+
+    // the order of the modules keeps the analysis deterministic
+    std::vector<Module*> ready;
+    for (const auto& mod : m_modules) {
+        if (frontier[mod.get()].Importers == 0) {
+            ready.push_back(mod.get());
+        }
+    }
+
+    while (!ready.empty()) {
+        Module* mod = ready.back();
+        ready.pop_back();
+
+        Frontier& state = frontier[mod];
+        analyze(state.Worklist);
+
+        state.IsDone = true;
+        ReleaseKir(mod);
+
+        for (Module* import : mod->Imports) {
+            if (--frontier[import].Importers == 0) {
+                ready.push_back(import);
+            }
+        }
+    }
+
+    // the import cycles
+    for (bool hasWork = true; hasWork;) {
+        hasWork = false;
+
+        for (const auto& mod : m_modules) {
+            Frontier& state = frontier[mod.get()];
+
+            if (!state.Worklist.empty()) {
+                hasWork = true;
+                analyze(state.Worklist);
+            }
+        }
     }
 
-    Sema::PrepareModule(mod);
+    for (const auto& mod : m_modules) {
+        ReleaseKir(mod.get());
+    }
+    m_loaded.clear();
+
+    m_restoredDecls = cache.GetRestoredCount();
+
+    // the references of the decls with errors can form cycles
+    if (logger::g_errorCount == 0) {
+        ReadSignatures(scheduler.GetCompleted());
+    }
+
+    // the decls analyzed with errors would hide the errors next time
+    if (useCache && logger::g_errorCount == 0) {
+        cache.Store();
+    }
 }
 
-void ModuleManager::GenAir() {
-    for (auto& mod : m_modules) {
-        for (auto& sema : mod->Semas) {
-            sema.Analyze();
+void ModuleManager::ReadSignatures(const std::vector<symbol::Record*>& completed) {
+    logger::trace::Scope scope("read signatures");
+
+    // every input is set before the first query, setting a changed input starts a new revision
+    for (const auto& mod : m_modules) {
+        const bool isInterface = mod->CompStatus == Module::Status::INTERFACE;
+
+        for (const auto& [name, rec] : Map.GetNamespace(mod->NamespaceIndex).Decls) {
+            if (rec->Mod == mod.get()) {
+                const std::uint64_t fingerprint
+                    = isInterface ? DeclCache::GetSignature(InternPool, rec) : rec->Fingerprint;
+                m_database->SetDecl(getDeclKey(rec), fingerprint);
+            }
         }
+
+        m_database->SetScope(mod->SystemPath.string(), computeScope(mod.get()));
+    }
+
+    BuildAnalyzer analyzer(*this);
+
+    // the dependencies are read first, so the queries don't recurse through the long chains
+    for (const symbol::Record* rec : completed) {
+        if (rec->Id >= m_signatures.size()) {
+            m_signatures.resize(rec->Id + 1, 0);
+        }
+
+        m_signatures[rec->Id] = m_database->GetSignature(getDeclKey(rec), analyzer);
+    }
+}
+
+void ModuleManager::ReportStats() const {
+    using namespace logger::stats;
+
+    InternPool.ReportStats();
+    Map.ReportStats();
+
+    for (const auto& mod : m_modules) {
+
+        addVector("air", "airs", mod->Airs);
+        addVector("air", "semas", mod->Semas);
+
+        std::size_t airInsts = 0;
+        for (const auto& allocated : mod->Airs) {
+            // the decls which weren't reached have no AIR
+            if (isNull(allocated.get())) {
+                continue;
+            }
+
+            const Air& air = *allocated;
+            addMemory("air", "allocated airs", 1, sizeof(Air), sizeof(Air));
+            addVector("air", "inst", air.Inst);
+            addVector("air", "type", air.Type);
+
+            addVector("air", "blocks", air.Blocks.Start);
+            addVector("air", "blocks", air.Blocks.Term);
+            addVector("air", "blocks", air.Blocks.TermOperand);
+            addVector("air", "blocks", air.Blocks.SuccStart);
+            addVector("air", "blocks", air.Blocks.Succ);
+            addVector("air", "blocks", air.Blocks.ArgStart);
+            addVector("air", "blocks", air.Blocks.Args);
+
+            addSample("decl air instructions", air.Inst.size());
+            airInsts += air.Inst.size();
+        }
+
+        addSample("module air instructions", airInsts);
     }
 }
 
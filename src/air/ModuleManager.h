@@ -1,13 +1,20 @@
 #ifndef KOOLANG_AIR_MODULEMANAGER_H
 #define KOOLANG_AIR_MODULEMANAGER_H
 
+#include "ImportResolver.h"
 #include "Module.h"
 #include "Pool.h"
 #include "symbol/SymbolMap.h"
 #include "util/Index.h"
+#include "query/Database.h"
+#include "util/MemoryBudget.h"
 #include "util/ThreadPool.h"
+#include <filesystem>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace air {
 
@@ -20,26 +27,117 @@ class ModuleManager {
     symbol::SymbolMap Map;
     Pool InternPool;
 
-    ModuleManager();
+    // The database is shared by the builds of the long-running modes, every build has its own database otherwise
+    explicit ModuleManager(query::Database* database = nullptr);
+    ~ModuleManager();
 
-    Module* GetOrAddFile(const std::string& filepathRaw, Index namespaceIndex = NULL_INDEX);
+    ModuleManager(const ModuleManager&)            = delete;
+    ModuleManager& operator=(const ModuleManager&) = delete;
+
+    // The module found again counts as imported by one more module unless the importer was already counted
+    Module* GetOrAddFile(const std::string& filepathRaw, Index namespaceIndex = NULL_INDEX, bool isNewImporter = true);
     Module* AddFileSingle(const std::string& filepathRaw, Index namespaceIndex = NULL_INDEX);
 
+    // Falls back to the module of the parent path if the last part of the import names a decl, the name of the decl
+    // is returned in the item
+    Module* GetOrAddImport(const std::string& path, Index namespaceIndex, bool isNewImporter, std::string& item);
+
     Module* GenZir();
 
-    void GenAir();
+    // Analyzes only the decls reachable from the roots of the entry module, the other decls stay NOT_ANALYZED. The KIR
+    // of every module is released when none of its decls can be demanded anymore. Over the memory budget the least
+    // recently used KIR is spilled after every analyzed decl.
+    void GenAir(Module* entry);
 
     static void GenZirJob(ThreadContext context);
 
+    // Loads the pending module which unblocks the most importers
+    static void LoadPendingJob(ThreadContext context);
+
+    // The sources are read from the map instead of the disk, e.g. the unsaved files of the editor. The keys are the
+    // normalized paths of the files.
+    void SetSources(const std::unordered_map<std::string, std::string>* sources) { m_sources = sources; }
+
+    [[nodiscard]] const std::vector<std::unique_ptr<Module>>& GetModules() const { return m_modules; }
+
+    // Returns the number of the decls restored from the decl cache by GenAir
+    [[nodiscard]] std::size_t GetRestoredDecls() const { return m_restoredDecls; }
+
+    // Returns the signature of the decl read from the query by GenAir, 0 if the decl wasn't analyzed or the build has
+    // errors
+    [[nodiscard]] std::uint64_t GetSignature(const symbol::Record* rec) const {
+        return rec->Id < m_signatures.size() ? m_signatures[rec->Id] : 0;
+    }
+
+    // Adds the memory of the AIR, the pool and the symbols and the sizes of the decls to the '--stats' report. The
+    // sources and the KIR are reported when they are loaded.
+    void ReportStats() const;
+
 private:
+    // Creates the complete records of the pub decls if the module has the up to date interface. The entry module and
+    // the open files of the editor are always compiled from the source.
+    bool LoadInterface(Module* mod);
+
+    // Returns records where the analysis starts: 'main' for binaries, public decls for libraries and every decl for
+    // tests or when there is no root
+    static std::vector<symbol::Record*> CollectRoots(Module* entry);
+
+    // Reads the signature query of every completed decl
+    void ReadSignatures(const std::vector<symbol::Record*>& completed);
+
+    // The filepath is resolved relative to the search path
     Module* CreateModuleWithNamespace(
-        Index namespaceIndex, std::filesystem::path filepathWithoutExt, const std::filesystem::path& searchPath
+        Index namespaceIndex, const std::filesystem::path& filepath, const std::filesystem::path& searchPath
     );
 
     std::vector<std::unique_ptr<Module>> m_modules;
     std::vector<std::filesystem::path> m_includePaths;
+    ImportResolver m_resolver;
+    std::unique_ptr<query::Database> m_ownDatabase;
+    query::Database* m_database;
+    const std::unordered_map<std::string, std::string>* m_sources = nullptr;
+
+    // The estimated footprint of the module is its size times the measured ratio, the first modules use the default
+    static constexpr std::size_t DEFAULT_FOOTPRINT_RATIO = 16;
+
+    struct PendingModule {
+        Module* Mod;
+        // modules which import it so far
+        std::size_t Importers;
+        // order of the discovery, the ties are loaded first in first out
+        std::size_t Order;
+    };
+
+    // Returns the estimated bytes of the front end artifacts of the source
+    std::size_t EstimateFootprint(std::size_t sourceSize);
+    void MeasureFootprint(std::size_t sourceSize, std::size_t footprint);
+
+    // Releases the KIR of the module and its share of the memory budget
+    void ReleaseKir(Module* mod);
+
+    // Writes the KIR of the module to the file and releases it, the KIR stays if it can't be written. The builds with
+    // the long-running database don't spill, the database keeps the KIR anyway.
+    void SpillKir(Module* mod);
+    // Loads the spilled KIR of the module again if it's released, the module is the last used
+    void LoadKir(Module* mod);
+    // Spills the least recently used KIR until the budget isn't over
+    void SpillOverBudget();
 
     std::mutex m_mutex;
+    std::vector<PendingModule> m_pending;
+    std::size_t m_discovered     = 0;
+    std::size_t m_measuredSource = 0;
+    std::size_t m_measuredBytes  = 0;
+    std::size_t m_restoredDecls  = 0;
+    // record id -> signature
+    std::vector<std::uint64_t> m_signatures;
+    // the content, the tokens and the AST of the loading modules and the KIR until GenAir releases or spills it
+    MemoryBudget m_budget;
+    // the spilled KIR of the modules which aren't in the KIR cache, removed with the manager
+    std::filesystem::path m_spillDir;
+    // module with the loaded KIR -> the last use by GenAir
+    std::unordered_map<Module*, std::size_t> m_loaded;
+    std::size_t m_kirUses = 0;
     ThreadPool<ThreadContext> m_pool;
 };
 
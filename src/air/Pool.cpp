@@ -1,5 +1,6 @@
 #include "Pool.h"
 #include "kir/RefInst.h"
+#include "logger/Stats.h"
 #include "util/alias.h"
 #include "util/array_util.h"
 
@@ -120,9 +121,11 @@ pool::TypeValue Pool::GetTypeValue(Index poolIndex) const {
     case pool::KeyTag::SIMPLE_VALUE:
 
     case pool::KeyTag::BYTES:
-    case pool::KeyTag::TYPE_VALUE:
     case pool::KeyTag::ARR_TYPE:
         break;
+    case pool::KeyTag::TYPE_VALUE:
+        tyVal = deserializeFromVec<pool::TypeValue>(m_extra, m_data.at(poolIndex));
+        break;
     case pool::KeyTag::INT: {
         const auto data = deserializeFromVec<pool::Int>(m_extra, m_data.at(poolIndex));
         tyVal.Ty        = data.Ty;
@@ -247,4 +250,16 @@ pool::TypeValue Pool::GetConstantTypeValue(kir::RefInst constant) {
 
     return tyVal;
 }
+
+void Pool::ReportStats() const {
+    logger::stats::addVector("pool", "bytes", Bytes);
+    logger::stats::addVector("pool", "values", Values);
+    logger::stats::addStrings("pool", "strings", Strings);
+    logger::stats::addHashMap("pool", "string lookup", m_strCache.GetMap());
+    logger::stats::addVector("pool", "extra", m_extra);
+    logger::stats::addVector("pool", "data", m_data);
+    logger::stats::addVector("pool", "tags", m_tags);
+    logger::stats::addHashMap("pool", "key lookup", m_cache);
+}
+
 }
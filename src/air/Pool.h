@@ -173,6 +173,9 @@ class Pool {
 
     Index AddValue(std::uint64_t val);
 
+    // Adds the memory of the tables to the '--stats' report
+    void ReportStats() const;
+
     std::vector<std::uint8_t> Bytes;
     std::vector<std::uint64_t> Values;
     std::vector<std::string> Strings;
@@ -17,8 +17,22 @@ void Printer::Print() {
 
     m_buffer << "NAME: " << rec->Name << '\n';
 
-    for (Index i = 1; i < m_air.Inst.size(); i++) {
-        WriteInst(i);
+    const Cfg& cfg = m_air.Blocks;
+
+    if (cfg.IsEmpty()) {
+        for (Index i = 1; i < m_air.Inst.size(); i++) {
+            WriteInst(i);
+        }
+    } else {
+        for (Index block = 0; block < cfg.BlocksCount(); block++) {
+            m_buffer << 'b' << block << ":\n";
+
+            for (Index i = cfg.Start[block]; i < cfg.Start[block + 1]; i++) {
+                WriteInst(i);
+            }
+
+            WriteTerm(block);
+        }
     }
 
     std::cout << m_buffer.str();
@@ -80,6 +94,13 @@ void Printer::WriteInst(Index ref) {
     case InstType::BIT_XOR:
         WriteBinOp(ref, "bit_xor");
         break;
+    case InstType::PARAM: {
+        const auto& data = m_air.Inst.at(ref).TyOp;
+        m_buffer << "param(";
+        WriteInternPoolData(data.Ty);
+        m_buffer << ')';
+        break;
+    }
     }
 
     m_buffer << '\n';
@@ -87,6 +108,44 @@ void Printer::WriteInst(Index ref) {
     DISCARD_VALUE(ref);
 }
 
+void Printer::WriteTerm(Index block) {
+    const Cfg& cfg      = m_air.Blocks;
+    const Index operand = cfg.TermOperand.at(block);
+
+    switch (cfg.Term.at(block)) {
+    case TermType::RET:
+        m_buffer << "ret";
+        break;
+    case TermType::BR:
+        m_buffer << "br";
+        break;
+    case TermType::COND_BR:
+        m_buffer << "cond_br";
+        break;
+    case TermType::UNREACHABLE:
+        m_buffer << "unreachable";
+        break;
+    }
+
+    if (!isNull(operand)) {
+        m_buffer << " %" << operand;
+    }
+
+    const auto succs = cfg.GetSuccessors(block);
+    for (Index i = 0; i < succs.size(); i++) {
+        m_buffer << (i == 0 && isNull(operand) ? " b" : ", b") << succs[i] << '(';
+
+        const auto args = cfg.GetArgs(cfg.GetFirstEdge(block) + i);
+        for (Index arg = 0; arg < args.size(); arg++) {
+            m_buffer << (arg == 0 ? "%" : ", %") << args[arg];
+        }
+
+        m_buffer << ')';
+    }
+
+    m_buffer << '\n';
+}
+
 void Printer::WriteBinOp(Index inst, std::string_view name) {
     const auto& data = m_air.Inst.at(inst).BinOp;
     m_buffer << name << "(%" << data.Lhs << ", %" << data.Rhs << ')';
@@ -13,6 +13,7 @@ class Printer {
 
 private:
     void WriteInst(Index ref);
+    void WriteTerm(Index block);
     void WriteConstant(Index inst);
     void WriteSymbol(Index inst);
     void WriteInternPoolData(Index index);
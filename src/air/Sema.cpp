@@ -1,10 +1,10 @@
 #include "Sema.h"
 #include "Module.h"
-#include "Printer.h"
 #include "ast/Vis.h"
 #include "kir/Extra.h"
 #include "kir/Inst.h"
 #include "type.h"
+#include "util/ScratchArena.h"
 #include "util/array_util.h"
 #include "value.h"
 #include <span>
@@ -14,23 +14,17 @@ namespace air {
 using KirType = kir::InstType;
 using KirData = kir::InstData;
 
-Sema::Sema(Module* mod, Air& air, Index kirInst, Index instCount)
+Sema::Sema(Module* mod, std::unique_ptr<Air>& air, Index kirInst, Index instCount)
     : m_mod(mod)
     , m_pool(mod->InternPool)
     , m_kir(mod->Kir)
     , m_air(air)
     , m_kirInst(kirInst)
-    , m_instCount(instCount) {
-    m_instMap.resize(m_instCount);
-
-    // reserve zero index
-    m_air.Type.emplace_back();
-    m_air.Inst.emplace_back(NULL_INDEX);
-}
+    , m_instCount(instCount) { }
 
 void Sema::PrepareModule(Module* mod) {
-    const Index topDeclsExtra = mod->Kir.Inst.at(1).NodePl.Payload.Offset;
-    const Index topDeclsCount = mod->Kir.Extra.at(topDeclsExtra);
+    const Index topDeclsExtra = mod->Kir->Inst.at(1).NodePl.Payload.Offset;
+    const Index topDeclsCount = mod->Kir->Extra.at(topDeclsExtra);
 
     mod->Airs.reserve(topDeclsCount);
     mod->Semas.reserve(topDeclsCount);
@@ -38,27 +32,39 @@ void Sema::PrepareModule(Module* mod) {
     // NULL + TOP BLOCK
     Index startOffset = 2;
     for (Index i = 1; i <= topDeclsCount; i++) {
-        const Index instOffset = mod->Kir.Extra.at(topDeclsExtra + i);
+        const Index instOffset = mod->Kir->Extra.at(topDeclsExtra + i);
 
         Sema& sema = mod->Semas.emplace_back(mod, mod->Airs.emplace_back(), instOffset, instOffset - startOffset);
         sema.AddSymbol();
 
+        sema.GetRecord()->Ordinal = i - 1;
+
+        if (mod->Kir->DeclHashes.size() == topDeclsCount) {
+            sema.GetRecord()->Fingerprint = mod->Kir->DeclHashes[i - 1];
+        }
+
         startOffset = instOffset;
     }
 }
 
 void Sema::AddSymbol() {
-    const auto& decl = m_kir.Inst.at(m_kirInst).Bin;
-    const auto& meta = deserializeFromVec<kir::extra::Decl>(m_kir.Extra, decl.Lhs.Offset);
+    const auto& decl = m_kir->Inst.at(m_kirInst).Bin;
+    const auto& meta = deserializeFromVec<kir::extra::Decl>(m_kir->Extra, decl.Lhs.Offset);
     const auto vis   = static_cast<ast::Vis>(meta.Vis);
 
     m_record = m_mod->Map.CreateRecord(
-        m_mod->NamespaceIndex, m_kir.Strings.at(meta.Name), vis, m_kirInst, NULL_INDEX, m_mod
+        m_mod->NamespaceIndex, m_kir->Strings.at(meta.Name), vis, m_kir->Type.at(m_kirInst), m_kirInst, NULL_INDEX,
+        m_mod
     );
 }
 
+const Air& Sema::GetAir() const {
+    static const Air s_empty;
+    return isNull(m_air.get()) ? s_empty : *m_air;
+}
+
 template <> void Sema::CreateConstant<KirType::INT>(const Index inst) {
-    const KirData& data = m_kir.Inst.at(inst);
+    const KirData& data = m_kir->Inst.at(inst);
 
     const Index poolIndex
         = m_pool.Put(PoolKey::CreateTypeValue(pool::keys::COMPTIME_INT_INDEX, m_pool.AddValue(data.Int)));
@@ -66,7 +72,7 @@ template <> void Sema::CreateConstant<KirType::INT>(const Index inst) {
 }
 
 template <> void Sema::CreateConstant<KirType::FLOAT>(const Index inst) {
-    const KirData& data = m_kir.Inst.at(inst);
+    const KirData& data = m_kir->Inst.at(inst);
 
     const Index poolIndex = m_pool.Put(PoolKey::CreateTypeValue(
         pool::keys::COMPTIME_FLOAT_INDEX, m_pool.AddValue(reinterpret_cast<const std::uint64_t&>(data.Float))
@@ -80,16 +86,15 @@ void Sema::AnalyzeGlobDecl() {
 
     m_record->StatusBody = Record::State::IN_PROGRESS;
 
-    const auto& decl = m_kir.Inst.at(m_kirInst).Bin;
+    const auto& decl = m_kir->Inst.at(m_kirInst).Bin;
     m_blockInst      = decl.Rhs.Offset;
 
-    if (m_kir.Type.at(decl.Rhs.Offset) == KirType::BLOCK_COMPTIME_INLINE) {
+    if (m_kir->Type.at(decl.Rhs.Offset) == KirType::BLOCK_COMPTIME_INLINE) {
         KirGlobConst(decl.Rhs.Offset);
     } else {
         KirGlobStatic(decl.Rhs.Offset);
     }
 
-    freeVecMemory(m_instMap);
     m_record->StatusBody = Record::State::COMPLETE;
 }
 
@@ -101,8 +106,9 @@ void Sema::AnalyzeDecl() {
     }
 
     m_record->StatusDecl = Record::State::IN_PROGRESS;
+    BeginScratch();
 
-    const KirType type = m_kir.Type.at(m_kirInst);
+    const KirType type = m_kir->Type.at(m_kirInst);
     switch (type) {
     // We need decl + body
     case KirType::DECL:
@@ -120,6 +126,8 @@ void Sema::AnalyzeDecl() {
     default:
         KOOLANG_UNREACHABLE();
     }
+
+    EndScratch();
     m_record->StatusDecl = Record::State::COMPLETE;
 }
 
@@ -131,8 +139,9 @@ void Sema::AnalyzeBody() {
     }
 
     m_record->StatusBody = Record::State::IN_PROGRESS;
+    BeginScratch();
 
-    const KirType type = m_kir.Type.at(m_kirInst);
+    const KirType type = m_kir->Type.at(m_kirInst);
     switch (type) {
     // We need decl + body
     case KirType::DECL:
@@ -157,25 +166,49 @@ void Sema::AnalyzeBody() {
         KOOLANG_UNREACHABLE();
     }
 
+    EndScratch();
     m_record->StatusBody = Record::State::COMPLETE;
 }
 
+void Sema::Reuse(Air air, std::vector<Index> references) {
+    m_air        = std::make_unique<Air>(std::move(air));
+    m_references = std::move(references);
+
+    m_record->StatusDecl = symbol::Record::State::COMPLETE;
+    m_record->StatusBody = symbol::Record::State::COMPLETE;
+}
+
 void Sema::Analyze() {
     AnalyzeDecl();
     AnalyzeBody();
+}
+
+void Sema::BeginScratch() {
+    m_instMap = ScratchArena<Index>::ForThread().Push(m_instCount);
 
-    freeVecMemory(m_instMap);
-    // TODO: REMOVE
-    Printer(this).Print();
+    if (isNull(m_air.get())) {
+        m_air = std::make_unique<Air>();
+    }
+
+    // reserve zero index
+    if (m_air->Inst.empty()) {
+        m_air->Type.emplace_back();
+        m_air->Inst.emplace_back(NULL_INDEX);
+    }
+}
+
+void Sema::EndScratch() {
+    ScratchArena<Index>::ForThread().Pop();
+    m_instMap = {};
 }
 
 void Sema::AnalyzeBlock(Index blockIndex) {
-    const auto block           = m_kir.Inst.at(blockIndex).NodePl;
+    const auto block           = m_kir->Inst.at(blockIndex).NodePl;
     const auto blockExtraIndex = block.Payload.Offset;
 
-    const auto itemsCount = m_kir.Extra.at(blockExtraIndex);
+    const auto itemsCount = m_kir->Extra.at(blockExtraIndex);
 
-    std::span<Index> instructions { m_kir.Extra.begin() + blockExtraIndex + 1, itemsCount };
+    std::span<const Index> instructions { m_kir->Extra.begin() + blockExtraIndex + 1, itemsCount };
 
     for (const Index inst : instructions) {
         AnalyzeInst(inst);
@@ -183,7 +216,7 @@ void Sema::AnalyzeBlock(Index blockIndex) {
 }
 
 void Sema::AnalyzeInst(Index inst) {
-    const KirType type = m_kir.Type.at(inst);
+    const KirType type = m_kir->Type.at(inst);
 
     switch (type) {
     // instruction without type
@@ -384,7 +417,18 @@ TypeInst Sema::GetTypeValue(kir::RefInst inst) {
     }
 
     tyInst.Inst = GetLocalAirInst(inst.Offset);
-    tyInst.Ty   = GetAirType(tyInst.Inst);
+
+    // the instruction failed, e.g. unresolved reference
+    if (isNull(tyInst.Inst)) {
+        return tyInst;
+    }
+
+    // the value of the decl is loaded
+    if (m_air->Type.at(tyInst.Inst) == InstType::SYMBOL) {
+        return GetSymbolTypeValue(tyInst.Inst);
+    }
+
+    tyInst.Ty = GetAirType(tyInst.Inst);
 
     return tyInst;
 }
@@ -392,15 +436,16 @@ TypeInst Sema::GetTypeValue(kir::RefInst inst) {
 Index Sema::GetAirType(Index airInst) {
     Index poolIndex;
 
-    switch (m_air.Type.at(airInst)) {
+    switch (m_air->Type.at(airInst)) {
     case InstType::CONSTANT:
-        poolIndex = m_air.Inst.at(airInst).Data;
+        poolIndex = m_air->Inst.at(airInst).Data;
         break;
     case InstType::SYMBOL:
         return GetSymbolType(airInst);
     case InstType::LOAD:
     case InstType::CAST:
-        return m_air.Inst.at(airInst).TyOp.Ty;
+    case InstType::PARAM:
+        return m_air->Inst.at(airInst).TyOp.Ty;
     case InstType::SUB:
     case InstType::MUL:
     case InstType::DIV:
@@ -411,21 +456,18 @@ Index Sema::GetAirType(Index airInst) {
     case InstType::BIT_SHL:
     case InstType::BIT_SHR:
     case InstType::BIT_XOR:
-        return GetAirType(m_air.Inst.at(airInst).BinOp.Lhs);
+        return GetAirType(m_air->Inst.at(airInst).BinOp.Lhs);
     }
 
     return m_mod->InternPool.GetType(poolIndex);
 }
 
 TypeInst Sema::GetSymbolTypeValue(Index airInst) {
-    const auto& sym           = m_air.Inst.at(airInst).Sym;
+    const auto& sym           = m_air->Inst.at(airInst).Sym;
     const symbol::Record* rec = m_mod->Map.GetRecord(sym.Decl);
 
-    if (isNull(rec->Val)) {
-        rec->Mod->GetSema(rec->KirInst)->AnalyzeBody();
-    }
-
-    if (isNull(rec->Val)) {
+    // the scheduler analyzes the decl first, the type is missing only when the analysis failed
+    if (isNull(rec->Ty)) {
         return { NULL_INDEX, NULL_INDEX };
     }
 
@@ -435,7 +477,7 @@ TypeInst Sema::GetSymbolTypeValue(Index airInst) {
 }
 
 Index Sema::GetSymbolType(Index airInst) {
-    const auto& sym = m_air.Inst.at(airInst).Sym;
+    const auto& sym = m_air->Inst.at(airInst).Sym;
     return sym.Ty;
 }
 
@@ -475,7 +517,7 @@ bool Sema::TryCastSameType(TypeInst& valA, TypeInst& valB) {
 }
 
 template <type::Operation Op> void Sema::KirArithmetic(Index inst) {
-    const auto& data = m_kir.Inst.at(inst).NodePl;
+    const auto& data = m_kir->Inst.at(inst).NodePl;
     const auto& bin  = GetKirData<kir::extra::Bin>(data.Payload.Offset);
 
     auto lhs = GetTypeValue(bin.Lhs);
@@ -497,7 +539,7 @@ template <type::Operation Op> void Sema::KirArithmetic(Index inst) {
 
     // lhs / 0 or lhs % 0
     if ((Op == type::Operation::DIV || Op == type::Operation::MOD) && IsConstant(rhs.Inst)) {
-        if (m_air.Inst.at(rhs.Inst).Data == pool::keys::ZERO_VALUE_INDEX) {
+        if (m_air->Inst.at(rhs.Inst).Data == pool::keys::ZERO_VALUE_INDEX) {
             KOOLANG_ERR_MSG("DIVISION BY ZERO");
             return;
         }
@@ -551,8 +593,8 @@ template <type::Operation Op> void Sema::EvalOp(Index inst, TypeInst lhs, TypeIn
     // TODO: floats
     KOOLANG_TODO();
 
-    const Index lhsPoolData = m_pool.GetData(m_air.Inst.at(lhs.Inst).Data);
-    const Index rhsPoolData = m_pool.GetData(m_air.Inst.at(rhs.Inst).Data);
+    const Index lhsPoolData = m_pool.GetData(m_air->Inst.at(lhs.Inst).Data);
+    const Index rhsPoolData = m_pool.GetData(m_air->Inst.at(rhs.Inst).Data);
 
     const auto lhsData = m_pool.GetExtra<pool::TypeValue>(lhsPoolData);
     const auto rhsData = m_pool.GetExtra<pool::TypeValue>(rhsPoolData);
@@ -8,6 +8,8 @@
 #include "symbol/Record.h"
 #include "type.h"
 #include "util/Index.h"
+#include <memory>
+#include <span>
 
 namespace air {
 
@@ -15,19 +17,30 @@ struct Module;
 
 class Sema {
 public:
-    Sema(Module* mod, Air& air, Index kirInst, Index instCount);
+    Sema(Module* mod, std::unique_ptr<Air>& air, Index kirInst, Index instCount);
 
     void AddSymbol();
     void Analyze();
     void AnalyzeDecl();
     void AnalyzeBody();
 
+    // Uses the result of the previous compilation instead of the analysis. The record is restored by the caller.
+    void Reuse(Air air, std::vector<Index> references);
+
+    // Creates the records of the top decls. The symbol map is shared, the caller serializes the modules.
     static void PrepareModule(Module* mod);
 
     [[nodiscard]] Index GetKirInst() const { return m_kirInst; }
     [[nodiscard]] symbol::Record* GetRecord() const { return m_record; }
     [[nodiscard]] const Module* GetModule() const { return m_mod; }
-    [[nodiscard]] const Air& GetAir() const { return m_air; }
+    // The decls which weren't analyzed or whose AIR was released have the empty AIR
+    [[nodiscard]] const Air& GetAir() const;
+
+    // Returns records of the top decls referenced by the decl, they must be analyzed before this decl
+    [[nodiscard]] std::vector<symbol::Record*> CollectDependencies() const;
+
+    // Records referenced by the decl
+    [[nodiscard]] const std::vector<Index>& GetReferences() const { return m_references; }
 
 private:
     Module* m_mod;
@@ -38,16 +51,21 @@ class Sema {
 
     Index m_kirInstProcessing;
 
-    kir::Kir& m_kir;
+    // the KIR of the module, it's loaded again by the ModuleManager when it was spilled
+    const std::shared_ptr<const kir::Kir>& m_kir;
 
-    // We can use reference because the vector will not resize.
-    Air& m_air;
+    // We can use reference because the vector will not resize. The AIR is allocated by the analysis, most decls of the
+    // imported modules are never analyzed.
+    std::unique_ptr<Air>& m_air;
 
     const Index m_kirInst;
     const Index m_instCount;
 
-    // kir -> air
-    std::vector<Index> m_instMap;
+    // kir -> air, allocated from the scratch arena only during the analysis
+    std::span<Index> m_instMap;
+
+    // ids of the referenced records, including the comptime ones which are folded to constants
+    std::vector<Index> m_references;
 
     //-- HELPER METHODS -------------------------------------------------------------------------//
 
@@ -69,11 +87,19 @@ class Sema {
     // Map the kir instruction to air instruction.
     void MapInst(Index kirInst, Index airInst) { m_instMap[GetRelativeKirIndex(kirInst)] = airInst; }
 
+    // Allocates the instruction map from the scratch arena of the thread
+    void BeginScratch();
+    // Releases the instruction map
+    void EndScratch();
+
     // Returns relative index from the m_kirInst
     [[nodiscard]] Index GetRelativeKirIndex(Index kirInst) const;
 
     // Returns index of the air instruction, which is mapped to the given kir instruction.
-    [[nodiscard]] Index GetLocalAirInst(Index kirInst) const { return m_instMap.at(GetRelativeKirIndex(kirInst)); }
+    [[nodiscard]] Index GetLocalAirInst(Index kirInst) const { return m_instMap[GetRelativeKirIndex(kirInst)]; }
+
+    // Returns the record of the top decl in the module or nullptr
+    [[nodiscard]] symbol::Record* FindTopDecl(Index nameIndex) const;
 
     // Returns index to the intern pool
     Index GetAirType(Index airInst);
@@ -95,7 +121,7 @@ class Sema {
     // false.
     bool TryCastSameType(TypeInst& valA, TypeInst& valB);
 
-    bool IsConstant(Index airInst) { return m_air.Type.at(airInst) == InstType::CONSTANT; }
+    bool IsConstant(Index airInst) { return m_air->Type.at(airInst) == InstType::CONSTANT; }
     bool AreConstants(Index airA, Index airB) { return IsConstant(airA) && IsConstant(airB); }
 
     //-- ANALYSIS METHODS -----------------------------------------------------------------------//
@@ -134,7 +160,7 @@ inline void Sema::CreateConstantFrom(Index inst, Index poolIndex) {
 }
 
 inline Index Sema::GetRelativeKirIndex(Index kirInst) const {
-    assert(kirInst >= (m_kirInst - m_instCount));
+    assert(kirInst >= (m_kirInst - m_instCount) && kirInst - (m_kirInst - m_instCount) < m_instMap.size());
     return kirInst - (m_kirInst - m_instCount);
 }
 
@@ -143,14 +169,14 @@ inline void Sema::CreateInst(InstType type, InstData data, Index kirInst) {
 }
 
 inline Index Sema::CreateInstNoMap(InstType type, InstData data) {
-    m_air.Inst.push_back(data);
-    m_air.Type.push_back(type);
+    m_air->Inst.push_back(data);
+    m_air->Type.push_back(type);
 
-    return static_cast<Index>(m_air.Inst.size() - 1);
+    return static_cast<Index>(m_air->Inst.size() - 1);
 }
 
 template <typename KirExtraData> KirExtraData Sema::GetKirData(Index extraIndex) {
-    return deserializeFromVec<KirExtraData>(m_kir.Extra, extraIndex);
+    return deserializeFromVec<KirExtraData>(m_kir->Extra, extraIndex);
 }
 
 }
@@ -0,0 +1,140 @@
+#include "SemaScheduler.h"
+#include "Module.h"
+#include "Sema.h"
+#include "logger/Trace.h"
+#include <algorithm>
+#include <cassert>
+
+namespace air {
+
+void SemaScheduler::AnalyzeDecl(symbol::Record* rec) {
+    assert(std::this_thread::get_id() == m_owner);
+
+    if (rec->StatusDecl != symbol::Record::State::NOT_ANALYZED) {
+        return;
+    }
+
+    Spawn(rec);
+
+    while (!m_ready.empty()) {
+        const auto handle = m_ready.front();
+        m_ready.pop_front();
+
+        handle.resume();
+
+        if (handle.done()) {
+            handle.destroy();
+        }
+    }
+}
+
+SemaTask SemaScheduler::Run(symbol::Record* rec) {
+    Sema* sema = rec->Mod->GetSema(rec);
+
+    // the cached decl needs the signatures of the decls it referenced last time
+    std::vector<symbol::Record*> cached;
+    if (!isNull(m_cache) && m_cache->GetDependencies(rec, cached)) {
+        bool isReady = true;
+
+        for (symbol::Record* dependency : cached) {
+            Reserve(std::max(rec->Id, dependency->Id));
+
+            // cycles are reported by the analysis
+            if (dependency == rec || IsCycle(rec, dependency)) {
+                isReady = false;
+                break;
+            }
+
+            co_await WaitDecl(rec, dependency);
+        }
+
+        logger::trace::Scope scope("restore decl", rec->Mod->FileData.Filepath, rec->Name);
+        if (isReady && m_cache->Restore(sema, cached)) {
+            scope.Stop();
+            Complete(rec);
+            co_return;
+        }
+    }
+
+    // the tasks run to the end before the next decl of GenAir, so the KIR isn't spilled while they wait
+    if (m_loadKir) {
+        m_loadKir(rec->Mod);
+    }
+
+    for (symbol::Record* dependency : sema->CollectDependencies()) {
+        co_await WaitDecl(rec, dependency);
+    }
+
+    {
+        logger::trace::Scope scope("analyze decl", rec->Mod->FileData.Filepath, rec->Name);
+        sema->AnalyzeDecl();
+    }
+    Complete(rec);
+}
+
+void SemaScheduler::Spawn(symbol::Record* rec) {
+    assert(std::this_thread::get_id() == m_owner);
+    Reserve(rec->Id);
+
+    if (m_spawned[rec->Id]) {
+        return;
+    }
+    m_spawned[rec->Id] = true;
+
+    m_ready.push_back(Run(rec).GetHandle());
+}
+
+void SemaScheduler::Complete(symbol::Record* rec) {
+    assert(std::this_thread::get_id() == m_owner);
+    m_completed.push_back(rec);
+
+    auto& waiters = m_waiters[rec->Id];
+
+    for (const auto waiter : waiters) {
+        m_ready.push_back(waiter);
+    }
+
+    waiters.clear();
+}
+
+void SemaScheduler::Reserve(Index recordId) {
+    if (recordId < m_spawned.size()) {
+        return;
+    }
+
+    m_waiters.resize(recordId + 1);
+    m_waitingFor.resize(recordId + 1, MAX_INDEX);
+    m_spawned.resize(recordId + 1, false);
+}
+
+bool SemaScheduler::IsCycle(symbol::Record* waiter, symbol::Record* dependency) const {
+    // every task waits for one record at most, so the waiting records form a chain
+    for (Index current = dependency->Id; current != MAX_INDEX; current = m_waitingFor[current]) {
+        if (current == waiter->Id) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SemaScheduler::DeclAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    SemaScheduler& scheduler = Scheduler;
+
+    scheduler.Reserve(std::max(Waiter->Id, Dependency->Id));
+
+    // the analysis continues, the reference is reported as unresolved
+    if (scheduler.IsCycle(Waiter, Dependency)) {
+        KOOLANG_ERR_MSG("CIRCULAR DEPENDENCY: '{}' -> '{}'", Waiter->Name, Dependency->Name);
+        return false;
+    }
+
+    scheduler.m_waitingFor[Waiter->Id] = Dependency->Id;
+    scheduler.m_waiters[Dependency->Id].push_back(handle);
+
+    scheduler.Spawn(Dependency);
+
+    return true;
+}
+
+}
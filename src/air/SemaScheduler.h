@@ -0,0 +1,94 @@
+#ifndef KOOLANG_AIR_SEMASCHEDULER_H
+#define KOOLANG_AIR_SEMASCHEDULER_H
+
+#include "DeclCache.h"
+#include "symbol/Record.h"
+#include "util/Index.h"
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace air {
+
+// Analysis of one decl. Starts suspended and is resumed only by the scheduler.
+class SemaTask {
+public:
+    struct promise_type {
+        SemaTask get_return_object() { return SemaTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { KOOLANG_UNREACHABLE(); }
+    };
+
+    explicit SemaTask(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle) { }
+
+    [[nodiscard]] std::coroutine_handle<promise_type> GetHandle() const { return m_handle; }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// Analyzes decls in the order of their dependencies. The decl waits until the decls it references are analyzed, so
+// long dependency chains don't grow the native stack. The scheduler isn't synchronized, the tasks are spawned and
+// resumed only by the thread which created it. The jobs of the front end are finished before GenAir creates it.
+class SemaScheduler {
+public:
+    // Decls are restored from the cache if it isn't null. The loader loads the spilled KIR of the module before its
+    // decl is analyzed.
+    explicit SemaScheduler(DeclCache* cache = nullptr, std::function<void(Module*)> loadKir = {})
+        : m_cache(cache)
+        , m_loadKir(std::move(loadKir))
+        , m_owner(std::this_thread::get_id()) { }
+
+    // Analyzes the decl of the record and all decls it depends on
+    void AnalyzeDecl(symbol::Record* rec);
+
+    // Returns the analyzed and the restored records, every record follows the records it depends on
+    [[nodiscard]] const std::vector<symbol::Record*>& GetCompleted() const { return m_completed; }
+
+private:
+    struct DeclAwaiter {
+        SemaScheduler& Scheduler;
+        symbol::Record* Waiter;
+        symbol::Record* Dependency;
+
+        [[nodiscard]] bool await_ready() const {
+            return Dependency->StatusDecl == symbol::Record::State::COMPLETE;
+        }
+        bool await_suspend(std::coroutine_handle<> handle);
+        void await_resume() { Scheduler.m_waitingFor[Waiter->Id] = MAX_INDEX; }
+    };
+
+    DeclCache* m_cache;
+    std::function<void(Module*)> m_loadKir;
+    std::thread::id m_owner;
+
+    // tasks waiting for the record
+    std::vector<std::vector<std::coroutine_handle<>>> m_waiters;
+    // record the task of the record waits for, MAX_INDEX if it doesn't wait
+    std::vector<Index> m_waitingFor;
+    std::vector<bool> m_spawned;
+    std::vector<symbol::Record*> m_completed;
+
+    std::deque<std::coroutine_handle<>> m_ready;
+
+    SemaTask Run(symbol::Record* rec);
+
+    void Spawn(symbol::Record* rec);
+    void Complete(symbol::Record* rec);
+    void Reserve(Index recordId);
+
+    // Returns if waiting for the dependency would close a cycle
+    bool IsCycle(symbol::Record* waiter, symbol::Record* dependency) const;
+
+    DeclAwaiter WaitDecl(symbol::Record* waiter, symbol::Record* dependency) { return { *this, waiter, dependency }; }
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "Pass.h"
+#include "air/type.h"
+
+namespace air::pass {
+
+const std::vector<Index>& AnalysisCache::GetTypes() {
+    if (!m_types.has_value()) {
+        m_types = m_pool.Read([this](const Pool& pool) { return type::instTypes(m_air, pool); });
+        m_computed += 1;
+    }
+
+    return *m_types;
+}
+
+const std::vector<std::uint32_t>& AnalysisCache::GetUses(Index result) {
+    if (!m_uses.has_value()) {
+        std::vector<std::uint32_t> uses(m_air.Inst.size(), 0);
+
+        for (Index inst = 1; inst < m_air.Inst.size(); inst++) {
+            forEachOperand(m_air, inst, [&](Index operand) { uses[operand] += 1; });
+        }
+
+        forEachTermOperand(m_air.Blocks, [&](Index operand) { uses[operand] += 1; });
+
+        if (!isNull(result)) {
+            uses.at(result) += 1;
+        }
+
+        m_uses = std::move(uses);
+        m_computed += 1;
+    }
+
+    return *m_uses;
+}
+
+const Predecessors& AnalysisCache::GetPredecessors() {
+    if (!m_preds.has_value()) {
+        m_preds = computePredecessors(m_air.Blocks);
+        m_computed += 1;
+    }
+
+    return *m_preds;
+}
+
+const DomTree& AnalysisCache::GetDominators() {
+    if (!m_dominators.has_value()) {
+        m_dominators = computeDominators(m_air.Blocks, GetPredecessors());
+        m_computed += 1;
+    }
+
+    return *m_dominators;
+}
+
+const LoopInfo& AnalysisCache::GetLoops() {
+    if (!m_loops.has_value()) {
+        m_loops = computeLoops(m_air.Blocks, GetPredecessors(), GetDominators());
+        m_computed += 1;
+    }
+
+    return *m_loops;
+}
+
+void AnalysisCache::Invalidate(Analysis preserved) {
+    if (!contains(preserved, Analysis::TYPES)) {
+        m_types.reset();
+    }
+
+    if (!contains(preserved, Analysis::USES)) {
+        m_uses.reset();
+    }
+
+    if (!contains(preserved, Analysis::PREDECESSORS)) {
+        m_preds.reset();
+    }
+
+    if (!contains(preserved, Analysis::DOMINATORS)) {
+        m_dominators.reset();
+    }
+
+    if (!contains(preserved, Analysis::LOOPS)) {
+        m_loops.reset();
+    }
+}
+
+}
@@ -0,0 +1,159 @@
+#ifndef KOOLANG_AIR_PASS_PASS_H
+#define KOOLANG_AIR_PASS_PASS_H
+
+#include "air/CfgAnalysis.h"
+#include "air/Inst.h"
+#include "air/Pool.h"
+#include "air/symbol/Record.h"
+#include "util/Index.h"
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace air::pass {
+
+enum class OptLevel : std::uint8_t {
+    O0,
+    O1,
+    O2,
+    OS,
+};
+
+// Set of the cached analyses
+enum class Analysis : std::uint8_t {
+    NONE         = 0,
+    TYPES        = 1 << 0,
+    USES         = 1 << 1,
+    PREDECESSORS = 1 << 2,
+    DOMINATORS   = 1 << 3,
+    LOOPS        = 1 << 4,
+    // analyses of the blocks, preserved by the passes which don't change the control flow
+    CFG = PREDECESSORS | DOMINATORS | LOOPS,
+    ALL = TYPES | USES | CFG,
+};
+
+constexpr Analysis operator|(Analysis lhs, Analysis rhs) {
+    return static_cast<Analysis>(static_cast<std::uint8_t>(lhs) | static_cast<std::uint8_t>(rhs));
+}
+
+constexpr bool contains(Analysis set, Analysis analysis) {
+    return (static_cast<std::uint8_t>(set) & static_cast<std::uint8_t>(analysis)) != 0;
+}
+
+struct PassResult {
+    bool Changed       = false;
+    Analysis Preserved = Analysis::ALL;
+
+    static constexpr PassResult Unchanged() { return { false, Analysis::ALL }; }
+    static constexpr PassResult Modified(Analysis preserved = Analysis::NONE) { return { true, preserved }; }
+};
+
+// Intern pool shared by the passes running in parallel. Reading and writing must go through the lock.
+class SharedPool {
+public:
+    SharedPool(Pool& pool)
+        : m_pool(pool) { }
+
+    template <typename Fn> auto Read(Fn fn) const {
+        std::shared_lock lock(m_mutex);
+        return fn(static_cast<const Pool&>(m_pool));
+    }
+
+    template <typename Fn> auto Write(Fn fn) {
+        std::unique_lock lock(m_mutex);
+        return fn(m_pool);
+    }
+
+private:
+    Pool& m_pool;
+    mutable std::shared_mutex m_mutex;
+};
+
+// Decl with the body which is optimized by the function passes
+struct FunctionUnit {
+    Air* Code;
+    // the record AirInst is the result instruction, passes which renumber instructions must update it
+    symbol::Record* Rec;
+};
+
+// Lazily computed analyses of the single function. Passes must report which analyses they preserve.
+class AnalysisCache {
+public:
+    AnalysisCache(const Air& air, const SharedPool& pool)
+        : m_air(air)
+        , m_pool(pool) { }
+
+    // Returns the type of every instruction
+    const std::vector<Index>& GetTypes();
+    // Returns the number of uses of every instruction, the result and the terminators count as use
+    const std::vector<std::uint32_t>& GetUses(Index result);
+    const Predecessors& GetPredecessors();
+    const DomTree& GetDominators();
+    const LoopInfo& GetLoops();
+
+    void Invalidate(Analysis preserved);
+
+    // number of computed analyses, used by the statistics
+    [[nodiscard]] std::uint32_t GetComputedCount() const { return m_computed; }
+
+private:
+    const Air& m_air;
+    const SharedPool& m_pool;
+
+    std::optional<std::vector<Index>> m_types;
+    std::optional<std::vector<std::uint32_t>> m_uses;
+    std::optional<Predecessors> m_preds;
+    std::optional<DomTree> m_dominators;
+    std::optional<LoopInfo> m_loops;
+
+    std::uint32_t m_computed = 0;
+};
+
+struct FunctionContext {
+    FunctionUnit& Unit;
+    SharedPool& InternPool;
+    AnalysisCache& Analyses;
+};
+
+struct ModuleContext {
+    std::span<FunctionUnit> Units;
+    SharedPool& InternPool;
+};
+
+using FunctionPassFn = PassResult (*)(FunctionContext& ctx);
+using ModulePassFn   = PassResult (*)(ModuleContext& ctx);
+
+// Exactly one of the functions is set. Function passes of the different decls run in parallel.
+struct PassInfo {
+    std::string_view Name;
+    FunctionPassFn Function = nullptr;
+    ModulePassFn Module     = nullptr;
+};
+
+// Returns the number of instructions without the reserved one
+inline std::uint32_t instCount(const Air& air) {
+    return air.Inst.empty() ? 0 : static_cast<std::uint32_t>(air.Inst.size() - 1);
+}
+
+// built-in passes
+
+// Checks the blocks and that every operand is defined before its use and dominates it. Never changes the AIR.
+PassResult verify(FunctionContext& ctx);
+
+// Shares the pool index of the equal constants, folds casts of the integer constants and orders operands of the
+// commutative operations.
+PassResult canonicalize(FunctionContext& ctx);
+
+// Replaces the uses of the pure instructions which compute an already available value.
+PassResult gvn(FunctionContext& ctx);
+
+// Removes the unused instructions.
+PassResult dce(FunctionContext& ctx);
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+#include "PassManager.h"
+#include "air/Module.h"
+#include "logger/Trace.h"
+#include "util/debug.h"
+#include <algorithm>
+#include <array>
+#include <iomanip>
+
+namespace air::pass {
+
+namespace {
+
+    constexpr std::array PASSES = {
+        PassInfo { .Name = "verify", .Function = verify },
+        PassInfo { .Name = "canonicalize", .Function = canonicalize },
+        PassInfo { .Name = "gvn", .Function = gvn },
+        PassInfo { .Name = "dce", .Function = dce },
+    };
+
+    // Passes of the optimization levels, every level should be a superset of the cheaper one. The linear passes run
+    // even at -O0, so the backends and the printers see the shrunk AIR. gvn hashes every instruction, it's left to the
+    // optimizing levels. -O2 repeats the pipeline, because the values merged by gvn fold again. None of the passes
+    // grows the code, so -Os runs the -O2 pipeline and cleans up once more after the last gvn.
+    constexpr std::array<std::string_view, 2> PIPELINE_O0 = { "canonicalize", "dce" };
+    constexpr std::array<std::string_view, 3> PIPELINE_O1 = { "canonicalize", "gvn", "dce" };
+    constexpr std::array<std::string_view, 6> PIPELINE_O2
+        = { "canonicalize", "gvn", "dce", "canonicalize", "gvn", "dce" };
+    constexpr std::array<std::string_view, 8> PIPELINE_OS
+        = { "canonicalize", "gvn", "dce", "canonicalize", "gvn", "dce", "canonicalize", "dce" };
+
+    template <std::size_t N> std::vector<const PassInfo*> createPipeline(const std::array<std::string_view, N>& names) {
+        std::vector<const PassInfo*> pipeline;
+        pipeline.reserve(N);
+
+        for (const auto name : names) {
+            pipeline.push_back(PassManager::FindPass(name));
+        }
+
+        return pipeline;
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    std::string_view getModuleName(const symbol::Record* rec) {
+        return isNull(rec) || isNull(rec->Mod) ? std::string_view() : rec->Mod->FileData.Filepath;
+    }
+
+}
+
+PassManager::PassManager(Pool& pool, std::vector<FunctionUnit> units, std::vector<const PassInfo*> pipeline)
+    : m_pool(pool)
+    , m_units(std::move(units))
+    , m_pipeline(std::move(pipeline)) {
+    m_analyses.reserve(m_units.size());
+    for (const auto& unit : m_units) {
+        m_analyses.emplace_back(*unit.Code, m_pool);
+    }
+
+    m_stats.resize(m_pipeline.size());
+    for (std::size_t i = 0; i < m_pipeline.size(); i++) {
+        m_stats[i].Name = m_pipeline[i]->Name;
+    }
+}
+
+std::vector<FunctionUnit> PassManager::CollectUnits(const ModuleManager& manager) {
+    std::vector<FunctionUnit> units;
+
+    for (const auto& mod : manager.GetModules()) {
+        for (std::size_t i = 0; i < mod->Semas.size(); i++) {
+            symbol::Record* rec = mod->Semas[i].GetRecord();
+
+            // analysis failed
+            if (rec->StatusBody != symbol::Record::State::COMPLETE) {
+                continue;
+            }
+
+            units.push_back({ mod->Airs[i].get(), rec });
+        }
+    }
+
+    return units;
+}
+
+const PassInfo* PassManager::FindPass(std::string_view name) {
+    const auto* found = std::find_if(PASSES.begin(), PASSES.end(), [&](const PassInfo& pass) {
+        return pass.Name == name;
+    });
+
+    return (found == PASSES.end()) ? nullptr : found;
+}
+
+std::vector<const PassInfo*> PassManager::GetPipeline(OptLevel level) {
+    switch (level) {
+    case OptLevel::O0:
+        return createPipeline(PIPELINE_O0);
+    case OptLevel::O1:
+        return createPipeline(PIPELINE_O1);
+    case OptLevel::O2:
+        return createPipeline(PIPELINE_O2);
+    case OptLevel::OS:
+        return createPipeline(PIPELINE_OS);
+    }
+
+    KOOLANG_UNREACHABLE();
+}
+
+void PassManager::Run() {
+    if (m_pipeline.empty()) {
+        return;
+    }
+
+    logger::trace::Scope scope("passes");
+
+    ThreadPool<Index> threads;
+
+    std::size_t index = 0;
+    while (index < m_pipeline.size()) {
+        if (!isNull(m_pipeline[index]->Module)) {
+            RunModulePass(index);
+            index += 1;
+            continue;
+        }
+
+        std::size_t last = index;
+        while (last < m_pipeline.size() && isNull(m_pipeline[last]->Module)) {
+            last += 1;
+        }
+
+        RunStage(threads, index, last);
+        index = last;
+    }
+}
+
+std::uint32_t PassManager::GetAnalysesComputed() const {
+    std::uint32_t count = 0;
+    for (const auto& cache : m_analyses) {
+        count += cache.GetComputedCount();
+    }
+
+    return count;
+}
+
+void PassManager::RunStage(ThreadPool<Index>& threads, std::size_t first, std::size_t last) {
+    for (Index unit = 0; unit < m_units.size(); unit++) {
+        threads.Spawn([this, first, last](Index& arg) { RunFunction(arg, first, last); }, unit);
+    }
+
+    threads.Wait();
+}
+
+void PassManager::RunFunction(Index unit, std::size_t first, std::size_t last) {
+    FunctionUnit& fn = m_units[unit];
+    FunctionContext ctx { fn, m_pool, m_analyses[unit] };
+
+    std::vector<PassStats> stats(m_pipeline.size());
+
+    for (std::size_t i = first; i < last; i++) {
+        logger::trace::Scope scope(m_pipeline[i]->Name, getModuleName(fn.Rec), isNull(fn.Rec) ? "" : fn.Rec->Name);
+
+        const auto start          = Clock::now();
+        const std::uint32_t count = instCount(*fn.Code);
+        const PassResult result   = m_pipeline[i]->Function(ctx);
+
+        if (result.Changed) {
+            ctx.Analyses.Invalidate(result.Preserved);
+
+            if constexpr (KOOLANG_DEBUG) {
+                verify(ctx);
+            }
+        }
+
+        stats[i].Runs       = 1;
+        stats[i].Changed    = result.Changed ? 1 : 0;
+        stats[i].InstBefore = count;
+        stats[i].InstAfter  = instCount(*fn.Code);
+        stats[i].Time       = Clock::now() - start;
+    }
+
+    MergeStats(stats);
+}
+
+void PassManager::RunModulePass(std::size_t index) {
+    ModuleContext ctx { m_units, m_pool };
+
+    std::uint64_t before = 0;
+    for (const auto& unit : m_units) {
+        before += instCount(*unit.Code);
+    }
+
+    const auto start        = Clock::now();
+    const PassResult result = m_pipeline[index]->Module(ctx);
+
+    PassStats& stats = m_stats[index];
+    stats.Time += Clock::now() - start;
+    stats.Runs += 1;
+    stats.InstBefore += before;
+
+    for (const auto& unit : m_units) {
+        stats.InstAfter += instCount(*unit.Code);
+    }
+
+    if (result.Changed) {
+        stats.Changed += 1;
+
+        for (auto& cache : m_analyses) {
+            cache.Invalidate(Analysis::NONE);
+        }
+    }
+}
+
+void PassManager::MergeStats(std::span<const PassStats> stats) {
+    std::lock_guard lock(m_statsMutex);
+
+    for (std::size_t i = 0; i < stats.size(); i++) {
+        m_stats[i].Runs += stats[i].Runs;
+        m_stats[i].Changed += stats[i].Changed;
+        m_stats[i].InstBefore += stats[i].InstBefore;
+        m_stats[i].InstAfter += stats[i].InstAfter;
+        m_stats[i].Time += stats[i].Time;
+    }
+}
+
+void PassManager::PrintStats(std::ostream& out) const {
+    out << std::left << std::setw(16) << "pass" << std::right << std::setw(8) << "runs" << std::setw(10) << "changed"
+        << std::setw(12) << "before" << std::setw(12) << "after" << std::setw(12) << "time [us]" << '\n';
+
+    for (const auto& stats : m_stats) {
+        out << std::left << std::setw(16) << stats.Name << std::right << std::setw(8) << stats.Runs << std::setw(10)
+            << stats.Changed << std::setw(12) << stats.InstBefore << std::setw(12) << stats.InstAfter << std::setw(12)
+            << std::chrono::duration_cast<std::chrono::microseconds>(stats.Time).count() << '\n';
+    }
+
+    out << "analyses computed: " << GetAnalysesComputed() << '\n';
+}
+
+}
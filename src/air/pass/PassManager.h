@@ -0,0 +1,72 @@
+#ifndef KOOLANG_AIR_PASS_PASSMANAGER_H
+#define KOOLANG_AIR_PASS_PASSMANAGER_H
+
+#include "Pass.h"
+#include "air/ModuleManager.h"
+#include "util/Index.h"
+#include "util/ThreadPool.h"
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace air::pass {
+
+struct PassStats {
+    std::string_view Name;
+    // number of the functions (or modules) the pass ran on
+    std::uint32_t Runs    = 0;
+    std::uint32_t Changed = 0;
+    // instruction count of all functions before and after the pass
+    std::uint64_t InstBefore = 0;
+    std::uint64_t InstAfter  = 0;
+    // sum of the time spent by all threads
+    std::chrono::nanoseconds Time { 0 };
+};
+
+// Runs the pipeline of passes over the AIR. Consecutive function passes form a stage which runs for every function in
+// parallel, module passes run alone between the stages and invalidate all cached analyses.
+class PassManager {
+public:
+    PassManager(Pool& pool, std::vector<FunctionUnit> units, std::vector<const PassInfo*> pipeline);
+
+    // Collects the analyzed decls of all modules
+    static std::vector<FunctionUnit> CollectUnits(const ModuleManager& manager);
+
+    // Returns the registered pass or nullptr
+    static const PassInfo* FindPass(std::string_view name);
+
+    static std::vector<const PassInfo*> GetPipeline(OptLevel level);
+
+    void Run();
+
+    // Statistics in the pipeline order
+    [[nodiscard]] const std::vector<PassStats>& GetStats() const { return m_stats; }
+    // Total number of the computed analyses, cached results aren't counted
+    [[nodiscard]] std::uint32_t GetAnalysesComputed() const;
+
+    void PrintStats(std::ostream& out) const;
+
+private:
+    SharedPool m_pool;
+    std::vector<FunctionUnit> m_units;
+    std::vector<const PassInfo*> m_pipeline;
+
+    std::vector<AnalysisCache> m_analyses;
+
+    std::vector<PassStats> m_stats;
+    std::mutex m_statsMutex;
+
+    // Runs the function passes [first, last) of the pipeline
+    void RunStage(ThreadPool<Index>& threads, std::size_t first, std::size_t last);
+    void RunFunction(Index unit, std::size_t first, std::size_t last);
+    void RunModulePass(std::size_t index);
+
+    void MergeStats(std::span<const PassStats> stats);
+};
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include "Pass.h"
+#include "air/type.h"
+#include "util/hash_combine.h"
+#include <optional>
+#include <unordered_map>
+
+namespace air::pass {
+
+namespace {
+
+    struct ConstKey {
+        Index Ty;
+        std::uint64_t Value;
+
+        bool operator==(const ConstKey& other) const = default;
+
+        struct Hash {
+            std::size_t operator()(const ConstKey& key) const {
+                std::size_t seed = 0;
+                hash_combine(seed, key.Ty, key.Value);
+                return seed;
+            }
+        };
+    };
+
+    bool isCommutative(InstType type) {
+        switch (type) {
+        case InstType::ADD:
+        case InstType::MUL:
+        case InstType::BIT_AND:
+        case InstType::BIT_OR:
+        case InstType::BIT_XOR:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool isIntOrComptime(Index type) { return type::isIntType(type) || type::isComptimeInt(type); }
+
+    // Returns the value truncated to the size of the integer type
+    std::uint64_t truncate(std::uint64_t value, Index type) {
+        const std::uint32_t bits = type::sizeOf(type) * 8;
+
+        if (bits == 0 || bits >= 64) {
+            return value;
+        }
+
+        const std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+        value &= mask;
+
+        // sign extension
+        if (type::isSignedInt(type) && (value >> (bits - 1)) != 0) {
+            value |= ~mask;
+        }
+
+        return value;
+    }
+
+}
+
+PassResult canonicalize(FunctionContext& ctx) {
+    Air& air = *ctx.Unit.Code;
+
+    // (type, value) -> the first pool index of the constant in the decl
+    std::unordered_map<ConstKey, Index, ConstKey::Hash> constants;
+    bool changed = false;
+
+    for (Index inst = 1; inst < air.Inst.size(); inst++) {
+        auto& data = air.Inst[inst];
+
+        switch (air.Type[inst]) {
+        case InstType::CONSTANT: {
+            const auto key = ctx.InternPool.Read([&](const Pool& pool) -> std::optional<ConstKey> {
+                const auto tyVal = pool.GetTypeValue(data.Data);
+
+                if (isNull(tyVal.Ty)) {
+                    return std::nullopt;
+                }
+
+                return ConstKey { tyVal.Ty, pool.Values.at(tyVal.Val) };
+            });
+
+            if (!key.has_value()) {
+                break;
+            }
+
+            const auto [iter, inserted] = constants.try_emplace(*key, data.Data);
+            if (!inserted && iter->second != data.Data) {
+                data.Data = iter->second;
+                changed   = true;
+            }
+            break;
+        }
+        // cast of the constant is the constant of the target type
+        case InstType::CAST: {
+            const Index ty      = data.TyOp.Ty;
+            const Index operand = data.TyOp.Operand;
+
+            if (air.Type[operand] != InstType::CONSTANT || !isIntOrComptime(ty)) {
+                break;
+            }
+
+            const auto value = ctx.InternPool.Read([&](const Pool& pool) -> std::optional<std::uint64_t> {
+                const auto tyVal = pool.GetTypeValue(air.Inst[operand].Data);
+
+                if (!isIntOrComptime(tyVal.Ty)) {
+                    return std::nullopt;
+                }
+
+                return pool.Values.at(tyVal.Val);
+            });
+
+            if (!value.has_value()) {
+                break;
+            }
+
+            const ConstKey key { ty, truncate(*value, ty) };
+            auto found = constants.find(key);
+
+            if (found == constants.end()) {
+                const Index poolIndex = ctx.InternPool.Write([&](Pool& pool) {
+                    return pool.GetOrPut(PoolKey::CreateTypeValue(ty, pool.AddValue(key.Value)));
+                });
+
+                found = constants.emplace(key, poolIndex).first;
+            }
+
+            air.Type[inst] = InstType::CONSTANT;
+            data           = InstData::CreatePoolIndex(found->second);
+            changed        = true;
+            break;
+        }
+        default:
+            // lower index first, so the value numbering finds both orders
+            if (isCommutative(air.Type[inst]) && data.BinOp.Lhs > data.BinOp.Rhs) {
+                std::swap(data.BinOp.Lhs, data.BinOp.Rhs);
+                changed = true;
+            }
+            break;
+        }
+    }
+
+    // types are kept, the cast is replaced by the constant of the same type
+    return changed ? PassResult::Modified(Analysis::TYPES | Analysis::CFG) : PassResult::Unchanged();
+}
+
+}
@@ -0,0 +1,113 @@
+#include "Pass.h"
+
+namespace air::pass {
+
+namespace {
+
+    // Removes the instructions and renumbers the rest. Removed instructions must not be used.
+    void compact(Air& air, const std::vector<bool>& dead, Index& result) {
+        const auto count = static_cast<Index>(air.Inst.size());
+
+        // old index -> new index, the reserved zero index stays
+        std::vector<Index> remap(count + 1, NULL_INDEX);
+        Index next = 1;
+
+        for (Index inst = 1; inst < count; inst++) {
+            remap[inst] = next;
+
+            if (!dead[inst]) {
+                air.Inst[next] = air.Inst[inst];
+                air.Type[next] = air.Type[inst];
+                next += 1;
+            }
+        }
+        // the end of the last block
+        remap[count] = next;
+
+        air.Inst.resize(next, NULL_INDEX);
+        air.Type.resize(next);
+
+        for (Index inst = 1; inst < next; inst++) {
+            auto& data = air.Inst[inst];
+
+            switch (air.Type[inst]) {
+            case InstType::CONSTANT:
+            case InstType::SYMBOL:
+            case InstType::PARAM:
+                break;
+            case InstType::LOAD:
+            case InstType::CAST:
+                data.TyOp.Operand = remap[data.TyOp.Operand];
+                break;
+            case InstType::ADD:
+            case InstType::SUB:
+            case InstType::MUL:
+            case InstType::DIV:
+            case InstType::MOD:
+            case InstType::BIT_AND:
+            case InstType::BIT_OR:
+            case InstType::BIT_SHL:
+            case InstType::BIT_SHR:
+            case InstType::BIT_XOR:
+                data.BinOp.Lhs = remap[data.BinOp.Lhs];
+                data.BinOp.Rhs = remap[data.BinOp.Rhs];
+                break;
+            }
+        }
+
+        Cfg& cfg = air.Blocks;
+
+        // the first kept instruction at or after the old start
+        for (auto& start : cfg.Start) {
+            start = remap[start];
+        }
+
+        for (auto& operand : cfg.TermOperand) {
+            operand = remap[operand];
+        }
+
+        for (auto& arg : cfg.Args) {
+            arg = remap[arg];
+        }
+
+        result = remap.at(result);
+    }
+
+}
+
+PassResult dce(FunctionContext& ctx) {
+    Air& air = *ctx.Unit.Code;
+
+    if (air.Inst.size() <= 1) {
+        return PassResult::Unchanged();
+    }
+
+    std::vector<std::uint32_t> uses = ctx.Analyses.GetUses(ctx.Unit.Rec->AirInst);
+    std::vector<bool> dead(air.Inst.size(), false);
+
+    bool changed = false;
+
+    // the operands are always before the instruction, so one backward walk removes the whole dead chains
+    for (auto inst = static_cast<Index>(air.Inst.size() - 1); inst > 0; inst--) {
+        // parameters are removed together with the branch arguments
+        if (uses[inst] != 0 || air.Type[inst] == InstType::PARAM) {
+            continue;
+        }
+
+        dead[inst] = true;
+        changed    = true;
+
+        forEachOperand(air, inst, [&](Index operand) { uses[operand] -= 1; });
+    }
+
+    if (!changed) {
+        return PassResult::Unchanged();
+    }
+
+    compact(air, dead, ctx.Unit.Rec->AirInst);
+
+    // blocks keep their edges
+    return PassResult::Modified(Analysis::CFG);
+}
+
+}
@@ -0,0 +1,146 @@
+#include "Pass.h"
+#include "util/hash_combine.h"
+#include <optional>
+#include <unordered_map>
+
+namespace air::pass {
+
+namespace {
+
+    struct ValueKey {
+        InstType Type;
+        Index First;
+        Index Second;
+
+        bool operator==(const ValueKey& other) const = default;
+
+        struct Hash {
+            std::size_t operator()(const ValueKey& key) const {
+                std::size_t seed = 0;
+                hash_combine(seed, static_cast<std::uint8_t>(key.Type), key.First, key.Second);
+                return seed;
+            }
+        };
+    };
+
+    // Returns the key of the pure instruction
+    std::optional<ValueKey> getKey(const Air& air, Index inst) {
+        const InstType type = air.Type[inst];
+        const auto& data    = air.Inst[inst];
+
+        switch (type) {
+        case InstType::CONSTANT:
+            return ValueKey { type, data.Data, 0 };
+        case InstType::SYMBOL:
+            return ValueKey { type, data.Sym.Decl, data.Sym.Ty };
+        case InstType::CAST:
+            return ValueKey { type, data.TyOp.Ty, data.TyOp.Operand };
+        case InstType::ADD:
+        case InstType::SUB:
+        case InstType::MUL:
+        case InstType::DIV:
+        case InstType::MOD:
+        case InstType::BIT_AND:
+        case InstType::BIT_OR:
+        case InstType::BIT_SHL:
+        case InstType::BIT_SHR:
+        case InstType::BIT_XOR:
+            return ValueKey { type, data.BinOp.Lhs, data.BinOp.Rhs };
+        // reads the memory
+        case InstType::LOAD:
+        case InstType::PARAM:
+            break;
+        }
+
+        return std::nullopt;
+    }
+
+    void replaceOperands(Air& air, Index inst, const std::vector<Index>& leader) {
+        auto& data = air.Inst[inst];
+
+        switch (air.Type[inst]) {
+        case InstType::CONSTANT:
+        case InstType::SYMBOL:
+        case InstType::PARAM:
+            break;
+        case InstType::LOAD:
+        case InstType::CAST:
+            data.TyOp.Operand = leader[data.TyOp.Operand];
+            break;
+        case InstType::ADD:
+        case InstType::SUB:
+        case InstType::MUL:
+        case InstType::DIV:
+        case InstType::MOD:
+        case InstType::BIT_AND:
+        case InstType::BIT_OR:
+        case InstType::BIT_SHL:
+        case InstType::BIT_SHR:
+        case InstType::BIT_XOR:
+            data.BinOp.Lhs = leader[data.BinOp.Lhs];
+            data.BinOp.Rhs = leader[data.BinOp.Rhs];
+            break;
+        }
+    }
+
+}
+
+PassResult gvn(FunctionContext& ctx) {
+    Air& air = *ctx.Unit.Code;
+    Cfg& cfg = air.Blocks;
+
+    // the instruction which computes the same value
+    std::vector<Index> leader(air.Inst.size());
+    for (Index inst = 0; inst < leader.size(); inst++) {
+        leader[inst] = inst;
+    }
+
+    std::unordered_map<ValueKey, Index, ValueKey::Hash> values;
+    const DomTree* dom = cfg.IsEmpty() ? nullptr : &ctx.Analyses.GetDominators();
+
+    bool changed = false;
+
+    for (Index inst = 1; inst < air.Inst.size(); inst++) {
+        replaceOperands(air, inst, leader);
+
+        const auto key = getKey(air, inst);
+        if (!key.has_value()) {
+            continue;
+        }
+
+        const auto [iter, inserted] = values.try_emplace(*key, inst);
+        if (inserted) {
+            continue;
+        }
+
+        // the value is available only if its block dominates the current one
+        if (isNull(dom) || dom->Dominates(cfg.GetBlock(iter->second), cfg.GetBlock(inst))) {
+            leader[inst] = iter->second;
+            changed      = true;
+        } else {
+            iter->second = inst;
+        }
+    }
+
+    if (!changed) {
+        return PassResult::Unchanged();
+    }
+
+    for (auto& operand : cfg.TermOperand) {
+        operand = leader[operand];
+    }
+
+    for (auto& arg : cfg.Args) {
+        arg = leader[arg];
+    }
+
+    Index& result = ctx.Unit.Rec->AirInst;
+    if (!isNull(result)) {
+        result = leader.at(result);
+    }
+
+    // replaced instructions are left for the dead code elimination
+    return PassResult::Modified(Analysis::TYPES | Analysis::CFG);
+}
+
+}
@@ -0,0 +1,89 @@
+#include "Pass.h"
+#include "air/CfgBuilder.h"
+#include "util/debug.h"
+
+namespace air::pass {
+
+namespace {
+
+    // Returns false if the arrays are inconsistent
+    bool verifyBlocks(const Air& air, [[maybe_unused]] std::string_view name) {
+        const Cfg& cfg    = air.Blocks;
+        const Index count = cfg.BlocksCount();
+
+        if (cfg.Start.size() != count + 1 || cfg.SuccStart.size() != count + 1
+            || cfg.ArgStart.size() != cfg.Succ.size() + 1 || cfg.TermOperand.size() != count
+            || cfg.Start.back() != air.Inst.size()) {
+            KOOLANG_FATAL_MSG("AIR of '{}' has inconsistent blocks", name);
+            return false;
+        }
+
+        for (Index block = 0; block < count; block++) {
+            const Index params = paramsCount(air, block);
+
+            for (Index inst = cfg.Start[block] + params; inst < cfg.Start[block + 1]; inst++) {
+                if (air.Type[inst] == InstType::PARAM) {
+                    KOOLANG_FATAL_MSG("AIR of '{}': parameter %{} is not at the start of the block", name, inst);
+                }
+            }
+
+            const auto succs = cfg.GetSuccessors(block);
+            const Index edge = cfg.GetFirstEdge(block);
+
+            for (Index i = 0; i < succs.size(); i++) {
+                if (succs[i] >= count || cfg.GetArgs(edge + i).size() != paramsCount(air, succs[i])) {
+                    KOOLANG_FATAL_MSG("AIR of '{}': invalid edge from block {}", name, block);
+                }
+            }
+        }
+
+        forEachTermOperand(cfg, [&](Index operand) {
+            if (operand == 0 || operand >= air.Inst.size()) {
+                KOOLANG_FATAL_MSG("AIR of '{}': terminator uses unknown %{}", name, operand);
+            }
+        });
+
+        return true;
+    }
+
+}
+
+PassResult verify(FunctionContext& ctx) {
+    const Air& air              = *ctx.Unit.Code;
+    const Index result          = ctx.Unit.Rec->AirInst;
+    const std::string_view name = ctx.Unit.Rec->Name;
+
+    if (air.Inst.size() != air.Type.size()) {
+        KOOLANG_FATAL_MSG("AIR of '{}' has {} instructions and {} types", name, air.Inst.size(), air.Type.size());
+    }
+
+    if (!air.Blocks.IsEmpty() && !verifyBlocks(air, name)) {
+        return PassResult::Unchanged();
+    }
+
+    // the cached analyses are not trusted
+    const Cfg& cfg    = air.Blocks;
+    const DomTree dom = computeDominators(cfg, computePredecessors(cfg));
+
+    for (Index inst = 1; inst < air.Inst.size(); inst++) {
+        const Index block = cfg.GetBlock(inst);
+
+        forEachOperand(air, inst, [&](Index operand) {
+            const Index operandBlock = cfg.GetBlock(operand);
+
+            if (operand == 0 || operand >= air.Inst.size()) {
+                KOOLANG_FATAL_MSG("AIR of '{}': %{} uses unknown %{}", name, inst, operand);
+            } else if (operandBlock == block ? operand >= inst : !dom.Dominates(operandBlock, block)) {
+                KOOLANG_FATAL_MSG("AIR of '{}': %{} is not dominated by its operand %{}", name, inst, operand);
+            }
+        });
+    }
+
+    if (!isNull(result) && result >= air.Inst.size()) {
+        KOOLANG_FATAL_MSG("AIR of '{}': result %{} is out of range", name, result);
+    }
+
+    return PassResult::Unchanged();
+}
+
+}
@@ -14,13 +14,27 @@ void Sema::KirGlobStatic(Index blockIndex) {
     KOOLANG_UNREACHABLE();
 }
 void Sema::KirGlobFnDecl() {
-    Index fnDeclIndex = m_kir.Inst.at(m_kirInst).Bin.Lhs.Offset;
+    Index fnDeclIndex = m_kir->Inst.at(m_kirInst).Bin.Lhs.Offset;
     auto fnDecl       = GetKirData<kir::extra::DeclFn>(fnDeclIndex);
     DISCARD_VALUE(fnDecl);
 
     // TODO: process return type, ...
 }
-void Sema::KirGlobFnBody() { KirGlobFnDecl(); }
+void Sema::KirGlobFnBody() {
+    KirGlobFnDecl();
+
+    // TODO: the statements are not lowered to AIR yet. The backends emit every function as the empty body which returns
+    // zero, so the non-empty bodies are rejected here.
+    const kir::RefInst bodyBlock = m_kir->Inst.at(m_kirInst).Bin.Rhs;
+    if (isNull(bodyBlock.Offset)) {
+        return;
+    }
+
+    const Index meta = m_kir->Inst.at(bodyBlock.Offset).NodePl.Payload.Offset;
+    if (GetKirData<kir::extra::Block>(meta).InstCount != 0) {
+        KOOLANG_ERR_MSG("FUNCTION BODY IS NOT SUPPORTED YET: '{}'", m_record->Name);
+    }
+}
 void Sema::KirGlobEnum() { }
 void Sema::KirGlobStruct() { }
 void Sema::KirGlobVariant() { }
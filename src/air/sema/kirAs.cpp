@@ -8,7 +8,7 @@ using KirType = kir::InstType;
 using KirData = kir::InstData;
 
 void Sema::KirAs(Index inst) {
-    const KirData& data = m_kir.Inst.at(inst);
+    const KirData& data = m_kir->Inst.at(inst);
 
     const kir::RefInst typeRef  = data.Bin.Lhs;
     const kir::RefInst valueRef = data.Bin.Rhs;
@@ -42,7 +42,7 @@ void Sema::KirAsAdvanced(kir::RefInst type, kir::RefInst val, Index inst) {
         }
 
         // we know that the val instruction is constant with comptime integer
-        const Index poolIndex  = m_air.Inst.at(airValueInst).Data;
+        const Index poolIndex  = m_air->Inst.at(airValueInst).Data;
         const Index extraIndex = m_pool.GetData(poolIndex);
         const Index valueIndex = m_pool.GetExtra<pool::TypeValue>(extraIndex).Val;
 
@@ -72,7 +72,7 @@ void Sema::KirAsAdvanced(kir::RefInst type, kir::RefInst val, Index inst) {
         }
 
         if (IsConstant(airValueInst)) {
-            const Index poolIndex     = m_air.Inst.at(airValueInst).Data;
+            const Index poolIndex     = m_air->Inst.at(airValueInst).Data;
             const Index extraIndex    = m_pool.GetData(poolIndex);
             const Index valueKeyIndex = m_pool.GetExtra<pool::Int>(extraIndex).ValueIndex;
 
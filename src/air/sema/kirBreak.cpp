@@ -3,7 +3,7 @@
 namespace air {
 
 void Sema::KirBreakInline(Index inst) {
-    const auto& data = m_kir.Inst.at(inst).Bin;
+    const auto& data = m_kir->Inst.at(inst).Bin;
 
     const Index blockInst = data.Lhs.Offset;
     const Index retInst   = data.Rhs.Offset;
@@ -16,9 +16,8 @@ void Sema::KirBreakInline(Index inst) {
         m_record->Ty      = airType;
         m_record->AirInst = airInst;
 
-        // previous instruction was constant
         if (IsConstant(airInst)) {
-            m_record->Val = m_air.Inst.back().Data;
+            m_record->Val = m_air->Inst.at(airInst).Data;
         }
     } else {
         KOOLANG_TODO();
@@ -3,31 +3,46 @@
 
 namespace air {
 
-void Sema::KirDeclRef(Index inst) {
-    const auto& data           = m_kir.Inst.at(inst).TokPl;
-    const std::string& nameStr = m_kir.Strings.at(data.Payload.Offset);
-
+symbol::Record* Sema::FindTopDecl(Index nameIndex) const {
     // We need to search only the top decls inside the module
-    const auto scope = m_mod->Map.GetNamespace(m_mod->NamespaceIndex);
-    const auto iter  = scope.Decls.find(nameStr);
+    return m_mod->FindTopDecl(m_kir->Strings.at(nameIndex));
+}
+
+std::vector<symbol::Record*> Sema::CollectDependencies() const {
+    std::vector<symbol::Record*> dependencies;
+
+    for (Index inst = m_kirInst - m_instCount; inst < m_kirInst; inst++) {
+        if (m_kir->Type.at(inst) != kir::InstType::DECL_REF) {
+            continue;
+        }
+
+        symbol::Record* rec = FindTopDecl(m_kir->Inst.at(inst).TokPl.Payload.Offset);
+        if (!isNull(rec)) {
+            dependencies.push_back(rec);
+        }
+    }
+
+    return dependencies;
+}
 
-    if (iter == scope.Decls.end()) {
+void Sema::KirDeclRef(Index inst) {
+    const auto& data          = m_kir->Inst.at(inst).TokPl;
+    const symbol::Record* rec = FindTopDecl(data.Payload.Offset);
+
+    if (isNull(rec)) {
         KOOLANG_ERR_MSG("UNKNOWN SYMBOL REFERENCE");
         return;
     }
 
-    const symbol::Record* rec = iter->second;
+    m_references.push_back(rec->Id);
 
-    // check type circular dependency
-    if (rec->StatusDecl == symbol::Record::State::IN_PROGRESS) {
-        KOOLANG_ERR_MSG("CIRCULAR DEPENDENCY");
-    } else if (rec->StatusDecl == symbol::Record::State::NOT_ANALYZED) {
-        // cannot be nullptr because we have Record
-        Sema* sema = rec->Mod->GetSema(rec->KirInst);
-        sema->AnalyzeDecl();
+    // the scheduler analyzes the dependencies first, so only the decls of a cycle are not analyzed
+    if (rec->StatusDecl != symbol::Record::State::COMPLETE) {
+        return;
     }
 
-    if (rec->IsComptime) {
+    // the value of the decl isn't always folded to a constant
+    if (rec->IsComptime && !isNull(rec->Val)) {
         CreateConstantFrom(inst, rec->Val);
     } else {
         CreateInst(InstType::SYMBOL, InstData::CreateSymbol(rec->Id, rec->Ty), inst);
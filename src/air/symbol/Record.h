@@ -2,7 +2,9 @@
 #define KOOLANG_SYMBOL_RECORD_H
 
 #include "ast/Vis.h"
+#include "kir/Inst.h"
 #include "util/Index.h"
+#include <cstdint>
 #include <string>
 
 namespace air {
@@ -12,9 +14,13 @@ namespace symbol {
 
     struct Record {
         Record() = default;
-        Record(std::string_view name, ast::Vis isPub, Index kirInst, Index airInst, Module* mod, Index scope)
+        Record(
+            std::string_view name, ast::Vis isPub, kir::InstType kind, Index kirInst, Index airInst, Module* mod,
+            Index scope
+        )
             : Name(name)
             , IsPub(isPub)
+            , Kind(kind)
             , KirInst(kirInst)
             , AirInst(airInst)
             , Mod(mod)
@@ -27,18 +33,26 @@ namespace symbol {
         };
 
         Index Id;
-        std::string_view Name;
+        // owned by the record, the KIR of the module is released after the analysis
+        std::string Name;
         ast::Vis IsPub;
+        // type of the decl instruction in the KIR
+        kir::InstType Kind = kir::InstType::NONE;
 
-        Index Ty;
-        Index Val;
+        Index Ty  = NULL_INDEX;
+        Index Val = NULL_INDEX;
 
         Index KirInst;
         Index AirInst;
 
-        Module* Mod;
+        Module* Mod = nullptr;
         Index Namespace;
 
+        // position of the top decl in the Semas of the module
+        Index Ordinal = MAX_INDEX;
+        // hash of the tokens of the decl, 0 if unknown
+        std::uint64_t Fingerprint = 0;
+
         State StatusDecl = State::NOT_ANALYZED;
         State StatusBody = State::NOT_ANALYZED;
 
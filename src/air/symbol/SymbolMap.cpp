@@ -1,5 +1,6 @@
 #include "SymbolMap.h"
 #include "air/Module.h"
+#include "logger/Stats.h"
 #include <memory>
 
 namespace air::symbol {
@@ -9,9 +10,10 @@ SymbolMap::SymbolMap() {
     m_namespaces.emplace_back(Namespace::ROOT, nullptr);
 }
 
-Record*
-SymbolMap::CreateRecord(Index scope, std::string_view name, ast::Vis vis, Index kirInst, Index airInst, Module* mod) {
-    Record* rec = m_records.emplace_back(std::make_unique<Record>(name, vis, kirInst, airInst, mod, scope)).get();
+Record* SymbolMap::CreateRecord(
+    Index scope, std::string_view name, ast::Vis vis, kir::InstType kind, Index kirInst, Index airInst, Module* mod
+) {
+    Record* rec = m_records.emplace_back(std::make_unique<Record>(name, vis, kind, kirInst, airInst, mod, scope)).get();
     rec->Id     = static_cast<Index>(m_records.size() - 1);
 
     m_namespaces[scope].Decls.emplace(name, rec);
@@ -30,4 +32,18 @@ Index SymbolMap::CreateNamespace(std::string_view name, Index parentScope, Modul
 Module* SymbolMap::GetModule(Index scope) { return m_namespaces.at(scope).Mod; }
 Namespace& SymbolMap::GetNamespace(Index scope) { return m_namespaces.at(scope); }
 
+void SymbolMap::ReportStats() const {
+    logger::stats::addVector("symbols", "record ptrs", m_records);
+
+    // the first record is the null record
+    const std::size_t records = m_records.size() - 1;
+    logger::stats::addMemory("symbols", "records", records, records * sizeof(Record), records * sizeof(Record));
+    logger::stats::addVector("symbols", "namespaces", m_namespaces);
+
+    for (const Namespace& space : m_namespaces) {
+        logger::stats::addHashMap("symbols", "sub namespaces", space.SubNamespaces);
+        logger::stats::addHashMap("symbols", "decl lookup", space.Decls);
+    }
+}
+
 }
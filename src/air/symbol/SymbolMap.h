@@ -15,13 +15,18 @@ class SymbolMap {
 public:
     SymbolMap();
 
-    Record* CreateRecord(Index scope, std::string_view name, ast::Vis vis, Index kirInst, Index airInst, Module* mod);
+    Record* CreateRecord(
+        Index scope, std::string_view name, ast::Vis vis, kir::InstType kind, Index kirInst, Index airInst, Module* mod
+    );
     Index CreateNamespace(std::string_view name, Index parentScope, Module* mod, Namespace::NamespaceType type);
 
     [[nodiscard]] Module* GetModule(Index scope);
     [[nodiscard]] Record* GetRecord(Index record) { return m_records.at(record).get(); }
     [[nodiscard]] Namespace& GetNamespace(Index scope);
 
+    // Adds the memory of the records and namespaces to the '--stats' report
+    void ReportStats() const;
+
 private:
     std::vector<Namespace> m_namespaces;
     std::vector<std::unique_ptr<Record>> m_records;
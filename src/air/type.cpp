@@ -61,4 +61,81 @@ bool canCastInt(Index fromIntType, Index toIntType) {
     }
 }
 
+std::vector<Index> instTypes(const Air& air, const Pool& pool) {
+    const auto count = static_cast<Index>(air.Inst.size());
+    std::vector<Index> types(count, NULL_INDEX);
+
+    for (Index inst = 1; inst < count; inst++) {
+        const auto& data = air.Inst[inst];
+
+        switch (air.Type[inst]) {
+        case InstType::CONSTANT:
+            types[inst] = pool.GetTypeValue(data.Data).Ty;
+            break;
+        case InstType::SYMBOL:
+            types[inst] = data.Sym.Ty;
+            break;
+        case InstType::LOAD:
+        case InstType::CAST:
+        case InstType::PARAM:
+            types[inst] = data.TyOp.Ty;
+            break;
+        case InstType::ADD:
+        case InstType::SUB:
+        case InstType::MUL:
+        case InstType::DIV:
+        case InstType::MOD:
+        case InstType::BIT_AND:
+        case InstType::BIT_OR:
+        case InstType::BIT_SHL:
+        case InstType::BIT_SHR:
+        case InstType::BIT_XOR:
+            types[inst] = types[data.BinOp.Lhs];
+            break;
+        }
+    }
+
+    return types;
+}
+
+std::uint32_t sizeOf(Index type) {
+    using pool::SimpleType;
+    using pool::keys::ALL_KEYS;
+
+    if (!isPrimitive(type) || ALL_KEYS.at(type).Tag != pool::KeyTag::SIMPLE_TYPE) {
+        return 0;
+    }
+
+    switch (ALL_KEYS.at(type).Value.SimpleTy) {
+    case SimpleType::VOID:
+        return 0;
+    case SimpleType::BOOL:
+    case SimpleType::U8:
+    case SimpleType::I8:
+        return 1;
+    case SimpleType::U16:
+    case SimpleType::I16:
+    case SimpleType::F16:
+        return 2;
+    case SimpleType::U32:
+    case SimpleType::I32:
+    case SimpleType::F32:
+    case SimpleType::CHAR:
+        return 4;
+    case SimpleType::U64:
+    case SimpleType::I64:
+    case SimpleType::USIZE:
+    case SimpleType::ISIZE:
+    case SimpleType::F64:
+    case SimpleType::COMPTIME_INT:
+    case SimpleType::COMPTIME_FLOAT:
+        return 8;
+    // pointer + length
+    case SimpleType::STR:
+        return 16;
+    }
+
+    return 0;
+}
+
 }
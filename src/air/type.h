@@ -1,8 +1,10 @@
 #ifndef KOOLANG_AIR_TYPE_H
 #define KOOLANG_AIR_TYPE_H
 
+#include "Inst.h"
 #include "Pool.h"
 #include "util/Index.h"
+#include <vector>
 
 namespace air::type {
 
@@ -32,6 +34,12 @@ bool isFloat(Index type);
 bool isNumber(Index type);
 
 bool canCastInt(Index fromIntType, Index toIntType);
+
+// Returns the type of every instruction.
+std::vector<Index> instTypes(const Air& air, const Pool& pool);
+
+// Returns size of the primitive type in bytes. Comptime types have the size of the largest type.
+std::uint32_t sizeOf(Index type);
 inline bool areSame(Index typeA, Index typeB) { return typeA == typeB; }
 
 // Returns if the type is number(signed, unsigned, float), string, char or bool.
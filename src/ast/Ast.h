@@ -3,6 +3,7 @@
 
 #include "TokenList.h"
 #include "ast/Node.h"
+#include <cstdint>
 #include <vector>
 
 namespace ast {
@@ -16,6 +17,8 @@ struct Ast {
 
     std::vector<Index> Imports;
     std::vector<Index> Top;
+    // hashes of the tokens of the top statements, including their doc comments
+    std::vector<std::uint64_t> TopHashes;
     TokenList Tokens;
 };
 
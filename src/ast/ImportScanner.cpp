@@ -0,0 +1,133 @@
+#include "ImportScanner.h"
+
+namespace ast {
+
+namespace {
+
+    bool isIdentStart(char ch) { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_'; }
+
+    bool isIdentChar(char ch) { return isIdentStart(ch) || (ch >= '0' && ch <= '9'); }
+
+    bool isIdent(std::string_view tok) { return !tok.empty() && isIdentStart(tok.front()); }
+
+}
+
+void ImportScanner::SkipSpaceAndComments() {
+    while (m_index < m_text.size()) {
+        const char ch = m_text[m_index];
+
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            m_index++;
+        } else if (m_text.substr(m_index, 2) == "//") {
+            const std::size_t end = m_text.find('\n', m_index);
+            m_index               = (end == std::string_view::npos) ? m_text.size() : end;
+        } else if (m_text.substr(m_index, 2) == "/*") {
+            // the doc comments too
+            const std::size_t end = m_text.find("*/", m_index + 2);
+            m_index               = (end == std::string_view::npos) ? m_text.size() : end + 2;
+        } else {
+            break;
+        }
+    }
+}
+
+std::string_view ImportScanner::NextTok() {
+    SkipSpaceAndComments();
+
+    if (m_index == m_text.size()) {
+        return {};
+    }
+
+    const std::size_t start = m_index;
+    const char ch           = m_text[m_index];
+
+    if (isIdentStart(ch)) {
+        for (m_index++; m_index < m_text.size() && isIdentChar(m_text[m_index]); m_index++) { }
+    } else if (m_text.substr(m_index, 2) == "::") {
+        m_index += 2;
+    } else if (ch == '{' || ch == '}' || ch == ',' || ch == '=' || ch == ';') {
+        m_index++;
+    } else {
+        return {};
+    }
+
+    return m_text.substr(start, m_index - start);
+}
+
+bool ImportScanner::ScanPath(std::string& path, std::string_view& tok) {
+    path += tok;
+
+    for (tok = NextTok(); tok == "::"; tok = NextTok()) {
+        tok = NextTok();
+        if (!isIdent(tok)) {
+            return false;
+        }
+
+        path += '/';
+        path += tok;
+    }
+
+    return true;
+}
+
+std::vector<std::string> ImportScanner::Scan() {
+    std::vector<std::string> imports;
+
+    for (std::string_view tok = NextTok();; tok = NextTok()) {
+        if (tok == "pub") {
+            tok = NextTok();
+        }
+
+        if (tok != "import" || !isIdent(tok = NextTok())) {
+            break;
+        }
+
+        std::string base;
+
+        // import a::b = c;
+        if (ScanPath(base, tok)) {
+            if (tok == "=" && isIdent(NextTok())) {
+                tok = NextTok();
+            }
+
+            if (tok != ";") {
+                break;
+            }
+
+            imports.push_back(std::move(base));
+            continue;
+        }
+
+        // import a::{ b::c = c, d };
+        if (tok != "{") {
+            break;
+        }
+
+        for (tok = NextTok(); isIdent(tok);) {
+            std::string path = base;
+            path += '/';
+
+            if (!ScanPath(path, tok)) {
+                return imports;
+            }
+
+            if (tok == "=" && isIdent(NextTok())) {
+                tok = NextTok();
+            }
+
+            imports.push_back(std::move(path));
+
+            if (tok == ",") {
+                tok = NextTok();
+            }
+        }
+
+        if (tok != "}" || NextTok() != ";") {
+            break;
+        }
+    }
+
+    return imports;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef KOOLANG_AST_IMPORTSCANNER_H
+#define KOOLANG_AST_IMPORTSCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ast {
+
+// Lexes only the leading import statements of the file, so the imported files can be loaded before the file is parsed.
+// The scan stops at the first token which doesn't belong to an import, the parser reports the errors and finds the
+// imports after it.
+class ImportScanner {
+public:
+    explicit ImportScanner(std::string_view text)
+        : m_text(text) { }
+
+    // Returns the paths of the imports in the form of 'Kir::Imports', e.g. 'a/b/c'
+    std::vector<std::string> Scan();
+
+private:
+    std::string_view m_text;
+    std::size_t m_index = 0;
+
+    // Returns the next identifier or punctuation, empty at the end of the text or at an unknown character
+    std::string_view NextTok();
+    void SkipSpaceAndComments();
+
+    // ident ( :: ident )*, returns false if the path continues with ':: {'
+    bool ScanPath(std::string& path, std::string_view& tok);
+};
+
+}
+
+#endif
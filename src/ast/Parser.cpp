@@ -83,14 +83,18 @@ void Parser::InsertMeta(Index node, const std::initializer_list<Index>& values)
 void Parser::InsertData(Index node, Index data) { m_ast.Nodes[node].Rhs = data; }
 
 Ast Parser::Parse() {
-    {
-        Tokenizer tokenizer(m_file);
-        m_ast.Tokens = tokenizer.Tokenize();
-    }
+    Tokenizer tokenizer(m_file);
+    return Parse(tokenizer.Tokenize());
+}
+
+Ast Parser::Parse(TokenList tokens) {
+    m_ast.Tokens = std::move(tokens);
 
     Index result;
     auto tag = TokenTag::START_OF_FILE;
     while (m_ast.Tokens.GetCurrTok() != TokenTag::END_OF_FILE) {
+        const Index startTok = m_ast.Tokens.GetCurrIndex();
+
         m_docTok = m_ast.Tokens.EatDocComments();
         m_vis    = Vis();
 
@@ -137,6 +141,7 @@ Ast Parser::Parse() {
         }
 
         m_ast.Top.push_back(result);
+        m_ast.TopHashes.push_back(m_ast.Tokens.HashRange(startTok, m_ast.Tokens.GetCurrIndex()));
     }
 
     return m_ast;
@@ -7,6 +7,7 @@
 
 #include "File.h"
 #include "Vis.h"
+#include "TokenList.h"
 #include "ast/Ast.h"
 #include "util/Index.h"
 
@@ -18,6 +19,9 @@ class Parser {
     Parser(File& file, std::string_view filepath);
     Ast Parse();
 
+    // Parses the tokens of the file, the tokens must be created from the same content
+    Ast Parse(TokenList tokens);
+
 private:
     Ast m_ast;
     std::string_view m_filepath;
@@ -13,6 +13,15 @@ TokenList::TokenList(std::string_view sourceCode)
     TokenLocs.emplace_back();
 }
 
+std::uint64_t TokenList::HashRange(Index start, Index end) const {
+    std::uint64_t hash = 0;
+    for (Index tok = start; tok < end; tok++) {
+        hash = HashTok(hash, TokenTags.at(tok), GetTokContent(tok));
+    }
+
+    return hash;
+}
+
 TokenTag TokenList::GetTok(Index i) {
     assert(i < TokenTags.size() && "Token index out of range");
     return TokenTags.at(i);
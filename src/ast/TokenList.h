@@ -4,7 +4,9 @@
 #include "Token.h"
 #include "util/Index.h"
 #include <array>
+#include <bit>
 #include <cassert>
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
@@ -15,10 +17,18 @@ class TokenList {
     std::string_view Code;
     std::vector<TokenTag> TokenTags;
     std::vector<TokenLoc> TokenLocs;
+    // Hash of the tags and contents of the tokens. Comments and whitespace aren't tokens, so their edits keep the hash.
+    std::uint64_t Hash = 0;
 
     TokenList() = default;
     TokenList(std::string_view sourceCode);
 
+    // Adds the token to the hash
+    [[nodiscard]] static std::uint64_t HashTok(std::uint64_t hash, TokenTag tag, std::string_view content);
+
+    // Returns the hash of the tokens [start, end)
+    [[nodiscard]] std::uint64_t HashRange(Index start, Index end) const;
+
     // Gets the token at the index i
     [[nodiscard]] TokenTag GetTok(Index i);
 
@@ -90,6 +100,18 @@ class TokenList {
     Index m_token = 1;
 };
 
+inline std::uint64_t TokenList::HashTok(std::uint64_t hash, TokenTag tag, std::string_view content) {
+    // FNV-1a over the content, the tag separates the tokens
+    constexpr std::uint64_t PRIME = 0x100000001b3;
+
+    hash = (hash ^ static_cast<std::uint64_t>(tag)) * PRIME;
+    for (const char character : content) {
+        hash = (hash ^ static_cast<std::uint8_t>(character)) * PRIME;
+    }
+
+    return std::rotl(hash, 17);
+}
+
 }
 
 #endif // KOOLANG_TOKENLIST_H
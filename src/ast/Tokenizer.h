@@ -63,6 +63,7 @@ class Tokenizer {
 inline void Tokenizer::InsertTok(const TokenTag tag, const TokenLoc::Pos start, const TokenLoc::Pos len) {
     m_tokens.TokenTags.push_back(tag);
     m_tokens.TokenLocs.emplace_back(start, len);
+    m_tokens.Hash = TokenList::HashTok(m_tokens.Hash, tag, m_text.substr(start, len));
 }
 }
 
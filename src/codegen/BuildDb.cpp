@@ -0,0 +1,207 @@
+#include "BuildDb.h"
+#include "air/Module.h"
+#include "util/file.h"
+#include <bit>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+namespace codegen {
+
+namespace {
+
+    constexpr std::string_view MAGIC = "KBDB";
+
+    constexpr std::uint64_t K0 = 0x9e3779b97f4a7c15;
+    constexpr std::uint64_t K1 = 0xbf58476d1ce4e5b9;
+
+    std::uint64_t mix(std::uint64_t hash, std::uint64_t value) { return std::rotl(hash ^ (value * K0), 29) * K1; }
+
+    std::uint64_t mix(std::uint64_t hash, std::string_view value) {
+        hash = mix(hash, value.size());
+        for (const char character : value) {
+            hash = mix(hash, static_cast<std::uint8_t>(character));
+        }
+
+        return hash;
+    }
+
+    // Collects the modules imported by the module, directly or through other modules
+    void collectImports(const air::Module* mod, std::unordered_set<const air::Module*>& imports) {
+        std::vector<const air::Module*> stack(mod->Imports.begin(), mod->Imports.end());
+
+        while (!stack.empty()) {
+            const air::Module* current = stack.back();
+            stack.pop_back();
+
+            if (!imports.insert(current).second) {
+                continue;
+            }
+
+            stack.insert(stack.end(), current->Imports.begin(), current->Imports.end());
+        }
+    }
+
+}
+
+BuildDb::BuildDb(std::filesystem::path path, std::uint64_t configKey)
+    : m_path(std::move(path))
+    , m_configKey(configKey) { }
+
+void BuildDb::Load() {
+    m_previous.clear();
+
+    std::ifstream input(m_path);
+    if (!input.is_open()) {
+        return;
+    }
+
+    std::string magic;
+    std::uint32_t format    = 0;
+    std::string version;
+    std::uint64_t configKey = 0;
+
+    input >> magic >> format >> version >> std::hex >> configKey;
+
+    if (!input || magic != MAGIC || format != FORMAT_VERSION || version != VERSION || configKey != m_configKey) {
+        return;
+    }
+
+    std::string tag;
+    while (input >> tag) {
+        Entry entry;
+        std::size_t importsCount = 0;
+        std::string path;
+
+        if (tag != "M" || !(input >> entry.SourceHash >> entry.Signature >> entry.DeclsHash >> importsCount)) {
+            m_previous.clear();
+            return;
+        }
+
+        input.ignore();
+        std::getline(input, path);
+
+        for (std::size_t i = 0; i < importsCount; i++) {
+            std::string importPath;
+
+            if (!(input >> tag) || tag != "I") {
+                m_previous.clear();
+                return;
+            }
+
+            input.ignore();
+            std::getline(input, importPath);
+            entry.Imports.push_back(std::move(importPath));
+        }
+
+        m_previous[path] = std::move(entry);
+    }
+}
+
+void BuildDb::Update(const air::ModuleManager& manager, const DeclList& decls) {
+    m_current.clear();
+
+    for (const auto& mod : manager.GetModules()) {
+        Entry entry {
+            .SourceHash = mod->SourceHash,
+            .Signature  = ComputeSignature(manager, mod.get()),
+            .DeclsHash  = ComputeDeclsHash(mod.get(), decls),
+            .Imports    = {},
+        };
+
+        for (const air::Module* import : mod->Imports) {
+            entry.Imports.push_back(GetKey(import));
+        }
+
+        m_current[GetKey(mod.get())] = std::move(entry);
+    }
+}
+
+bool BuildDb::IsClean(const air::Module* mod) const {
+    const auto previous = m_previous.find(GetKey(mod));
+    const auto current  = m_current.find(GetKey(mod));
+
+    if (previous == m_previous.end() || current == m_current.end()) {
+        return false;
+    }
+
+    if (previous->second.SourceHash != current->second.SourceHash
+        || previous->second.DeclsHash != current->second.DeclsHash
+        || previous->second.Imports != current->second.Imports) {
+        return false;
+    }
+
+    std::unordered_set<const air::Module*> imports;
+    collectImports(mod, imports);
+
+    // the early cutoff, imported modules with the same signature don't change the module
+    for (const air::Module* import : imports) {
+        const auto previousImport = m_previous.find(GetKey(import));
+        const auto currentImport  = m_current.find(GetKey(import));
+
+        if (previousImport == m_previous.end() || currentImport == m_current.end()
+            || currentImport->second.Signature == 0
+            || previousImport->second.Signature != currentImport->second.Signature) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BuildDb::Invalidate(const air::Module* mod) { m_current.erase(GetKey(mod)); }
+
+bool BuildDb::Store() const {
+    std::ostringstream output;
+    output << MAGIC << ' ' << FORMAT_VERSION << ' ' << VERSION << ' ' << std::hex << m_configKey << '\n';
+
+    for (const auto& [path, entry] : m_current) {
+        output << "M " << entry.SourceHash << ' ' << entry.Signature << ' ' << entry.DeclsHash << ' '
+               << entry.Imports.size() << ' ' << path << '\n';
+
+        for (const auto& import : entry.Imports) {
+            output << "I " << import << '\n';
+        }
+    }
+
+    // concurrent builds of the same directory write their own temporary files
+    return writeFileAtomic(m_path, output.str());
+}
+
+std::uint64_t BuildDb::ComputeSignature(const air::ModuleManager& manager, const air::Module* mod) {
+    using air::symbol::Record;
+
+    // the visibility isn't checked across modules yet, so every top decl can be referenced by the importers
+    std::uint64_t signature = mix(K0, mod->Semas.size());
+
+    for (const auto& sema : mod->Semas) {
+        const Record* rec = sema.GetRecord();
+
+        signature = mix(signature, rec->Name);
+        signature = mix(signature, static_cast<std::uint64_t>(rec->Kind));
+
+        const std::uint64_t declSignature = manager.GetSignature(rec);
+        if (declSignature == 0) {
+            return 0;
+        }
+        signature = mix(signature, declSignature);
+    }
+
+    // 0 is reserved for the unknown signature
+    return signature == 0 ? 1 : signature;
+}
+
+std::uint64_t BuildDb::ComputeDeclsHash(const air::Module* mod, const DeclList& decls) {
+    std::uint64_t hash = K1;
+
+    for (const auto& sema : mod->Semas) {
+        const air::symbol::Record* rec = sema.GetRecord();
+
+        hash = mix(hash, rec->Name);
+        hash = mix(hash, static_cast<std::uint64_t>(decls.GetKind(rec->Id)));
+    }
+
+    return hash;
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef KOOLANG_CODEGEN_BUILDDB_H
+#define KOOLANG_CODEGEN_BUILDDB_H
+
+#include "air/ModuleManager.h"
+#include "codegen/DeclList.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace codegen {
+
+// Database of the previous build stored in the build directory. Every module records the hash of its tokens, the
+// signature of the decls visible to the importers, the emitted decls and the paths of the resolved imports.
+//
+// The module is rebuilt if its tokens or emitted decls changed, or if the signature of any module it imports
+// (transitively) changed. Changes which keep the signatures, e.g. function bodies, don't rebuild the importers.
+class BuildDb {
+public:
+    struct Entry {
+        std::uint64_t SourceHash = 0;
+        std::uint64_t Signature  = 0;
+        std::uint64_t DeclsHash  = 0;
+        std::vector<std::string> Imports;
+    };
+
+    BuildDb(std::filesystem::path path, std::uint64_t configKey);
+
+    // Reads the database, a missing, damaged or foreign database is empty
+    void Load();
+
+    // Computes the entries of the current build
+    void Update(const air::ModuleManager& manager, const DeclList& decls);
+
+    // Returns if the artifacts of the module from the previous build are still valid
+    [[nodiscard]] bool IsClean(const air::Module* mod) const;
+
+    // Forgets the module, so it is rebuilt next time
+    void Invalidate(const air::Module* mod);
+
+    // Writes the database under a temporary name and renames it, so readers never see a partial file
+    [[nodiscard]] bool Store() const;
+
+private:
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    std::filesystem::path m_path;
+    std::uint64_t m_configKey;
+
+    std::unordered_map<std::string, Entry> m_previous;
+    std::unordered_map<std::string, Entry> m_current;
+
+    // Returns the hash of the decls of the module the importers depend on, 0 if it can't be computed
+    static std::uint64_t ComputeSignature(const air::ModuleManager& manager, const air::Module* mod);
+    static std::uint64_t ComputeDeclsHash(const air::Module* mod, const DeclList& decls);
+
+    static std::string GetKey(const air::Module* mod) { return mod->SystemPath.string(); }
+};
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "CodeGen.h"
+#include "Toolchain.h"
+#include "air/Module.h"
+#include "air/type.h"
+#include "codegen/x86_64/Assembler.h"
+#include "codegen/x86_64/Lower.h"
+#include "logger/Trace.h"
+
+namespace codegen {
+
+using x86_64::Reg;
+
+CodeGen::CodeGen(const air::ModuleManager& manager, const air::Module* entry)
+    : m_manager(manager)
+    , m_entry(entry)
+    , m_decls(manager) { }
+
+bool CodeGen::Generate() {
+    logger::trace::Scope scope("codegen");
+
+    if (!m_decls.CheckSupported(false)) {
+        return false;
+    }
+
+    m_declSymbols.assign(m_decls.Size(), NULL_INDEX);
+    m_initSymbols.assign(m_decls.Size(), NULL_INDEX);
+
+    for (Index id = 0; id < m_decls.Size(); id++) {
+        if (!isNull(m_decls.Get(id))) {
+            m_declSymbols[id] = m_obj.GetOrAddSymbol(DeclList::MangleName(m_decls.Get(id)->GetRecord()));
+        }
+    }
+
+    // the AIR of the decl isn't needed after it's lowered
+    for (Index id = 0; id < m_decls.Size(); id++) {
+        EmitDecl(id);
+
+        if (!isNull(m_decls.Get(id))) {
+            const air::symbol::Record* rec = m_decls.Get(id)->GetRecord();
+            rec->Mod->ReleaseAir(rec);
+        }
+    }
+
+    EmitEntry();
+    return true;
+}
+
+void CodeGen::EmitDecl(Index recordId) {
+    const air::Sema* sema = m_decls.Get(recordId);
+    const Index sym       = m_declSymbols[recordId];
+
+    switch (m_decls.GetKind(recordId)) {
+    case DeclKind::NONE:
+    case DeclKind::UNSUPPORTED:
+        break;
+    case DeclKind::CONST:
+        EmitConst(sema->GetRecord(), sym);
+        break;
+    case DeclKind::GLOBAL:
+        EmitGlobal(*sema, sym);
+        break;
+    case DeclKind::FN: {
+        // the body is empty, the function only returns zero
+        x86_64::Assembler as(m_obj);
+
+        m_obj.DefineSymbol(sym, elf::SectionKind::TEXT, sema->GetRecord()->IsPub == ast::Vis::GLOBAL, true);
+        x86_64::Lower(as, sema->GetAir(), m_manager.InternPool, m_declSymbols).EmitFunction(NULL_INDEX);
+        m_obj.EndSymbol(sym, as.Offset());
+        break;
+    }
+    }
+}
+
+void CodeGen::EmitConst(const air::symbol::Record* rec, Index sym) {
+    const auto& pool         = m_manager.InternPool;
+    const auto tyVal         = pool.GetTypeValue(rec->Val);
+    const auto value         = isNull(tyVal.Ty) ? 0 : pool.Values.at(tyVal.Val);
+    const std::uint32_t size = air::type::sizeOf(rec->Ty);
+    auto& rodata             = m_obj.GetSection(elf::SectionKind::RODATA);
+
+    m_obj.Align(elf::SectionKind::RODATA, size);
+    m_obj.DefineSymbol(sym, elf::SectionKind::RODATA, rec->IsPub == ast::Vis::GLOBAL, false);
+
+    // little endian, the wider values are rejected by the decl list
+    for (std::uint32_t i = 0; i < size; i++) {
+        rodata.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+
+    m_obj.EndSymbol(sym, rodata.size());
+}
+
+void CodeGen::EmitGlobal(const air::Sema& sema, Index sym) {
+    const air::symbol::Record* rec = sema.GetRecord();
+    const std::uint32_t size       = air::type::sizeOf(rec->Ty);
+    auto& data                     = m_obj.GetSection(elf::SectionKind::DATA);
+
+    m_obj.Align(elf::SectionKind::DATA, size);
+    m_obj.DefineSymbol(sym, elf::SectionKind::DATA, rec->IsPub == ast::Vis::GLOBAL, false);
+    data.resize(data.size() + size, 0);
+    m_obj.EndSymbol(sym, data.size());
+
+    // initializer
+    const Index initSym = m_obj.GetOrAddSymbol(DeclList::MangleName(rec) + ".init");
+    x86_64::Assembler as(m_obj);
+
+    m_obj.DefineSymbol(initSym, elf::SectionKind::TEXT, false, true);
+    x86_64::Lower(as, sema.GetAir(), m_manager.InternPool, m_declSymbols).EmitFunction(rec->AirInst, sym);
+    m_obj.EndSymbol(initSym, as.Offset());
+
+    m_initSymbols[rec->Id] = initSym;
+}
+
+void CodeGen::EmitEntry() {
+    x86_64::Assembler as(m_obj);
+
+    const Index mainSym = m_obj.GetOrAddSymbol("main");
+    m_obj.DefineSymbol(mainSym, elf::SectionKind::TEXT, true, true);
+
+    as.Push(Reg::RBP);
+    as.Mov(Reg::RBP, Reg::RSP);
+
+    for (const Index id : m_decls.GetInitOrder()) {
+        as.Call(m_initSymbols[id]);
+    }
+
+    const air::symbol::Record* rec = DeclList::FindMain(m_entry);
+
+    if (isNull(rec) || m_decls.GetKind(rec->Id) == DeclKind::NONE) {
+        as.MovImm(Reg::RAX, 0);
+    } else if (m_decls.GetKind(rec->Id) == DeclKind::FN) {
+        as.Call(m_declSymbols.at(rec->Id));
+    } else {
+        as.LeaSymbol(Reg::RAX, m_declSymbols.at(rec->Id));
+        as.Load(Reg::RAX, Reg::RAX, air::type::sizeOf(rec->Ty), air::type::isSignedInt(rec->Ty));
+    }
+
+    as.Pop(Reg::RBP);
+    as.Ret();
+
+    m_obj.EndSymbol(mainSym, as.Offset());
+}
+
+bool CodeGen::Link(const std::filesystem::path& object, const std::filesystem::path& output) {
+    logger::trace::Scope scope("link");
+
+    return toolchain::link({ object }, output);
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef KOOLANG_CODEGEN_CODEGEN_H
+#define KOOLANG_CODEGEN_CODEGEN_H
+
+#include "DeclList.h"
+#include "air/ModuleManager.h"
+#include "codegen/elf/Object.h"
+#include "logger/Trace.h"
+#include "util/Index.h"
+#include <filesystem>
+#include <vector>
+
+namespace codegen {
+
+// x86_64 backend. Every analyzed decl is lowered to the single relocatable ELF object:
+//  - global with comptime known value -> '.rodata' object
+//  - global with runtime value         -> '.data' object + '<name>.init' function
+//  - function                          -> '.text' function
+// The generated 'main' runs the initializers and returns the value of the entry module 'main' decl.
+class CodeGen {
+public:
+    CodeGen(const air::ModuleManager& manager, const air::Module* entry);
+
+    // Returns false if some decl cannot be lowered
+    [[nodiscard]] bool Generate();
+
+    [[nodiscard]] bool WriteObject(const std::filesystem::path& path) const {
+        logger::trace::Scope scope("write object");
+        return m_obj.Write(path);
+    }
+
+    // Links the object with the system linker ($CC or cc).
+    [[nodiscard]] static bool Link(const std::filesystem::path& object, const std::filesystem::path& output);
+
+private:
+    const air::ModuleManager& m_manager;
+    const air::Module* m_entry;
+    DeclList m_decls;
+
+    elf::Object m_obj;
+
+    // record id -> object symbol
+    std::vector<Index> m_declSymbols;
+    // record id -> initializer symbol
+    std::vector<Index> m_initSymbols;
+
+    void EmitDecl(Index recordId);
+    void EmitConst(const air::symbol::Record* rec, Index sym);
+    void EmitGlobal(const air::Sema& sema, Index sym);
+    void EmitEntry();
+};
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include "DeclList.h"
+#include "air/Module.h"
+#include "air/type.h"
+#include <algorithm>
+
+namespace codegen {
+
+namespace {
+
+    // Returns if the backends lower the values of the type, the integers, 'bool', 'char' and the 32 and 64-bit floats
+    bool isScalar(Index type) {
+        using air::pool::SimpleType;
+        using air::pool::keys::ALL_KEYS;
+
+        if (!air::type::isPrimitive(type) || ALL_KEYS.at(type).Tag != air::pool::KeyTag::SIMPLE_TYPE) {
+            return false;
+        }
+
+        const SimpleType simple = ALL_KEYS.at(type).Value.SimpleTy;
+        return simple != SimpleType::VOID && simple != SimpleType::F16 && simple != SimpleType::STR;
+    }
+
+}
+
+DeclList::DeclList(const air::ModuleManager& manager) {
+    Index recordsCount = 0;
+    for (const auto& mod : manager.GetModules()) {
+        for (const auto& sema : mod->Semas) {
+            recordsCount = std::max(recordsCount, sema.GetRecord()->Id + 1);
+        }
+    }
+
+    m_semas.assign(recordsCount, nullptr);
+    m_kinds.assign(recordsCount, DeclKind::NONE);
+    m_usesFloats.assign(recordsCount, false);
+
+    for (const auto& mod : manager.GetModules()) {
+        for (const auto& sema : mod->Semas) {
+            const Index id = sema.GetRecord()->Id;
+
+            m_semas[id] = &sema;
+            m_kinds[id] = ComputeKind(sema);
+
+            // Sema doesn't lower the control flow yet, the backends emit only the straight-line code
+            if ((m_kinds[id] == DeclKind::FN || m_kinds[id] == DeclKind::GLOBAL) && !sema.GetAir().Blocks.IsEmpty()) {
+                m_kinds[id] = DeclKind::UNSUPPORTED;
+                continue;
+            }
+
+            if (m_kinds[id] != DeclKind::CONST && m_kinds[id] != DeclKind::GLOBAL) {
+                continue;
+            }
+
+            // the first instruction is reserved
+            const auto types = air::type::instTypes(sema.GetAir(), manager.InternPool);
+            const auto first = types.empty() ? types.end() : types.begin() + 1;
+
+            // the constants without a type (strings, ...) and the types without a C name have no lowering
+            if (!isScalar(sema.GetRecord()->Ty) || !std::all_of(first, types.end(), isScalar)) {
+                m_kinds[id] = DeclKind::UNSUPPORTED;
+                continue;
+            }
+
+            m_usesFloats[id] = air::type::isFloat(sema.GetRecord()->Ty)
+                            || std::any_of(first, types.end(), air::type::isFloat);
+        }
+    }
+
+    std::vector<bool> visited(recordsCount, false);
+    for (Index id = 0; id < recordsCount; id++) {
+        OrderInit(id, visited, m_initOrder);
+    }
+}
+
+DeclKind DeclList::ComputeKind(const air::Sema& sema) {
+    using air::symbol::Record;
+
+    const Record* rec = sema.GetRecord();
+
+    // not referenced from the roots or the analysis failed
+    if (rec->StatusBody != Record::State::COMPLETE) {
+        return DeclKind::NONE;
+    }
+
+    switch (rec->Kind) {
+    case kir::InstType::DECL_FN:
+        return DeclKind::FN;
+    case kir::InstType::DECL:
+        break;
+    default:
+        return DeclKind::NONE;
+    }
+
+    if (isNull(rec->Ty)) {
+        return DeclKind::NONE;
+    }
+
+    if (air::type::sizeOf(rec->Ty) == 0) {
+        KOOLANG_TODO();
+        return DeclKind::NONE;
+    }
+
+    // TODO: the values are stored as 64-bit integers, 'str' needs the pointer and the length
+    if (air::type::sizeOf(rec->Ty) > sizeof(std::uint64_t)) {
+        return DeclKind::UNSUPPORTED;
+    }
+
+    return isNull(rec->Val) ? DeclKind::GLOBAL : DeclKind::CONST;
+}
+
+bool DeclList::CheckSupported(bool lowersFloats) const {
+    bool isSupported = true;
+
+    for (Index id = 0; id < m_semas.size(); id++) {
+        if (m_kinds[id] == DeclKind::UNSUPPORTED) {
+            KOOLANG_ERR_MSG("CANNOT LOWER THE VALUE OF '{}' YET", m_semas[id]->GetRecord()->Name);
+            isSupported = false;
+        } else if (m_usesFloats[id] && !lowersFloats) {
+            KOOLANG_ERR_MSG("CANNOT LOWER THE FLOATS OF '{}' YET", m_semas[id]->GetRecord()->Name);
+            isSupported = false;
+        }
+    }
+
+    return isSupported;
+}
+
+void DeclList::OrderInit(Index recordId, std::vector<bool>& visited, std::vector<Index>& order) const {
+    struct Frame {
+        Index RecordId;
+        Index NextInst;
+    };
+
+    // post order without recursion, dependency chains can be long
+    std::vector<Frame> stack;
+
+    const auto push = [&](Index id) {
+        if (!visited.at(id) && !isNull(m_semas.at(id))) {
+            visited[id] = true;
+            stack.push_back({ id, 1 });
+        }
+    };
+
+    push(recordId);
+
+    while (!stack.empty()) {
+        Frame& frame        = stack.back();
+        const air::Air& air = m_semas[frame.RecordId]->GetAir();
+
+        while (frame.NextInst < air.Inst.size() && air.Type[frame.NextInst] != air::InstType::SYMBOL) {
+            frame.NextInst++;
+        }
+
+        if (frame.NextInst < air.Inst.size()) {
+            const Index dependency = air.Inst[frame.NextInst++].Sym.Decl;
+            push(dependency);
+            continue;
+        }
+
+        if (m_kinds[frame.RecordId] == DeclKind::GLOBAL) {
+            order.push_back(frame.RecordId);
+        }
+        stack.pop_back();
+    }
+}
+
+const air::symbol::Record* DeclList::FindMain(const air::Module* mod) {
+    const auto& decls = mod->Map.GetNamespace(mod->NamespaceIndex).Decls;
+    const auto found  = decls.find("main");
+
+    return (found == decls.end()) ? nullptr : found->second;
+}
+
+std::string DeclList::MangleName(const air::symbol::Record* rec) {
+    std::filesystem::path path(rec->Mod->FileData.Filepath);
+
+    // 'b/mod.k' is the module 'b'
+    path = (path.stem() == "mod") ? path.parent_path() : path.replace_extension();
+
+    std::string name;
+    for (const auto& part : path) {
+        name += part.string();
+        name += '.';
+    }
+    name += rec->Name;
+
+    return name;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef KOOLANG_CODEGEN_DECLLIST_H
+#define KOOLANG_CODEGEN_DECLLIST_H
+
+#include "air/ModuleManager.h"
+#include "util/Index.h"
+#include <string>
+#include <vector>
+
+namespace codegen {
+
+enum class DeclKind : std::uint8_t {
+    // not lowered (failed analysis, types, ...)
+    NONE,
+    // global with comptime known value
+    CONST,
+    // global with runtime initializer
+    GLOBAL,
+    FN,
+    // analyzed, but the backends cannot lower it yet (wider than 64 bits, constants without a type, blocks)
+    UNSUPPORTED,
+};
+
+// Decls of all modules indexed by the record id. Shared by the backends.
+class DeclList {
+public:
+    DeclList(const air::ModuleManager& manager);
+
+    [[nodiscard]] const air::Sema* Get(Index recordId) const { return m_semas.at(recordId); }
+    [[nodiscard]] DeclKind GetKind(Index recordId) const { return m_kinds.at(recordId); }
+    [[nodiscard]] Index Size() const { return static_cast<Index>(m_semas.size()); }
+
+    // Returns record ids of the globals with initializer. Referenced globals are always initialized first. The order is
+    // computed with the list, the backends release the AIR of the emitted decls.
+    [[nodiscard]] const std::vector<Index>& GetInitOrder() const { return m_initOrder; }
+
+    // Returns the 'main' record of the module or nullptr.
+    [[nodiscard]] static const air::symbol::Record* FindMain(const air::Module* mod);
+
+    [[nodiscard]] static DeclKind ComputeKind(const air::Sema& sema);
+
+    // Reports the decls which the backend cannot lower, returns false if there is any. The native backend has no
+    // floating point instructions yet, the C backend lowers the floats.
+    [[nodiscard]] bool CheckSupported(bool lowersFloats) const;
+
+    // Returns the name of the decl symbol, e.g. 'b.c.NAME' for the decl 'NAME' inside 'b/c.k'.
+    [[nodiscard]] static std::string MangleName(const air::symbol::Record* rec);
+
+private:
+    std::vector<const air::Sema*> m_semas;
+    std::vector<DeclKind> m_kinds;
+    // the type or an instruction of the initializer is a float
+    std::vector<bool> m_usesFloats;
+    std::vector<Index> m_initOrder;
+
+    void OrderInit(Index recordId, std::vector<bool>& visited, std::vector<Index>& order) const;
+};
+
+}
+
+#endif
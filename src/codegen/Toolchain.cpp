@@ -0,0 +1,102 @@
+#include "Toolchain.h"
+#include "util/Index.h"
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace codegen::toolchain {
+
+namespace {
+
+    // Splits the words on the whitespace, the quotes and the other shell syntax are not interpreted
+    void appendWords(std::vector<std::string>& args, std::string_view words) {
+        std::size_t start = words.find_first_not_of(" \t");
+
+        while (start != std::string_view::npos) {
+            const std::size_t end = words.find_first_of(" \t", start);
+            args.emplace_back(words.substr(start, end - start));
+            start = words.find_first_not_of(" \t", end);
+        }
+    }
+
+    // $CC can carry its own arguments, e.g. 'ccache gcc'
+    std::vector<std::string> compilerArgs() {
+        std::vector<std::string> args;
+        appendWords(args, getCompiler());
+
+        if (args.empty()) {
+            args.emplace_back("cc");
+        }
+
+        return args;
+    }
+
+    // Runs the program without the shell, so the paths are passed as they are
+    bool run(const std::vector<std::string>& args) {
+        std::vector<char*> argv;
+        argv.reserve(args.size() + 1);
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+#ifdef _WIN32
+        return _spawnvp(_P_WAIT, argv[0], argv.data()) == 0;
+#else
+        pid_t pid = 0;
+        if (::posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+            return false;
+        }
+
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+    }
+
+}
+
+std::string getCompiler() {
+    const char* cc = std::getenv("CC");
+    return isNull(cc) ? "cc" : cc;
+}
+
+bool compileC(const std::filesystem::path& source, const std::filesystem::path& object, std::string_view flags) {
+    std::vector<std::string> args = compilerArgs();
+    args.emplace_back("-std=c11");
+    appendWords(args, flags);
+    args.insert(args.end(), { "-c", source.string(), "-o", object.string() });
+
+    return run(args);
+}
+
+bool link(const std::vector<std::filesystem::path>& objects, const std::filesystem::path& output) {
+    std::vector<std::string> args = compilerArgs();
+    args.insert(args.end(), { "-o", output.string() });
+
+    for (const auto& object : objects) {
+        args.push_back(object.string());
+    }
+
+#ifndef _WIN32
+    // fmod of the C backend
+    args.emplace_back("-lm");
+#endif
+
+    return run(args);
+}
+
+}
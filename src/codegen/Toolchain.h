@@ -0,0 +1,23 @@
+#ifndef KOOLANG_CODEGEN_TOOLCHAIN_H
+#define KOOLANG_CODEGEN_TOOLCHAIN_H
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Wrappers around the system C compiler ($CC or cc), which is also used as the linker driver.
+namespace codegen::toolchain {
+
+[[nodiscard]] std::string getCompiler();
+
+// Compiles C source to the object file.
+[[nodiscard]] bool compileC(
+    const std::filesystem::path& source, const std::filesystem::path& object, std::string_view flags
+);
+
+[[nodiscard]] bool link(const std::vector<std::filesystem::path>& objects, const std::filesystem::path& output);
+
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "CBackend.h"
+#include "CEmitter.h"
+#include "air/Module.h"
+#include "codegen/Toolchain.h"
+#include "logger/Trace.h"
+#include "util/debug.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <span>
+#include <sstream>
+
+namespace codegen::c {
+
+namespace {
+
+    // Returns the key of the options which change all objects
+    std::uint64_t computeConfigKey() {
+        std::uint64_t key = 0xcbf29ce484222325;
+
+        for (const std::string_view part : { std::string_view(toolchain::getCompiler()), CBackend::C_FLAGS }) {
+            for (const char character : part) {
+                key = (key ^ static_cast<std::uint8_t>(character)) * 0x100000001b3;
+            }
+            key = (key ^ 0xff) * 0x100000001b3;
+        }
+
+        return key;
+    }
+
+    constexpr std::string_view OBJECT_DIR_PREFIX = "obj-";
+
+}
+
+CBackend::CBackend(const air::ModuleManager& manager, const air::Module* entry, std::filesystem::path buildDir)
+    : m_manager(manager)
+    , m_entry(entry)
+    , m_buildDir(std::move(buildDir))
+    , m_objectDir(m_buildDir / ObjectDirName(computeConfigKey()))
+    , m_decls(manager)
+    , m_db(m_buildDir / "build.db", computeConfigKey()) { }
+
+bool CBackend::Build() {
+    logger::trace::Scope scope("c backend");
+
+    std::error_code err;
+    std::filesystem::create_directories(m_objectDir, err);
+
+    if (err || !m_decls.CheckSupported(true)) {
+        return false;
+    }
+
+    RemoveForeignObjects();
+
+    SplitUnits();
+
+    m_db.Load();
+    m_db.Update(m_manager, m_decls);
+
+    for (auto& unit : m_units) {
+        unit.IsClean = !unit.IsEntry && m_db.IsClean(unit.Mod) && std::filesystem::exists(unit.Object, err);
+    }
+
+    ThreadPool<Unit*> pool;
+    for (auto& unit : m_units) {
+        pool.Spawn([this](Unit*& arg) { BuildUnit(*arg); }, &unit);
+    }
+    pool.Wait();
+
+    for (const auto& unit : m_units) {
+        if (!unit.Ok && !unit.IsEntry) {
+            m_db.Invalidate(unit.Mod);
+        }
+    }
+
+    if (!m_db.Store()) {
+        KOOLANG_WARN_MSG("Cannot write the build database in '{}'", m_buildDir.string());
+    }
+
+    return std::all_of(m_units.begin(), m_units.end(), [](const Unit& unit) { return unit.Ok; });
+}
+
+bool CBackend::Link(const std::filesystem::path& output) const {
+    logger::trace::Scope scope("link");
+
+    std::vector<std::filesystem::path> objects;
+    objects.reserve(m_units.size());
+
+    for (const auto& unit : m_units) {
+        objects.push_back(unit.Object);
+    }
+
+    return toolchain::link(objects, output);
+}
+
+void CBackend::SplitUnits() {
+    m_units.clear();
+
+    for (const auto& mod : m_manager.GetModules()) {
+        const std::string name = UnitName(mod.get());
+
+        std::vector<Index> recordIds;
+        for (const auto& sema : mod->Semas) {
+            const Index id = sema.GetRecord()->Id;
+
+            if (m_decls.GetKind(id) != DeclKind::NONE) {
+                recordIds.push_back(id);
+            }
+        }
+
+        for (std::size_t start = 0, part = 0; start < recordIds.size(); start += UNIT_DECLS, part++) {
+            const auto ids = std::span(recordIds).subspan(start, std::min(UNIT_DECLS, recordIds.size() - start));
+
+            Unit& unit  = m_units.emplace_back();
+            unit.Source = m_buildDir / (name + '-' + std::to_string(part) + ".c");
+            unit.RecordIds.assign(ids.begin(), ids.end());
+            unit.Mod = mod.get();
+        }
+    }
+
+    Unit& entry   = m_units.emplace_back();
+    entry.Source  = m_buildDir / "main.c";
+    entry.IsEntry = true;
+
+    for (auto& unit : m_units) {
+        unit.Object = m_objectDir / unit.Source.filename();
+        unit.Object.replace_extension(".o");
+    }
+}
+
+void CBackend::RemoveForeignObjects() const {
+    std::error_code err;
+
+    for (const auto& entry : std::filesystem::directory_iterator(m_buildDir, err)) {
+        const std::string name = entry.path().filename().string();
+
+        if (entry.path() != m_objectDir && name.starts_with(OBJECT_DIR_PREFIX)) {
+            std::filesystem::remove_all(entry.path(), err);
+        }
+    }
+}
+
+std::string CBackend::ObjectDirName(std::uint64_t configKey) {
+    std::ostringstream name;
+    name << OBJECT_DIR_PREFIX << std::hex << std::setw(16) << std::setfill('0') << configKey;
+
+    return name.str();
+}
+
+void CBackend::BuildUnit(Unit& unit) const {
+    if (unit.IsClean) {
+        ReleaseAir(unit);
+        unit.Ok = true;
+        return;
+    }
+
+    CEmitter emitter(m_decls, m_manager.InternPool);
+
+    const std::string content = unit.IsEntry ? emitter.EmitEntry(m_entry) : emitter.EmitUnit(unit.RecordIds);
+
+    ReleaseAir(unit);
+
+    if (!WriteIfChanged(unit.Source, content)) {
+        unit.Ok = false;
+        return;
+    }
+
+    std::error_code err;
+    const bool hasObject = std::filesystem::exists(unit.Object, err)
+        && std::filesystem::last_write_time(unit.Object, err) >= std::filesystem::last_write_time(unit.Source, err);
+
+    unit.Ok = (hasObject && !err) || toolchain::compileC(unit.Source, unit.Object, C_FLAGS);
+}
+
+void CBackend::ReleaseAir(const Unit& unit) const {
+    // every decl is emitted by one unit, the entry only calls them
+    for (const Index id : unit.RecordIds) {
+        const air::symbol::Record* rec = m_decls.Get(id)->GetRecord();
+        rec->Mod->ReleaseAir(rec);
+    }
+}
+
+bool CBackend::WriteIfChanged(const std::filesystem::path& path, const std::string& content) {
+    std::ifstream input(path, std::ios::binary);
+
+    if (input.is_open()) {
+        const std::string current((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+        if (current == content) {
+            return true;
+        }
+    }
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << content;
+
+    return output.good();
+}
+
+std::string CBackend::UnitName(const air::Module* mod) {
+    std::filesystem::path path(mod->FileData.Filepath);
+    path.replace_extension();
+
+    std::string name;
+    for (const auto& part : path) {
+        if (!name.empty()) {
+            name += '.';
+        }
+        name += part.string();
+    }
+
+    return name;
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef KOOLANG_CODEGEN_C_CBACKEND_H
+#define KOOLANG_CODEGEN_C_CBACKEND_H
+
+#include "air/ModuleManager.h"
+#include "codegen/BuildDb.h"
+#include "codegen/DeclList.h"
+#include "util/Index.h"
+#include <filesystem>
+#include <vector>
+
+namespace codegen::c {
+
+// C backend used for the optimized builds. Every module is split to the translation units of at most UNIT_DECLS decls
+// which are emitted and compiled by the system C compiler in parallel. A unit is written only if its content changed
+// and compiled only if its object is older than the source, so the unchanged units are reused by the next build.
+// Units of the modules which are clean in the build database aren't even emitted. The objects are stored in a directory
+// named by the C compiler and its flags, so the objects of a different configuration are never linked.
+class CBackend {
+public:
+    static constexpr std::size_t UNIT_DECLS = 256;
+    static constexpr std::string_view C_FLAGS = "-O2";
+
+    CBackend(const air::ModuleManager& manager, const air::Module* entry, std::filesystem::path buildDir);
+
+    // Emits and compiles all units. Returns false if any unit failed.
+    [[nodiscard]] bool Build();
+
+    [[nodiscard]] bool Link(const std::filesystem::path& output) const;
+
+private:
+    struct Unit {
+        std::filesystem::path Source;
+        std::filesystem::path Object;
+        std::vector<Index> RecordIds;
+        const air::Module* Mod = nullptr;
+        bool IsEntry           = false;
+        // the object from the previous build is still valid
+        bool IsClean = false;
+        bool Ok      = false;
+    };
+
+    const air::ModuleManager& m_manager;
+    const air::Module* m_entry;
+    std::filesystem::path m_buildDir;
+    std::filesystem::path m_objectDir;
+    DeclList m_decls;
+    BuildDb m_db;
+
+    std::vector<Unit> m_units;
+
+    void SplitUnits();
+    // The objects of the other configurations would be rebuilt anyway
+    void RemoveForeignObjects() const;
+    void BuildUnit(Unit& unit) const;
+    // The decls of the unit are emitted or clean, so their AIR isn't needed anymore
+    void ReleaseAir(const Unit& unit) const;
+
+    // Writes the file only if the content differs. Returns false on failure.
+    [[nodiscard]] static bool WriteIfChanged(const std::filesystem::path& path, const std::string& content);
+    // Returns the name of the object directory, e.g. 'obj-00000000deadbeef'
+    [[nodiscard]] static std::string ObjectDirName(std::uint64_t configKey);
+    // Returns the unit name prefix of the module, e.g. 'b.c' for 'b/c.k'.
+    [[nodiscard]] static std::string UnitName(const air::Module* mod);
+};
+
+}
+
+#endif
@@ -0,0 +1,332 @@
+#include "CEmitter.h"
+#include "air/Module.h"
+#include "air/type.h"
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+namespace codegen::c {
+
+using air::InstType;
+
+std::string CEmitter::EmitUnit(std::span<const Index> recordIds) {
+    Reset();
+
+    // decls of the unit can reference each other in any order
+    for (const Index id : recordIds) {
+        Declare(id);
+    }
+
+    for (const Index id : recordIds) {
+        EmitDecl(id);
+    }
+
+    return Finish();
+}
+
+std::string CEmitter::EmitEntry(const air::Module* entry) {
+    Reset();
+
+    for (const Index id : m_decls.GetInitOrder()) {
+        m_head << "void " << MangleName(m_decls.Get(id)->GetRecord()) << "_init(void);\n";
+    }
+
+    m_body << "int main(void) {\n";
+
+    for (const Index id : m_decls.GetInitOrder()) {
+        m_body << "    " << MangleName(m_decls.Get(id)->GetRecord()) << "_init();\n";
+    }
+
+    const air::symbol::Record* rec = DeclList::FindMain(entry);
+
+    if (isNull(rec) || m_decls.GetKind(rec->Id) == DeclKind::NONE) {
+        m_body << "    return 0;\n";
+    } else if (m_decls.GetKind(rec->Id) == DeclKind::FN) {
+        Declare(rec->Id);
+        m_body << "    return (int)" << MangleName(rec) << "();\n";
+    } else {
+        Declare(rec->Id);
+        m_body << "    return (int)" << MangleName(rec) << ";\n";
+    }
+
+    m_body << "}\n";
+
+    return Finish();
+}
+
+std::string CEmitter::MangleName(const air::symbol::Record* rec) {
+    const std::string name = DeclList::MangleName(rec);
+
+    std::string mangled = "k";
+    std::size_t start   = 0;
+
+    while (start <= name.size()) {
+        std::size_t end = name.find('.', start);
+        if (end == std::string::npos) {
+            end = name.size();
+        }
+
+        mangled += std::to_string(end - start);
+        mangled.append(name, start, end - start);
+        start = end + 1;
+    }
+
+    return mangled;
+}
+
+std::string_view CEmitter::TypeName(Index type) {
+    using air::pool::SimpleType;
+    using air::pool::keys::ALL_KEYS;
+
+    // DeclList::CheckSupported rejects the decls using the types without a C name
+    assert(air::type::isPrimitive(type) && ALL_KEYS.at(type).Tag == air::pool::KeyTag::SIMPLE_TYPE);
+
+    switch (ALL_KEYS.at(type).Value.SimpleTy) {
+    case SimpleType::BOOL:
+        return "_Bool";
+    case SimpleType::U8:
+        return "uint8_t";
+    case SimpleType::I8:
+        return "int8_t";
+    case SimpleType::U16:
+        return "uint16_t";
+    case SimpleType::I16:
+        return "int16_t";
+    case SimpleType::U32:
+    case SimpleType::CHAR:
+        return "uint32_t";
+    case SimpleType::I32:
+        return "int32_t";
+    case SimpleType::U64:
+    case SimpleType::USIZE:
+        return "uint64_t";
+    case SimpleType::I64:
+    case SimpleType::ISIZE:
+    case SimpleType::COMPTIME_INT:
+        return "int64_t";
+    case SimpleType::F32:
+        return "float";
+    case SimpleType::F64:
+    case SimpleType::COMPTIME_FLOAT:
+        return "double";
+    case SimpleType::VOID:
+    case SimpleType::F16:
+    case SimpleType::STR:
+        break;
+    }
+
+    KOOLANG_UNREACHABLE();
+}
+
+void CEmitter::Reset() {
+    m_head.str("");
+    m_body.str("");
+    m_declared.clear();
+
+    m_head << "#include <math.h>\n"
+              "#include <stdint.h>\n"
+              "\n"
+              "// INT64_MIN / -1 wraps to INT64_MIN and INT64_MIN % -1 is 0 like on x86_64, C leaves them undefined\n"
+              "static inline int64_t koolang_sdiv(int64_t a, int64_t b) { return b == -1 ? (int64_t)(0 - (uint64_t)a) "
+              ": a / b; }\n"
+              "static inline int64_t koolang_smod(int64_t a, int64_t b) { return b == -1 ? 0 : a % b; }\n";
+}
+
+void CEmitter::Declare(Index recordId) {
+    if (!m_declared.insert(recordId).second) {
+        return;
+    }
+
+    const air::symbol::Record* rec = m_decls.Get(recordId)->GetRecord();
+
+    switch (m_decls.GetKind(recordId)) {
+    case DeclKind::NONE:
+    case DeclKind::UNSUPPORTED:
+        break;
+    case DeclKind::CONST:
+        m_head << "extern const " << TypeName(rec->Ty) << ' ' << MangleName(rec) << ";\n";
+        break;
+    case DeclKind::GLOBAL:
+        m_head << "extern " << TypeName(rec->Ty) << ' ' << MangleName(rec) << ";\n";
+        break;
+    case DeclKind::FN:
+        m_head << "int64_t " << MangleName(rec) << "(void);\n";
+        break;
+    }
+}
+
+void CEmitter::EmitDecl(Index recordId) {
+    const air::Sema* sema          = m_decls.Get(recordId);
+    const air::symbol::Record* rec = isNull(sema) ? nullptr : sema->GetRecord();
+
+    // every decl has external linkage, so the units can reference each other
+    switch (m_decls.GetKind(recordId)) {
+    case DeclKind::NONE:
+    case DeclKind::UNSUPPORTED:
+        break;
+    case DeclKind::CONST:
+        m_body << "const " << TypeName(rec->Ty) << ' ' << MangleName(rec) << " = ";
+        EmitConstant(rec->Val);
+        m_body << ";\n";
+        break;
+    case DeclKind::GLOBAL:
+        m_body << TypeName(rec->Ty) << ' ' << MangleName(rec) << ";\n";
+        EmitInit(*sema, MangleName(rec));
+        break;
+    case DeclKind::FN:
+        m_body << "int64_t " << MangleName(rec) << "(void) { return 0; }\n";
+        break;
+    }
+}
+
+void CEmitter::EmitInit(const air::Sema& sema, const std::string& name) {
+    const air::Air& air            = sema.GetAir();
+    const air::symbol::Record* rec = sema.GetRecord();
+    const auto types               = air::type::instTypes(air, m_pool);
+
+    // DeclList marks the decls with blocks as unsupported
+    assert(air.Blocks.IsEmpty());
+
+    m_body << "void " << name << "_init(void) {\n";
+
+    for (Index inst = 1; inst < air.Inst.size(); inst++) {
+        EmitInst(air, inst, types);
+    }
+
+    m_body << "    " << name << " = (" << TypeName(rec->Ty) << ")t" << rec->AirInst << ";\n";
+    m_body << "}\n";
+}
+
+void CEmitter::EmitInst(const air::Air& air, Index inst, std::span<const Index> types) {
+    const auto& data = air.Inst[inst];
+
+    switch (air.Type[inst]) {
+    case InstType::CONSTANT:
+        m_body << "    const " << TypeName(types[inst]) << " t" << inst << " = ";
+        EmitConstant(data.Data);
+        m_body << ";\n";
+        break;
+    case InstType::SYMBOL: {
+        const air::symbol::Record* rec = m_decls.Get(data.Sym.Decl)->GetRecord();
+
+        Declare(data.Sym.Decl);
+        m_body << "    const " << TypeName(data.Sym.Ty) << "* t" << inst << " = (const " << TypeName(data.Sym.Ty)
+               << "*)&" << MangleName(rec) << ";\n";
+        break;
+    }
+    case InstType::LOAD:
+        m_body << "    const " << TypeName(data.TyOp.Ty) << " t" << inst << " = *t" << data.TyOp.Operand << ";\n";
+        break;
+    case InstType::CAST:
+        m_body << "    const " << TypeName(data.TyOp.Ty) << " t" << inst << " = (" << TypeName(data.TyOp.Ty) << ")t"
+               << data.TyOp.Operand << ";\n";
+        break;
+    case InstType::ADD:
+        EmitBinOp(air, inst, types[inst], "+");
+        break;
+    case InstType::SUB:
+        EmitBinOp(air, inst, types[inst], "-");
+        break;
+    case InstType::MUL:
+        EmitBinOp(air, inst, types[inst], "*");
+        break;
+    case InstType::DIV:
+        EmitBinOp(air, inst, types[inst], "/");
+        break;
+    case InstType::MOD:
+        EmitBinOp(air, inst, types[inst], "%");
+        break;
+    case InstType::BIT_AND:
+        EmitBinOp(air, inst, types[inst], "&");
+        break;
+    case InstType::BIT_OR:
+        EmitBinOp(air, inst, types[inst], "|");
+        break;
+    case InstType::BIT_SHL:
+        EmitBinOp(air, inst, types[inst], "<<");
+        break;
+    case InstType::BIT_SHR:
+        EmitBinOp(air, inst, types[inst], ">>");
+        break;
+    case InstType::BIT_XOR:
+        EmitBinOp(air, inst, types[inst], "^");
+        break;
+    // block parameters exist only in the blocks
+    case InstType::PARAM:
+        assert(false);
+        break;
+    }
+}
+
+void CEmitter::EmitConstant(Index poolIndex) {
+    const auto tyVal = m_pool.GetTypeValue(poolIndex);
+
+    // DeclList::CheckSupported rejects the constants without a type
+    assert(!isNull(tyVal.Ty));
+
+    const std::uint64_t value = m_pool.Values.at(tyVal.Val);
+
+    if (air::type::isFloat(tyVal.Ty)) {
+        const double number = std::bit_cast<double>(value);
+
+        // 'nan' and 'inf' aren't C tokens
+        m_body << '(' << TypeName(tyVal.Ty) << ')';
+        if (std::isnan(number)) {
+            m_body << (std::signbit(number) ? "-NAN" : "NAN");
+        } else if (std::isinf(number)) {
+            m_body << (std::signbit(number) ? "-INFINITY" : "INFINITY");
+        } else {
+            m_body << std::hexfloat << number << std::defaultfloat;
+        }
+    } else {
+        m_body << '(' << TypeName(tyVal.Ty) << ")UINT64_C(" << value << ')';
+    }
+}
+
+void CEmitter::EmitBinOp(const air::Air& air, Index inst, Index type, std::string_view op) {
+    const auto& bin           = air.Inst[inst].BinOp;
+    const std::string_view ty = TypeName(type);
+
+    m_body << "    const " << ty << " t" << inst << " = (" << ty << ")(";
+
+    // the operands are extended to 64 bits, so the promotion to 'int' never applies
+    switch (air.Type[inst]) {
+    case InstType::DIV:
+    case InstType::MOD:
+        if (air::type::isFloat(type) && air.Type[inst] == InstType::MOD) {
+            m_body << "fmod(t" << bin.Lhs << ", t" << bin.Rhs << ')';
+        } else if (air::type::isFloat(type)) {
+            m_body << 't' << bin.Lhs << " / t" << bin.Rhs;
+        } else if (air::type::isSignedInt(type)) {
+            m_body << (air.Type[inst] == InstType::DIV ? "koolang_sdiv" : "koolang_smod") << "(t" << bin.Lhs << ", t"
+                   << bin.Rhs << ')';
+        } else {
+            m_body << "(uint64_t)t" << bin.Lhs << ' ' << op << " (uint64_t)t" << bin.Rhs;
+        }
+        break;
+    // the shift count is masked by the width of the type
+    case InstType::BIT_SHL:
+    case InstType::BIT_SHR:
+        m_body << ((air.Type[inst] == InstType::BIT_SHR && air::type::isSignedInt(type)) ? "(int64_t)t" : "(uint64_t)t")
+               << bin.Lhs << ' ' << op << " ((uint64_t)t" << bin.Rhs << " & " << (air::type::sizeOf(type) * 8 - 1)
+               << ')';
+        break;
+    // unsigned arithmetic wraps and the value is truncated by the cast
+    default:
+        if (air::type::isFloat(type)) {
+            m_body << 't' << bin.Lhs << ' ' << op << " t" << bin.Rhs;
+        } else {
+            m_body << "(uint64_t)t" << bin.Lhs << ' ' << op << " (uint64_t)t" << bin.Rhs;
+        }
+        break;
+    }
+
+    m_body << ");\n";
+}
+
+std::string CEmitter::Finish() {
+    m_head << '\n' << m_body.str();
+    return m_head.str();
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef KOOLANG_CODEGEN_C_CEMITTER_H
+#define KOOLANG_CODEGEN_C_CEMITTER_H
+
+#include "air/Pool.h"
+#include "codegen/DeclList.h"
+#include "util/Index.h"
+#include <span>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+namespace codegen::c {
+
+// Translates AIR to C11. The emitted code follows the semantics of the x86_64 backend: integer arithmetic wraps, the
+// value is truncated to the size of its type and the shift count is masked by its width.
+class CEmitter {
+public:
+    CEmitter(const DeclList& decls, const air::Pool& pool)
+        : m_decls(decls)
+        , m_pool(pool) { }
+
+    // Returns translation unit with definitions of the given decls.
+    [[nodiscard]] std::string EmitUnit(std::span<const Index> recordIds);
+
+    // Returns translation unit with the 'main' function.
+    [[nodiscard]] std::string EmitEntry(const air::Module* entry);
+
+    // Returns C identifier of the decl. Parts of the name are length prefixed, e.g. 'b.c.NAME' -> 'k1b1c4NAME'.
+    [[nodiscard]] static std::string MangleName(const air::symbol::Record* rec);
+
+    [[nodiscard]] static std::string_view TypeName(Index type);
+
+private:
+    const DeclList& m_decls;
+    const air::Pool& m_pool;
+
+    std::stringstream m_head;
+    std::stringstream m_body;
+
+    // decls which are already declared inside the unit
+    std::unordered_set<Index> m_declared;
+
+    void Reset();
+    void Declare(Index recordId);
+    void EmitDecl(Index recordId);
+    void EmitInit(const air::Sema& sema, const std::string& name);
+    void EmitInst(const air::Air& air, Index inst, std::span<const Index> types);
+    void EmitConstant(Index poolIndex);
+    void EmitBinOp(const air::Air& air, Index inst, Index type, std::string_view op);
+
+    [[nodiscard]] std::string Finish();
+};
+
+}
+
+#endif
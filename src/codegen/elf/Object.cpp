@@ -0,0 +1,344 @@
+#include "Object.h"
+#include <array>
+#include <fstream>
+
+namespace codegen::elf {
+
+namespace {
+
+    constexpr std::uint16_t ET_REL    = 1;
+    constexpr std::uint16_t EM_X86_64 = 62;
+
+    constexpr std::uint32_t SHT_PROGBITS = 1;
+    constexpr std::uint32_t SHT_SYMTAB   = 2;
+    constexpr std::uint32_t SHT_STRTAB   = 3;
+    constexpr std::uint32_t SHT_RELA     = 4;
+
+    constexpr std::uint64_t SHF_WRITE     = 0x1;
+    constexpr std::uint64_t SHF_ALLOC     = 0x2;
+    constexpr std::uint64_t SHF_EXECINSTR = 0x4;
+    constexpr std::uint64_t SHF_INFO_LINK = 0x40;
+
+    constexpr std::uint8_t STB_LOCAL  = 0;
+    constexpr std::uint8_t STB_GLOBAL = 1;
+
+    constexpr std::uint8_t STT_NOTYPE  = 0;
+    constexpr std::uint8_t STT_OBJECT  = 1;
+    constexpr std::uint8_t STT_FUNC    = 2;
+    constexpr std::uint8_t STT_SECTION = 3;
+
+    constexpr std::uint64_t EHDR_SIZE = 64;
+    constexpr std::uint64_t SHDR_SIZE = 64;
+    constexpr std::uint64_t SYM_SIZE  = 24;
+    constexpr std::uint64_t RELA_SIZE = 24;
+
+    // Section header indexes
+    enum SectionIndex : std::uint16_t {
+        SEC_NULL,
+        SEC_TEXT,
+        SEC_DATA,
+        SEC_RODATA,
+        SEC_RELA_TEXT,
+        SEC_SYMTAB,
+        SEC_STRTAB,
+        SEC_SHSTRTAB,
+        SEC_NOTE_STACK,
+        SEC_COUNT,
+    };
+
+    constexpr std::array<std::string_view, SEC_COUNT> SECTION_NAMES {
+        "", ".text", ".data", ".rodata", ".rela.text", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack",
+    };
+
+    // Number of the section symbols (.text, .data, .rodata)
+    constexpr Index SECTION_SYMBOLS = 3;
+
+    class Buffer {
+    public:
+        template <typename T> void Write(T value) {
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                Bytes.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (i * 8)));
+            }
+        }
+
+        void Write(const std::vector<std::uint8_t>& bytes) { Bytes.insert(Bytes.end(), bytes.begin(), bytes.end()); }
+
+        void Align(std::uint64_t alignment) {
+            while (Bytes.size() % alignment != 0) {
+                Bytes.push_back(0);
+            }
+        }
+
+        [[nodiscard]] std::uint64_t Size() const { return Bytes.size(); }
+
+        std::vector<std::uint8_t> Bytes;
+    };
+
+    // Appends zero terminated string and returns its offset
+    std::uint32_t addString(std::vector<std::uint8_t>& table, std::string_view str) {
+        const auto offset = static_cast<std::uint32_t>(table.size());
+        table.insert(table.end(), str.begin(), str.end());
+        table.push_back(0);
+        return offset;
+    }
+
+    std::uint16_t sectionToIndex(SectionKind section) {
+        switch (section) {
+        case SectionKind::UNDEF:
+            return SEC_NULL;
+        case SectionKind::TEXT:
+            return SEC_TEXT;
+        case SectionKind::DATA:
+            return SEC_DATA;
+        case SectionKind::RODATA:
+            return SEC_RODATA;
+        }
+
+        return SEC_NULL;
+    }
+
+    struct SectionHeader {
+        std::uint32_t Name      = 0;
+        std::uint32_t Type      = 0;
+        std::uint64_t Flags     = 0;
+        std::uint64_t Offset    = 0;
+        std::uint64_t Size      = 0;
+        std::uint32_t Link      = 0;
+        std::uint32_t Info      = 0;
+        std::uint64_t Alignment = 0;
+        std::uint64_t EntrySize = 0;
+    };
+
+}
+
+Object::Object() {
+    // null symbol
+    m_symbols.emplace_back();
+}
+
+Index Object::GetOrAddSymbol(std::string_view name) {
+    const auto iter = m_symbolLookup.find(name);
+    if (iter != m_symbolLookup.end()) {
+        return iter->second;
+    }
+
+    const auto index = static_cast<Index>(m_symbols.size());
+
+    m_symbols.push_back({ .Name = std::string(name) });
+    m_symbolLookup.emplace(name, index);
+
+    return index;
+}
+
+void Object::DefineSymbol(Index sym, SectionKind section, bool isGlobal, bool isFunc) {
+    Symbol& symbol = m_symbols.at(sym);
+
+    symbol.Section  = section;
+    symbol.Offset   = GetSection(section).size();
+    symbol.IsGlobal = isGlobal;
+    symbol.IsFunc   = isFunc;
+}
+
+void Object::EndSymbol(Index sym, std::uint64_t endOffset) {
+    Symbol& symbol = m_symbols.at(sym);
+    symbol.Size    = endOffset - symbol.Offset;
+}
+
+std::vector<std::uint8_t>& Object::GetSection(SectionKind section) {
+    switch (section) {
+    case SectionKind::DATA:
+        return m_data;
+    case SectionKind::RODATA:
+        return m_rodata;
+    case SectionKind::TEXT:
+    case SectionKind::UNDEF:
+        break;
+    }
+
+    return m_text;
+}
+
+void Object::Align(SectionKind section, std::uint64_t alignment) {
+    auto& bytes = GetSection(section);
+    bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+bool Object::Write(const std::filesystem::path& path) const {
+    // Locals must precede globals inside the symbol table. Undefined symbols are always global.
+    std::vector<Index> order;
+    std::vector<Index> symMap(m_symbols.size(), NULL_INDEX);
+    order.reserve(m_symbols.size());
+
+    for (Index i = 1; i < m_symbols.size(); i++) {
+        const Symbol& sym = m_symbols[i];
+        if (!sym.IsGlobal && sym.Section != SectionKind::UNDEF) {
+            order.push_back(i);
+        }
+    }
+
+    const auto firstGlobal = static_cast<std::uint32_t>(order.size() + 1 + SECTION_SYMBOLS);
+
+    for (Index i = 1; i < m_symbols.size(); i++) {
+        const Symbol& sym = m_symbols[i];
+        if (sym.IsGlobal || sym.Section == SectionKind::UNDEF) {
+            order.push_back(i);
+        }
+    }
+
+    // .symtab + .strtab
+    Buffer symtab;
+    std::vector<std::uint8_t> strtab { 0 };
+
+    auto writeSym = [&](std::uint32_t name, std::uint8_t info, std::uint16_t shndx, std::uint64_t value,
+                        std::uint64_t size) {
+        symtab.Write(name);
+        symtab.Write(info);
+        symtab.Write(std::uint8_t { 0 });
+        symtab.Write(shndx);
+        symtab.Write(value);
+        symtab.Write(size);
+    };
+
+    writeSym(0, 0, SEC_NULL, 0, 0);
+    writeSym(0, STT_SECTION, SEC_TEXT, 0, 0);
+    writeSym(0, STT_SECTION, SEC_DATA, 0, 0);
+    writeSym(0, STT_SECTION, SEC_RODATA, 0, 0);
+
+    for (Index i = 0; i < order.size(); i++) {
+        const Symbol& sym = m_symbols[order[i]];
+        symMap[order[i]]  = i + 1 + SECTION_SYMBOLS;
+
+        const bool isGlobal = sym.IsGlobal || sym.Section == SectionKind::UNDEF;
+
+        std::uint8_t type = STT_NOTYPE;
+        if (sym.Section != SectionKind::UNDEF) {
+            type = sym.IsFunc ? STT_FUNC : STT_OBJECT;
+        }
+
+        const auto bind = isGlobal ? STB_GLOBAL : STB_LOCAL;
+
+        writeSym(
+            addString(strtab, sym.Name), static_cast<std::uint8_t>((bind << 4) | type), sectionToIndex(sym.Section),
+            sym.Offset, sym.Size
+        );
+    }
+
+    // .rela.text
+    Buffer rela;
+    for (const Reloc& reloc : m_relocs) {
+        const std::uint64_t info = (static_cast<std::uint64_t>(symMap.at(reloc.Sym)) << 32)
+                                 | static_cast<std::uint64_t>(reloc.Type);
+        rela.Write(reloc.Offset);
+        rela.Write(info);
+        rela.Write(reloc.Addend);
+    }
+
+    // .shstrtab
+    std::vector<std::uint8_t> shstrtab;
+    std::array<std::uint32_t, SEC_COUNT> names {};
+    for (std::size_t i = 0; i < SEC_COUNT; i++) {
+        names[i] = addString(shstrtab, SECTION_NAMES[i]);
+    }
+
+    std::array<SectionHeader, SEC_COUNT> headers {};
+
+    Buffer out;
+    out.Bytes.reserve(EHDR_SIZE + m_text.size() + m_data.size() + m_rodata.size() + symtab.Size() + rela.Size());
+    out.Bytes.resize(EHDR_SIZE, 0);
+
+    auto addSection = [&](SectionIndex index, const std::vector<std::uint8_t>& bytes, std::uint64_t alignment) {
+        out.Align(alignment);
+        headers[index].Offset    = out.Size();
+        headers[index].Size      = bytes.size();
+        headers[index].Alignment = alignment;
+        out.Write(bytes);
+    };
+
+    addSection(SEC_TEXT, m_text, 16);
+    headers[SEC_TEXT].Type  = SHT_PROGBITS;
+    headers[SEC_TEXT].Flags = SHF_ALLOC | SHF_EXECINSTR;
+
+    addSection(SEC_DATA, m_data, 8);
+    headers[SEC_DATA].Type  = SHT_PROGBITS;
+    headers[SEC_DATA].Flags = SHF_ALLOC | SHF_WRITE;
+
+    addSection(SEC_RODATA, m_rodata, 8);
+    headers[SEC_RODATA].Type  = SHT_PROGBITS;
+    headers[SEC_RODATA].Flags = SHF_ALLOC;
+
+    addSection(SEC_RELA_TEXT, rela.Bytes, 8);
+    headers[SEC_RELA_TEXT].Type      = SHT_RELA;
+    headers[SEC_RELA_TEXT].Flags     = SHF_INFO_LINK;
+    headers[SEC_RELA_TEXT].Link      = SEC_SYMTAB;
+    headers[SEC_RELA_TEXT].Info      = SEC_TEXT;
+    headers[SEC_RELA_TEXT].EntrySize = RELA_SIZE;
+
+    addSection(SEC_SYMTAB, symtab.Bytes, 8);
+    headers[SEC_SYMTAB].Type      = SHT_SYMTAB;
+    headers[SEC_SYMTAB].Link      = SEC_STRTAB;
+    headers[SEC_SYMTAB].Info      = firstGlobal;
+    headers[SEC_SYMTAB].EntrySize = SYM_SIZE;
+
+    addSection(SEC_STRTAB, strtab, 1);
+    headers[SEC_STRTAB].Type = SHT_STRTAB;
+
+    addSection(SEC_SHSTRTAB, shstrtab, 1);
+    headers[SEC_SHSTRTAB].Type = SHT_STRTAB;
+
+    // non-executable stack
+    addSection(SEC_NOTE_STACK, {}, 1);
+    headers[SEC_NOTE_STACK].Type = SHT_PROGBITS;
+
+    out.Align(8);
+    const std::uint64_t sectionHeadersOffset = out.Size();
+
+    for (std::size_t i = 0; i < SEC_COUNT; i++) {
+        const SectionHeader& header = headers[i];
+
+        out.Write(i == SEC_NULL ? 0 : names[i]);
+        out.Write(header.Type);
+        out.Write(header.Flags);
+        // address
+        out.Write(std::uint64_t { 0 });
+        out.Write(header.Offset);
+        out.Write(header.Size);
+        out.Write(header.Link);
+        out.Write(header.Info);
+        out.Write(header.Alignment);
+        out.Write(header.EntrySize);
+    }
+
+    // ELF header
+    Buffer ehdr;
+    ehdr.Bytes = { 0x7F, 'E', 'L', 'F', /* 64-bit */ 2, /* little endian */ 1, /* version */ 1, /* SysV */ 0 };
+    ehdr.Bytes.resize(16, 0);
+    ehdr.Write(ET_REL);
+    ehdr.Write(EM_X86_64);
+    ehdr.Write(std::uint32_t { 1 });
+    // entry, program headers
+    ehdr.Write(std::uint64_t { 0 });
+    ehdr.Write(std::uint64_t { 0 });
+    ehdr.Write(sectionHeadersOffset);
+    // flags
+    ehdr.Write(std::uint32_t { 0 });
+    ehdr.Write(static_cast<std::uint16_t>(EHDR_SIZE));
+    // program header size and count
+    ehdr.Write(std::uint16_t { 0 });
+    ehdr.Write(std::uint16_t { 0 });
+    ehdr.Write(static_cast<std::uint16_t>(SHDR_SIZE));
+    ehdr.Write(static_cast<std::uint16_t>(SEC_COUNT));
+    ehdr.Write(static_cast<std::uint16_t>(SEC_SHSTRTAB));
+
+    std::copy(ehdr.Bytes.begin(), ehdr.Bytes.end(), out.Bytes.begin());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(out.Bytes.data()), static_cast<std::streamsize>(out.Bytes.size()));
+
+    return file.good();
+}
+
+}
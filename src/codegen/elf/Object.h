@@ -0,0 +1,83 @@
+#ifndef KOOLANG_CODEGEN_ELF_OBJECT_H
+#define KOOLANG_CODEGEN_ELF_OBJECT_H
+
+#include "util/Index.h"
+#include "util/string_hash.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace codegen::elf {
+
+enum class SectionKind : std::uint8_t {
+    UNDEF,
+    TEXT,
+    DATA,
+    RODATA,
+};
+
+// Only the relocations required by the x86_64 backend.
+enum class RelocType : std::uint32_t {
+    PC32  = 2,
+    PLT32 = 4,
+};
+
+struct Symbol {
+    std::string Name;
+    SectionKind Section  = SectionKind::UNDEF;
+    std::uint64_t Offset = 0;
+    std::uint64_t Size   = 0;
+    bool IsFunc          = false;
+    bool IsGlobal        = false;
+};
+
+struct Reloc {
+    std::uint64_t Offset;
+    Index Sym;
+    RelocType Type;
+    std::int64_t Addend;
+};
+
+// Relocatable x86_64 ELF object. All relocations are applied to the '.text' section.
+class Object {
+public:
+    Object();
+
+    // Returns the symbol with the given name. The symbol is created as undefined if it doesn't exist.
+    Index GetOrAddSymbol(std::string_view name);
+
+    // Defines the symbol at the current end of the section.
+    void DefineSymbol(Index sym, SectionKind section, bool isGlobal, bool isFunc);
+
+    // Sets the size of the symbol. Offset is the end of the symbol inside its section.
+    void EndSymbol(Index sym, std::uint64_t endOffset);
+
+    void AddReloc(std::uint64_t offset, Index sym, RelocType type, std::int64_t addend) {
+        m_relocs.push_back({ offset, sym, type, addend });
+    }
+
+    [[nodiscard]] std::vector<std::uint8_t>& GetSection(SectionKind section);
+    [[nodiscard]] const Symbol& GetSymbol(Index sym) const { return m_symbols.at(sym); }
+
+    // Pads the section with zeros.
+    void Align(SectionKind section, std::uint64_t alignment);
+
+    // Returns false if the file cannot be written.
+    [[nodiscard]] bool Write(const std::filesystem::path& path) const;
+
+private:
+    std::vector<std::uint8_t> m_text;
+    std::vector<std::uint8_t> m_data;
+    std::vector<std::uint8_t> m_rodata;
+
+    std::vector<Symbol> m_symbols;
+    std::vector<Reloc> m_relocs;
+    std::unordered_map<std::string, Index, string_hash, std::equal_to<>> m_symbolLookup;
+};
+
+}
+
+#endif
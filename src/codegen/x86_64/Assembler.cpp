@@ -0,0 +1,298 @@
+#include "Assembler.h"
+
+namespace codegen::x86_64 {
+
+void Assembler::Imm32(std::uint32_t imm) {
+    for (int i = 0; i < 4; i++) {
+        Byte(static_cast<std::uint8_t>(imm >> (i * 8)));
+    }
+}
+
+void Assembler::Imm64(std::uint64_t imm) {
+    for (int i = 0; i < 8; i++) {
+        Byte(static_cast<std::uint8_t>(imm >> (i * 8)));
+    }
+}
+
+void Assembler::Rex(bool w, Reg reg, Reg rm, bool force) {
+    const auto rex = static_cast<std::uint8_t>(
+        0x40 | (w ? 0x8 : 0) | (isExtended(reg) ? 0x4 : 0) | (isExtended(rm) ? 0x1 : 0)
+    );
+
+    if (rex != 0x40 || force) {
+        Byte(rex);
+    }
+}
+
+void Assembler::FrameOperand(Reg reg, std::int32_t disp) {
+    ModRM(0b10, regCode(reg), regCode(Reg::RBP));
+    Imm32(static_cast<std::uint32_t>(disp));
+}
+
+void Assembler::SymbolOperand(Reg reg, Index sym) {
+    ModRM(0b00, regCode(reg), 0b101);
+    m_obj.AddReloc(Offset(), sym, elf::RelocType::PC32, -4);
+    Imm32(0);
+}
+
+void Assembler::MemOperand(Reg reg, Reg base) {
+    const std::uint8_t baseCode = regCode(base) & 7;
+
+    // rbp and r13 can be encoded only with displacement
+    if (baseCode == 0b101) {
+        ModRM(0b01, regCode(reg), baseCode);
+        Byte(0);
+        return;
+    }
+
+    ModRM(0b00, regCode(reg), baseCode);
+
+    // rsp and r12 require SIB byte
+    if (baseCode == 0b100) {
+        Byte(0x24);
+    }
+}
+
+void Assembler::MovImm(Reg dst, std::uint64_t imm) {
+    // xor r32, r32
+    if (imm == 0) {
+        Rex(false, dst, dst);
+        Byte(0x31);
+        ModRM(0b11, regCode(dst), regCode(dst));
+    }
+    // mov r32, imm32 (zero extended)
+    else if (imm <= 0xFFFFFFFF) {
+        Rex(false, Reg::RAX, dst);
+        Byte(static_cast<std::uint8_t>(0xB8 + (regCode(dst) & 7)));
+        Imm32(static_cast<std::uint32_t>(imm));
+    }
+    // mov r64, imm32 (sign extended)
+    else if (static_cast<std::int64_t>(imm) >= INT32_MIN && static_cast<std::int64_t>(imm) < 0) {
+        Rex(true, Reg::RAX, dst);
+        Byte(0xC7);
+        ModRM(0b11, 0, regCode(dst));
+        Imm32(static_cast<std::uint32_t>(imm));
+    }
+    // mov r64, imm64
+    else {
+        Rex(true, Reg::RAX, dst);
+        Byte(static_cast<std::uint8_t>(0xB8 + (regCode(dst) & 7)));
+        Imm64(imm);
+    }
+}
+
+void Assembler::Mov(Reg dst, Reg src) {
+    if (dst == src) {
+        return;
+    }
+
+    Rex(true, src, dst);
+    Byte(0x89);
+    ModRM(0b11, regCode(src), regCode(dst));
+}
+
+void Assembler::LoadFrame(Reg dst, std::int32_t disp) {
+    Rex(true, dst, Reg::RBP);
+    Byte(0x8B);
+    FrameOperand(dst, disp);
+}
+
+void Assembler::StoreFrame(std::int32_t disp, Reg src) {
+    Rex(true, src, Reg::RBP);
+    Byte(0x89);
+    FrameOperand(src, disp);
+}
+
+void Assembler::LeaSymbol(Reg dst, Index sym) {
+    Rex(true, dst, Reg::RAX);
+    Byte(0x8D);
+    SymbolOperand(dst, sym);
+}
+
+void Assembler::Load(Reg dst, Reg base, std::uint32_t size, bool isSigned) {
+    switch (size) {
+    case 1:
+        // movzx/movsx r64, byte [base]
+        Rex(true, dst, base);
+        Byte(0x0F);
+        Byte(isSigned ? 0xBE : 0xB6);
+        break;
+    case 2:
+        // movzx/movsx r64, word [base]
+        Rex(true, dst, base);
+        Byte(0x0F);
+        Byte(isSigned ? 0xBF : 0xB7);
+        break;
+    case 4:
+        // movsxd r64, dword [base] or mov r32, dword [base]
+        Rex(isSigned, dst, base);
+        Byte(isSigned ? 0x63 : 0x8B);
+        break;
+    default:
+        Rex(true, dst, base);
+        Byte(0x8B);
+        break;
+    }
+
+    MemOperand(dst, base);
+}
+
+void Assembler::StoreSymbol(Index sym, Reg src, std::uint32_t size) {
+    switch (size) {
+    case 1:
+        // REX is required for sil, dil, ...
+        Rex(false, src, Reg::RAX, true);
+        Byte(0x88);
+        break;
+    case 2:
+        Byte(0x66);
+        Rex(false, src, Reg::RAX);
+        Byte(0x89);
+        break;
+    case 4:
+        Rex(false, src, Reg::RAX);
+        Byte(0x89);
+        break;
+    default:
+        Rex(true, src, Reg::RAX);
+        Byte(0x89);
+        break;
+    }
+
+    SymbolOperand(src, sym);
+}
+
+void Assembler::Extend(Reg reg, std::uint32_t size, bool isSigned) {
+    switch (size) {
+    case 1:
+        Rex(true, reg, reg);
+        Byte(0x0F);
+        Byte(isSigned ? 0xBE : 0xB6);
+        break;
+    case 2:
+        Rex(true, reg, reg);
+        Byte(0x0F);
+        Byte(isSigned ? 0xBF : 0xB7);
+        break;
+    case 4:
+        if (isSigned) {
+            // movsxd r64, r32
+            Rex(true, reg, reg);
+            Byte(0x63);
+        } else {
+            // mov r32, r32 clears the upper bits
+            Rex(false, reg, reg);
+            Byte(0x89);
+        }
+        break;
+    default:
+        return;
+    }
+
+    ModRM(0b11, regCode(reg), regCode(reg));
+}
+
+void Assembler::Alu(AluOp op, Reg dst, Reg src) {
+    Rex(true, src, dst);
+    Byte(static_cast<std::uint8_t>(op));
+    ModRM(0b11, regCode(src), regCode(dst));
+}
+
+void Assembler::AndImm(Reg dst, std::int8_t imm) {
+    Rex(true, Reg::RAX, dst);
+    Byte(0x83);
+    ModRM(0b11, 4, regCode(dst));
+    Byte(static_cast<std::uint8_t>(imm));
+}
+
+void Assembler::IMul(Reg dst, Reg src) {
+    Rex(true, dst, src);
+    Byte(0x0F);
+    Byte(0xAF);
+    ModRM(0b11, regCode(dst), regCode(src));
+}
+
+void Assembler::Div(Reg src, bool isSigned) {
+    if (!isSigned) {
+        // xor edx, edx
+        Byte(0x31);
+        Byte(0xD2);
+
+        Rex(true, Reg::RAX, src);
+        Byte(0xF7);
+        ModRM(0b11, 6, regCode(src));
+        return;
+    }
+
+    // 'idiv' traps on MIN / -1, the division by -1 is 'neg' like in the C backend: cmp src, -1; jne div
+    Rex(true, Reg::RAX, src);
+    Byte(0x83);
+    ModRM(0b11, 7, regCode(src));
+    Byte(0xFF);
+    Byte(0x75);
+    Byte(0);
+    const std::uint64_t toDiv = Offset();
+
+    // neg rax; xor edx, edx; jmp end
+    Rex(true, Reg::RAX, Reg::RAX);
+    Byte(0xF7);
+    ModRM(0b11, 3, regCode(Reg::RAX));
+    Byte(0x31);
+    Byte(0xD2);
+    Byte(0xEB);
+    Byte(0);
+    const std::uint64_t toEnd = Offset();
+
+    // div: cqo; idiv src
+    m_code[toDiv - 1] = static_cast<std::uint8_t>(Offset() - toDiv);
+    Byte(0x48);
+    Byte(0x99);
+    Rex(true, Reg::RAX, src);
+    Byte(0xF7);
+    ModRM(0b11, 7, regCode(src));
+
+    m_code[toEnd - 1] = static_cast<std::uint8_t>(Offset() - toEnd);
+}
+
+void Assembler::Shift(ShiftOp op, Reg dst) {
+    Rex(true, Reg::RAX, dst);
+    Byte(0xD3);
+    ModRM(0b11, static_cast<std::uint8_t>(op), regCode(dst));
+}
+
+void Assembler::Push(Reg reg) {
+    Rex(false, Reg::RAX, reg);
+    Byte(static_cast<std::uint8_t>(0x50 + (regCode(reg) & 7)));
+}
+
+void Assembler::Pop(Reg reg) {
+    Rex(false, Reg::RAX, reg);
+    Byte(static_cast<std::uint8_t>(0x58 + (regCode(reg) & 7)));
+}
+
+void Assembler::SubRsp(std::int32_t imm) {
+    if (imm == 0) {
+        return;
+    }
+
+    Rex(true, Reg::RAX, Reg::RSP);
+    Byte(0x81);
+    ModRM(0b11, 5, regCode(Reg::RSP));
+    Imm32(static_cast<std::uint32_t>(imm));
+}
+
+void Assembler::LeaRspFrame(std::int32_t disp) {
+    Rex(true, Reg::RSP, Reg::RBP);
+    Byte(0x8D);
+    FrameOperand(Reg::RSP, disp);
+}
+
+void Assembler::Call(Index sym) {
+    Byte(0xE8);
+    m_obj.AddReloc(Offset(), sym, elf::RelocType::PLT32, -4);
+    Imm32(0);
+}
+
+void Assembler::Ret() { Byte(0xC3); }
+
+}
@@ -0,0 +1,116 @@
+#ifndef KOOLANG_CODEGEN_X86_64_ASSEMBLER_H
+#define KOOLANG_CODEGEN_X86_64_ASSEMBLER_H
+
+#include "codegen/elf/Object.h"
+#include "util/Index.h"
+#include <cstdint>
+#include <vector>
+
+namespace codegen::x86_64 {
+
+enum class Reg : std::uint8_t {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+};
+
+enum class AluOp : std::uint8_t {
+    ADD = 0x01,
+    OR  = 0x09,
+    AND = 0x21,
+    SUB = 0x29,
+    XOR = 0x31,
+};
+
+enum class ShiftOp : std::uint8_t {
+    SHL = 4,
+    SHR = 5,
+    SAR = 7,
+};
+
+// Encodes x86_64 instructions directly into the '.text' section of the object. All register operands are 64-bit
+// unless the method name says otherwise.
+class Assembler {
+public:
+    Assembler(elf::Object& obj)
+        : m_obj(obj)
+        , m_code(obj.GetSection(elf::SectionKind::TEXT)) { }
+
+    [[nodiscard]] std::uint64_t Offset() const { return m_code.size(); }
+
+    void MovImm(Reg dst, std::uint64_t imm);
+    void Mov(Reg dst, Reg src);
+
+    // dst = [rbp + disp]
+    void LoadFrame(Reg dst, std::int32_t disp);
+    // [rbp + disp] = src
+    void StoreFrame(std::int32_t disp, Reg src);
+
+    // dst = &sym
+    void LeaSymbol(Reg dst, Index sym);
+    // dst = [base], the value is sign or zero extended to 64 bits
+    void Load(Reg dst, Reg base, std::uint32_t size, bool isSigned);
+    // [sym] = src
+    void StoreSymbol(Index sym, Reg src, std::uint32_t size);
+
+    // Sign or zero extends the low bits of the register
+    void Extend(Reg reg, std::uint32_t size, bool isSigned);
+
+    void Alu(AluOp op, Reg dst, Reg src);
+    // dst &= imm, the immediate is sign extended
+    void AndImm(Reg dst, std::int8_t imm);
+    void IMul(Reg dst, Reg src);
+    // rdx:rax / src, the signed division by -1 wraps: rax = -rax, rdx = 0
+    void Div(Reg src, bool isSigned);
+    // dst <<= cl, dst >>= cl
+    void Shift(ShiftOp op, Reg dst);
+
+    void Push(Reg reg);
+    void Pop(Reg reg);
+    void SubRsp(std::int32_t imm);
+    // rsp = rbp + disp
+    void LeaRspFrame(std::int32_t disp);
+
+    void Call(Index sym);
+    void Ret();
+
+private:
+    elf::Object& m_obj;
+    std::vector<std::uint8_t>& m_code;
+
+    void Byte(std::uint8_t byte) { m_code.push_back(byte); }
+    void Imm32(std::uint32_t imm);
+    void Imm64(std::uint64_t imm);
+
+    // REX prefix, W - 64-bit operand, R - extension of ModRM.reg, B - extension of ModRM.rm
+    void Rex(bool w, Reg reg, Reg rm, bool force = false);
+    void ModRM(std::uint8_t mod, std::uint8_t reg, std::uint8_t rm) {
+        Byte(static_cast<std::uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+    }
+    // [rbp + disp32]
+    void FrameOperand(Reg reg, std::int32_t disp);
+    // [rip + sym]
+    void SymbolOperand(Reg reg, Index sym);
+    // [base]
+    void MemOperand(Reg reg, Reg base);
+};
+
+constexpr std::uint8_t regCode(Reg reg) { return static_cast<std::uint8_t>(reg); }
+constexpr bool isExtended(Reg reg) { return regCode(reg) >= 8; }
+
+}
+
+#endif
@@ -0,0 +1,252 @@
+#include "Lower.h"
+#include "air/type.h"
+
+namespace codegen::x86_64 {
+
+using air::InstType;
+
+namespace {
+
+    constexpr std::int32_t SLOT_SIZE = 8;
+
+    bool isSigned(Index type) { return air::type::isSignedInt(type) || air::type::isComptimeInt(type); }
+
+}
+
+Lower::Lower(Assembler& assembler, const air::Air& air, const air::Pool& pool, const std::vector<Index>& declSymbols)
+    : m_as(assembler)
+    , m_air(air)
+    , m_pool(pool)
+    , m_declSymbols(declSymbols)
+    , m_regAlloc(air) { }
+
+void Lower::EmitFunction(Index resultInst, Index storeSym) {
+    // the liveness of the register allocator is linear, it handles a single block only
+    assert(m_air.Blocks.IsEmpty());
+
+    m_types = air::type::instTypes(m_air, m_pool);
+    m_regAlloc.Run(resultInst);
+
+    const auto& saved = m_regAlloc.GetUsedCalleeSaved();
+    m_savedCount      = static_cast<std::uint32_t>(saved.size());
+
+    // prologue, the stack is aligned to 16 bytes after 'push rbp'
+    m_as.Push(Reg::RBP);
+    m_as.Mov(Reg::RBP, Reg::RSP);
+
+    for (const Reg reg : saved) {
+        m_as.Push(reg);
+    }
+
+    const std::uint32_t slots = m_regAlloc.GetSlotsCount();
+    const std::uint32_t pad   = (m_savedCount + slots) % 2;
+    m_as.SubRsp(static_cast<std::int32_t>((slots + pad) * SLOT_SIZE));
+
+    const auto count = static_cast<Index>(m_air.Inst.size());
+    for (Index inst = 1; inst < count; inst++) {
+        EmitInst(inst);
+    }
+
+    if (isNull(resultInst)) {
+        m_as.MovImm(Reg::RAX, 0);
+    } else {
+        m_as.Mov(Reg::RAX, Use(resultInst, Reg::RAX));
+    }
+
+    if (!isNull(storeSym)) {
+        m_as.StoreSymbol(storeSym, Reg::RAX, air::type::sizeOf(m_types.at(resultInst)));
+    }
+
+    // epilogue
+    if (m_savedCount + slots != 0) {
+        m_as.LeaRspFrame(-static_cast<std::int32_t>(m_savedCount) * SLOT_SIZE);
+    }
+
+    for (auto iter = saved.rbegin(); iter != saved.rend(); ++iter) {
+        m_as.Pop(*iter);
+    }
+
+    m_as.Pop(Reg::RBP);
+    m_as.Ret();
+}
+
+void Lower::EmitInst(Index inst) {
+    const Location& dst = m_regAlloc.Get(inst);
+
+    // AIR instructions don't have side effects yet
+    if (dst.Kind == LocationKind::NONE) {
+        return;
+    }
+
+    const auto& data = m_air.Inst[inst];
+
+    switch (m_air.Type[inst]) {
+    case InstType::CONSTANT: {
+        const Reg reg = Target(dst, Reg::RAX);
+        EmitConstant(inst, reg);
+        Define(dst, reg);
+        break;
+    }
+    case InstType::SYMBOL: {
+        const Reg reg = Target(dst, Reg::RAX);
+        m_as.LeaSymbol(reg, m_declSymbols.at(data.Sym.Decl));
+        Define(dst, reg);
+        break;
+    }
+    case InstType::LOAD: {
+        const Reg base = Use(data.TyOp.Operand, Reg::RCX);
+        const Reg reg  = Target(dst, Reg::RAX);
+        m_as.Load(reg, base, air::type::sizeOf(data.TyOp.Ty), isSigned(data.TyOp.Ty));
+        Define(dst, reg);
+        break;
+    }
+    case InstType::CAST: {
+        const Reg src = Use(data.TyOp.Operand, Reg::RAX);
+        const Reg reg = Target(dst, Reg::RAX);
+        m_as.Mov(reg, src);
+        Normalize(reg, data.TyOp.Ty);
+        Define(dst, reg);
+        break;
+    }
+    case InstType::ADD:
+    case InstType::SUB:
+    case InstType::MUL:
+    case InstType::BIT_AND:
+    case InstType::BIT_OR:
+    case InstType::BIT_XOR:
+        EmitBinOp(inst, dst);
+        break;
+    case InstType::DIV:
+        EmitDivMod(inst, false);
+        break;
+    case InstType::MOD:
+        EmitDivMod(inst, true);
+        break;
+    case InstType::BIT_SHL:
+        EmitShift(inst, ShiftOp::SHL);
+        break;
+    case InstType::BIT_SHR:
+        EmitShift(inst, isSigned(m_types[inst]) ? ShiftOp::SAR : ShiftOp::SHR);
+        break;
+    // block parameters exist only in the blocks
+    case InstType::PARAM:
+        assert(false);
+        break;
+    }
+}
+
+void Lower::EmitConstant(Index inst, Reg dst) {
+    const auto tyVal = m_pool.GetTypeValue(m_air.Inst[inst].Data);
+
+    // DeclList::CheckSupported rejects the floats and the constants without a type before the lowering
+    assert(!isNull(tyVal.Ty) && !air::type::isFloat(tyVal.Ty));
+
+    m_as.MovImm(dst, m_pool.Values.at(tyVal.Val));
+}
+
+void Lower::EmitBinOp(Index inst, const Location& dst) {
+    const auto& bin = m_air.Inst[inst].BinOp;
+
+    const Reg rhs  = Use(bin.Rhs, Reg::RCX);
+    const Reg work = (dst.Kind == LocationKind::REG && dst.Register != rhs) ? dst.Register : Reg::RAX;
+
+    m_as.Mov(work, Use(bin.Lhs, Reg::RAX));
+
+    switch (m_air.Type[inst]) {
+    case InstType::ADD:
+        m_as.Alu(AluOp::ADD, work, rhs);
+        break;
+    case InstType::SUB:
+        m_as.Alu(AluOp::SUB, work, rhs);
+        break;
+    case InstType::MUL:
+        m_as.IMul(work, rhs);
+        break;
+    case InstType::BIT_AND:
+        m_as.Alu(AluOp::AND, work, rhs);
+        break;
+    case InstType::BIT_OR:
+        m_as.Alu(AluOp::OR, work, rhs);
+        break;
+    case InstType::BIT_XOR:
+        m_as.Alu(AluOp::XOR, work, rhs);
+        break;
+    default:
+        KOOLANG_UNREACHABLE();
+    }
+
+    Normalize(work, m_types[inst]);
+    Define(dst, work);
+}
+
+void Lower::EmitDivMod(Index inst, bool isMod) {
+    const auto& bin = m_air.Inst[inst].BinOp;
+
+    // the divisor is never in RAX or RDX
+    const Reg rhs = Use(bin.Rhs, Reg::RCX);
+    m_as.Mov(Reg::RAX, Use(bin.Lhs, Reg::RAX));
+    m_as.Div(rhs, isSigned(m_types[inst]));
+
+    const Reg result = isMod ? Reg::RDX : Reg::RAX;
+
+    Normalize(result, m_types[inst]);
+    Define(m_regAlloc.Get(inst), result);
+}
+
+void Lower::EmitShift(Index inst, ShiftOp op) {
+    const auto& bin     = m_air.Inst[inst].BinOp;
+    const Location& dst = m_regAlloc.Get(inst);
+
+    // count must be in CL, it's masked by the width of the type like in the C backend
+    const std::uint32_t size = air::type::sizeOf(m_types[inst]);
+    m_as.Mov(Reg::RCX, Use(bin.Rhs, Reg::RCX));
+    if (size != 0 && size < 8) {
+        m_as.AndImm(Reg::RCX, static_cast<std::int8_t>(size * 8 - 1));
+    }
+
+    const Reg work = Target(dst, Reg::RAX);
+    m_as.Mov(work, Use(bin.Lhs, Reg::RAX));
+    m_as.Shift(op, work);
+
+    Normalize(work, m_types[inst]);
+    Define(dst, work);
+}
+
+Reg Lower::Use(Index inst, Reg scratch) {
+    const Location& loc = m_regAlloc.Get(inst);
+
+    if (loc.Kind == LocationKind::REG) {
+        return loc.Register;
+    }
+
+    assert(loc.Kind == LocationKind::STACK);
+
+    m_as.LoadFrame(scratch, SlotOffset(loc.Slot));
+    return scratch;
+}
+
+Reg Lower::Target(const Location& dst, Reg scratch) {
+    return (dst.Kind == LocationKind::REG) ? dst.Register : scratch;
+}
+
+void Lower::Define(const Location& dst, Reg computed) {
+    if (dst.Kind == LocationKind::REG) {
+        m_as.Mov(dst.Register, computed);
+    } else {
+        m_as.StoreFrame(SlotOffset(dst.Slot), computed);
+    }
+}
+
+void Lower::Normalize(Reg reg, Index type) {
+    const std::uint32_t size = air::type::sizeOf(type);
+
+    if (size != 0 && size < 8) {
+        m_as.Extend(reg, size, air::type::isSignedInt(type));
+    }
+}
+
+std::int32_t Lower::SlotOffset(std::uint32_t slot) const {
+    return -static_cast<std::int32_t>(m_savedCount + slot + 1) * SLOT_SIZE;
+}
+
+}
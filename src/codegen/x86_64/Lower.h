@@ -0,0 +1,55 @@
+#ifndef KOOLANG_CODEGEN_X86_64_LOWER_H
+#define KOOLANG_CODEGEN_X86_64_LOWER_H
+
+#include "Assembler.h"
+#include "RegAlloc.h"
+#include "air/Inst.h"
+#include "air/Pool.h"
+#include "util/Index.h"
+#include <vector>
+
+namespace codegen::x86_64 {
+
+// Lowers AIR of a single decl to a function in one pass. The function returns the value of the result instruction in
+// RAX, or stores it to the given symbol.
+class Lower {
+public:
+    // declSymbols maps record id to the object symbol of the decl
+    Lower(Assembler& assembler, const air::Air& air, const air::Pool& pool, const std::vector<Index>& declSymbols);
+
+    // Emits the whole function. If the result is NULL_INDEX then the function returns zero.
+    void EmitFunction(Index resultInst, Index storeSym = NULL_INDEX);
+
+private:
+    Assembler& m_as;
+    const air::Air& m_air;
+    const air::Pool& m_pool;
+    const std::vector<Index>& m_declSymbols;
+
+    RegAlloc m_regAlloc;
+
+    // type of every instruction
+    std::vector<Index> m_types;
+    std::uint32_t m_savedCount = 0;
+
+    void EmitInst(Index inst);
+    void EmitConstant(Index inst, Reg dst);
+    void EmitBinOp(Index inst, const Location& dst);
+    void EmitDivMod(Index inst, bool isMod);
+    void EmitShift(Index inst, ShiftOp op);
+
+    // Returns register with the value of the instruction. The scratch register is used if the value is spilled.
+    Reg Use(Index inst, Reg scratch);
+    // Returns register in which the value of the instruction should be computed
+    Reg Target(const Location& dst, Reg scratch);
+    // Moves the computed value to its location
+    void Define(const Location& dst, Reg computed);
+    // Normalizes the value to the size of the type
+    void Normalize(Reg reg, Index type);
+
+    [[nodiscard]] std::int32_t SlotOffset(std::uint32_t slot) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "RegAlloc.h"
+#include <algorithm>
+
+namespace codegen::x86_64 {
+
+bool RegAlloc::IsCalleeSaved(Reg reg) {
+    switch (reg) {
+    case Reg::RBX:
+    case Reg::RBP:
+    case Reg::R12:
+    case Reg::R13:
+    case Reg::R14:
+    case Reg::R15:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void RegAlloc::ComputeLiveness(Index resultInst) {
+    const auto count = static_cast<Index>(m_air.Inst.size());
+
+    m_lastUse.assign(count, NULL_INDEX);
+
+    for (Index inst = 1; inst < count; inst++) {
+        air::forEachOperand(m_air, inst, [&](Index operand) { m_lastUse[operand] = inst; });
+    }
+
+    // the result is used by the epilogue
+    if (!isNull(resultInst)) {
+        m_lastUse[resultInst] = count;
+    }
+}
+
+void RegAlloc::Run(Index resultInst) {
+    ComputeLiveness(resultInst);
+
+    const auto count = static_cast<Index>(m_air.Inst.size());
+    m_locations.assign(count, Location {});
+
+    // reversed so the preferred registers are popped first
+    m_freeRegs.assign(ALLOCATABLE.rbegin(), ALLOCATABLE.rend());
+
+    for (Index inst = 1; inst < count; inst++) {
+        if (isNull(m_lastUse[inst])) {
+            continue;
+        }
+
+        ExpireOld(inst);
+
+        if (m_freeRegs.empty()) {
+            SpillAt(inst);
+            continue;
+        }
+
+        const Reg reg = m_freeRegs.back();
+        m_freeRegs.pop_back();
+
+        if (IsCalleeSaved(reg) && std::ranges::find(m_usedCalleeSaved, reg) == m_usedCalleeSaved.end()) {
+            m_usedCalleeSaved.push_back(reg);
+        }
+
+        m_locations[inst] = { LocationKind::REG, reg, 0 };
+        AddActive(inst);
+    }
+}
+
+void RegAlloc::ExpireOld(Index inst) {
+    // The operands which die at this instruction can be reused as its destination.
+    auto iter = m_active.begin();
+    for (; iter != m_active.end() && m_lastUse[*iter] <= inst; ++iter) {
+        m_freeRegs.push_back(m_locations[*iter].Register);
+    }
+
+    m_active.erase(m_active.begin(), iter);
+}
+
+void RegAlloc::SpillAt(Index inst) {
+    const Index spill = m_active.back();
+
+    // spill the interval which ends last
+    if (m_lastUse[spill] > m_lastUse[inst]) {
+        m_locations[inst] = { LocationKind::REG, m_locations[spill].Register, 0 };
+        m_locations[spill] = { LocationKind::STACK, Reg::RAX, AllocSlot() };
+
+        m_active.pop_back();
+        AddActive(inst);
+    } else {
+        m_locations[inst] = { LocationKind::STACK, Reg::RAX, AllocSlot() };
+    }
+}
+
+void RegAlloc::AddActive(Index inst) {
+    const auto pos = std::ranges::upper_bound(m_active, m_lastUse[inst], {}, [this](Index i) { return m_lastUse[i]; });
+    m_active.insert(pos, inst);
+}
+
+std::uint32_t RegAlloc::AllocSlot() {
+    // Slots are not reused, spilled intervals overlap most of the time anyway and the frame stays small.
+    return m_slotsCount++;
+}
+
+}
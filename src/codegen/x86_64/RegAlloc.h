@@ -0,0 +1,80 @@
+#ifndef KOOLANG_CODEGEN_X86_64_REGALLOC_H
+#define KOOLANG_CODEGEN_X86_64_REGALLOC_H
+
+#include "Assembler.h"
+#include "air/Inst.h"
+#include "util/Index.h"
+#include <array>
+#include <vector>
+
+namespace codegen::x86_64 {
+
+enum class LocationKind : std::uint8_t {
+    // the value is never used
+    NONE,
+    REG,
+    STACK,
+};
+
+struct Location {
+    LocationKind Kind  = LocationKind::NONE;
+    Reg Register       = Reg::RAX;
+    std::uint32_t Slot = 0;
+};
+
+// Linear scan register allocator (Poletto & Sarkar). AIR of a decl is straight-line code, so the live interval of an
+// instruction starts at its definition and ends at its last use. RAX, RCX and RDX are never allocated, they are used
+// as scratch registers by the lowering (div, shifts, spilled operands).
+class RegAlloc {
+public:
+    // Registers in the order of preference, caller saved registers first.
+    static constexpr auto ALLOCATABLE = std::to_array({
+        Reg::RSI,
+        Reg::RDI,
+        Reg::R8,
+        Reg::R9,
+        Reg::R10,
+        Reg::R11,
+        Reg::RBX,
+        Reg::R12,
+        Reg::R13,
+        Reg::R14,
+        Reg::R15,
+    });
+
+    RegAlloc(const air::Air& air)
+        : m_air(air) { }
+
+    // resultInst is kept alive until the end of the function
+    void Run(Index resultInst);
+
+    [[nodiscard]] const Location& Get(Index inst) const { return m_locations.at(inst); }
+    [[nodiscard]] std::uint32_t GetSlotsCount() const { return m_slotsCount; }
+    [[nodiscard]] const std::vector<Reg>& GetUsedCalleeSaved() const { return m_usedCalleeSaved; }
+
+    static bool IsCalleeSaved(Reg reg);
+
+private:
+    const air::Air& m_air;
+
+    // index of the last instruction which uses the instruction, NULL_INDEX if it's unused
+    std::vector<Index> m_lastUse;
+    std::vector<Location> m_locations;
+
+    // active intervals sorted by the end
+    std::vector<Index> m_active;
+    std::vector<Reg> m_freeRegs;
+    std::vector<Reg> m_usedCalleeSaved;
+
+    std::uint32_t m_slotsCount = 0;
+
+    void ComputeLiveness(Index resultInst);
+    void ExpireOld(Index inst);
+    void SpillAt(Index inst);
+    void AddActive(Index inst);
+    std::uint32_t AllocSlot();
+};
+
+}
+
+#endif
@@ -26,6 +26,7 @@ AstGen::AstGen(Kir& kir, const ast::Ast& tree)
     kir.Extra.reserve(tree.Nodes.size());
 
     kir.Imports.reserve(tree.Imports.size());
+    kir.ImportAliases.reserve(tree.Imports.size());
 
     // reserve 0-index
     kir.Inst.emplace_back();
@@ -176,23 +177,23 @@ void AstGen::Generate() {
             const auto strID = m_strings.GetOrCreateStr(path);
             m_kir.Imports.push_back(strID);
 
+            // import a::b = c;
             if (isNull(importPath.Rhs)) {
-                continue;
+                m_kir.ImportAliases.push_back(NULL_INDEX);
+            } else {
+                m_kir.ImportAliases.push_back(m_strings.GetOrCreateStr(m_tree.Tokens.GetTokContent(importPath.Rhs)));
             }
-
-            // import a::b = c;
-            // a::b::Some == c::Some
-            KOOLANG_INFO_MSG("TODO: Import alias");
-            KOOLANG_TODO();
         }
     }
 
     const auto topBlock = EnterBlock();
 
-    for (const auto topStmt : m_tree.Top) {
+    for (std::size_t i = 0; i < m_tree.Top.size(); i++) {
         using ast::Tag;
 
-        const Tag tag = m_tree.NodeTags.at(topStmt);
+        const Index topStmt  = m_tree.Top[i];
+        const Index topDecls = m_cache.Size();
+        const Tag tag        = m_tree.NodeTags.at(topStmt);
         switch (tag) {
         case ast::Tag::CONSTANT:
             GenGlobConst(topStmt);
@@ -215,9 +216,15 @@ void AstGen::Generate() {
         case ast::Tag::TRAIT:
             GenTrait(topStmt);
             break;
+        // generated with the imports above
+        case ast::Tag::IMPORT:
+            break;
         default:
             KOOLANG_UNREACHABLE();
         }
+
+        // every decl created by the statement gets the hash of its tokens
+        m_kir.DeclHashes.insert(m_kir.DeclHashes.end(), m_cache.Size() - topDecls, m_tree.TopHashes.at(i));
     }
 
     CreateBlock(InstType::BLOCK, topBlock, NULL_INDEX);
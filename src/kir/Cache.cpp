@@ -0,0 +1,257 @@
+#include "Cache.h"
+#include "util/file.h"
+#include <bit>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace kir::cache {
+
+namespace {
+
+    // "KKIR"
+    constexpr std::uint32_t MAGIC          = 0x52494b4b;
+    constexpr std::uint32_t FORMAT_VERSION = 5;
+
+    struct Header {
+        std::uint32_t Magic;
+        std::uint32_t FormatVersion;
+        std::uint64_t Key;
+        std::uint64_t InstCount;
+        std::uint64_t ExtraCount;
+        std::uint64_t ImportsCount;
+        std::uint64_t StringsCount;
+        std::uint64_t DeclHashesCount;
+        std::uint64_t StringBytes;
+        std::uint64_t MessageBytes;
+    };
+
+    static_assert(sizeof(InstData) == 8, "The cache stores KIR instructions as 8 bytes");
+
+    constexpr std::uint64_t align(std::uint64_t size) { return (size + 7) & ~static_cast<std::uint64_t>(7); }
+
+    // Offsets of the sections from the start of the file
+    struct Layout {
+        std::uint64_t Inst;
+        std::uint64_t Extra;
+        std::uint64_t Imports;
+        std::uint64_t ImportAliases;
+        std::uint64_t StringEnds;
+        std::uint64_t DeclHashes;
+        std::uint64_t Type;
+        std::uint64_t StringBytes;
+        std::uint64_t Messages;
+        std::uint64_t Size;
+
+        explicit Layout(const Header& header)
+            : Inst(align(sizeof(Header)))
+            , Extra(Inst + align(header.InstCount * sizeof(InstData)))
+            , Imports(Extra + align(header.ExtraCount * sizeof(Index)))
+            , ImportAliases(Imports + align(header.ImportsCount * sizeof(Index)))
+            , StringEnds(ImportAliases + align(header.ImportsCount * sizeof(Index)))
+            , DeclHashes(StringEnds + align(header.StringsCount * sizeof(std::uint64_t)))
+            , Type(DeclHashes + align(header.DeclHashesCount * sizeof(std::uint64_t)))
+            , StringBytes(Type + align(header.InstCount * sizeof(InstType)))
+            , Messages(StringBytes + align(header.StringBytes))
+            , Size(Messages + align(header.MessageBytes)) { }
+    };
+
+    // Every count of the header fits in the file, so the offsets of the layout can't wrap around
+    bool isBounded(const Header& header, std::uint64_t size) {
+        return header.InstCount <= size / sizeof(InstData) && header.ExtraCount <= size / sizeof(Index)
+            && header.ImportsCount <= size / sizeof(Index) && header.StringsCount <= size / sizeof(std::uint64_t)
+            && header.DeclHashesCount <= size / sizeof(std::uint64_t) && header.StringBytes <= size
+            && header.MessageBytes <= size;
+    }
+
+    constexpr std::uint64_t K0 = 0x9e3779b97f4a7c15;
+    constexpr std::uint64_t K1 = 0xbf58476d1ce4e5b9;
+    constexpr std::uint64_t K2 = 0x94d049bb133111eb;
+
+    std::uint64_t hashBytes(std::string_view data, std::uint64_t seed) {
+        std::uint64_t hash = seed ^ (data.size() * K0);
+        std::size_t offset = 0;
+
+        // 8 bytes per step
+        for (; offset + sizeof(std::uint64_t) <= data.size(); offset += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, data.data() + offset, sizeof(word));
+
+            hash = std::rotl(hash ^ (word * K0), 29) * K1;
+        }
+
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, data.data() + offset, data.size() - offset);
+        hash ^= tail * K0;
+
+        hash = (hash ^ (hash >> 30)) * K1;
+        hash = (hash ^ (hash >> 27)) * K2;
+        return hash ^ (hash >> 31);
+    }
+
+    template <typename T>
+    void copySection(const char* base, std::uint64_t offset, std::vector<T>& into, std::uint64_t count) {
+        into.resize(count);
+        std::memcpy(static_cast<void*>(into.data()), base + offset, count * sizeof(T));
+    }
+
+    bool loadMapped(const char* base, std::uint64_t size, std::uint64_t key, Kir& kir, std::string& messages) {
+        if (size < sizeof(Header)) {
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, base, sizeof(Header));
+
+        if (header.Magic != MAGIC || header.FormatVersion != FORMAT_VERSION || header.Key != key
+            || !isBounded(header, size)) {
+            return false;
+        }
+
+        const Layout layout(header);
+        if (layout.Size != size) {
+            return false;
+        }
+
+        copySection(base, layout.Inst, kir.Inst, header.InstCount);
+        copySection(base, layout.Type, kir.Type, header.InstCount);
+        copySection(base, layout.Extra, kir.Extra, header.ExtraCount);
+        copySection(base, layout.Imports, kir.Imports, header.ImportsCount);
+        copySection(base, layout.ImportAliases, kir.ImportAliases, header.ImportsCount);
+        copySection(base, layout.DeclHashes, kir.DeclHashes, header.DeclHashesCount);
+
+        std::vector<std::uint64_t> ends;
+        copySection(base, layout.StringEnds, ends, header.StringsCount);
+
+        kir.Strings.clear();
+        kir.Strings.reserve(header.StringsCount);
+
+        std::uint64_t start = 0;
+        for (const std::uint64_t end : ends) {
+            if (end < start || end > header.StringBytes) {
+                return false;
+            }
+
+            kir.Strings.emplace_back(base + layout.StringBytes + start, end - start);
+            start = end;
+        }
+
+        messages.assign(base + layout.Messages, header.MessageBytes);
+        return true;
+    }
+
+}
+
+std::uint64_t computeKey(std::uint64_t tokensHash) {
+    const std::string_view bytes(reinterpret_cast<const char*>(&tokensHash), sizeof(tokensHash));
+    return hashBytes(bytes, hashBytes(VERSION, FORMAT_VERSION));
+}
+
+std::filesystem::path getPath(const std::filesystem::path& cacheDir, std::uint64_t key) {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".kir";
+
+    return cacheDir / "kir" / name.str();
+}
+
+bool load(const std::filesystem::path& path, std::uint64_t key, Kir& kir, std::string& messages) {
+#ifdef _WIN32
+    // TODO: mapping on Windows
+    DISCARD_VALUE(path);
+    DISCARD_VALUE(key);
+    DISCARD_VALUE(kir);
+    DISCARD_VALUE(messages);
+    return false;
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info { };
+    if (::fstat(file, &info) != 0 || info.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+
+    const auto size = static_cast<std::uint64_t>(info.st_size);
+    void* mapped    = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    const bool loaded = loadMapped(static_cast<const char*>(mapped), size, key, kir, messages);
+    ::munmap(mapped, size);
+
+    if (!loaded) {
+        kir = Kir();
+        messages.clear();
+    }
+
+    return loaded;
+#endif
+}
+
+bool store(
+    const std::filesystem::path& path, std::uint64_t key, const Kir& kir, std::string_view messages, bool isDurable
+) {
+    Header header {
+        .Magic           = MAGIC,
+        .FormatVersion   = FORMAT_VERSION,
+        .Key             = key,
+        .InstCount       = kir.Inst.size(),
+        .ExtraCount      = kir.Extra.size(),
+        .ImportsCount    = kir.Imports.size(),
+        .StringsCount    = kir.Strings.size(),
+        .DeclHashesCount = kir.DeclHashes.size(),
+        .StringBytes     = 0,
+        .MessageBytes    = messages.size(),
+    };
+
+    std::vector<std::uint64_t> ends;
+    ends.reserve(kir.Strings.size());
+
+    for (const auto& str : kir.Strings) {
+        header.StringBytes += str.size();
+        ends.push_back(header.StringBytes);
+    }
+
+    const Layout layout(header);
+    std::vector<char> buffer(layout.Size, 0);
+
+    const auto write = [&](std::uint64_t offset, const void* data, std::uint64_t size) {
+        if (size != 0) {
+            std::memcpy(buffer.data() + offset, data, size);
+        }
+    };
+
+    write(0, &header, sizeof(Header));
+    write(layout.Inst, kir.Inst.data(), kir.Inst.size() * sizeof(InstData));
+    write(layout.Extra, kir.Extra.data(), kir.Extra.size() * sizeof(Index));
+    write(layout.Imports, kir.Imports.data(), kir.Imports.size() * sizeof(Index));
+    write(layout.ImportAliases, kir.ImportAliases.data(), kir.ImportAliases.size() * sizeof(Index));
+    write(layout.StringEnds, ends.data(), ends.size() * sizeof(std::uint64_t));
+    write(layout.DeclHashes, kir.DeclHashes.data(), kir.DeclHashes.size() * sizeof(std::uint64_t));
+    write(layout.Type, kir.Type.data(), kir.Type.size() * sizeof(InstType));
+
+    std::uint64_t offset = layout.StringBytes;
+    for (const auto& str : kir.Strings) {
+        write(offset, str.data(), str.size());
+        offset += str.size();
+    }
+
+    write(layout.Messages, messages.data(), messages.size());
+
+    return writeFileAtomic(path, std::string_view(buffer.data(), buffer.size()), isDurable);
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef KOOLANG_KIR_CACHE_H
+#define KOOLANG_KIR_CACHE_H
+
+#include "Inst.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// On-disk cache of the generated KIR. The file is the header followed by the sections, every section starts at the
+// offset aligned to 8 bytes, so the mapped file is used without parsing:
+//
+//   Header | Inst | Extra | Imports | import aliases | string ends | decl hashes | Type | string bytes | messages
+//
+// The messages are the warnings of the parser and AstGen, encoded by the caller.
+namespace kir::cache {
+
+// Returns the key of the token stream hash, the key differs for every compiler version. KIR refers to the tokens by
+// their index only, so the sources which differ in comments and whitespace share the key.
+std::uint64_t computeKey(std::uint64_t tokensHash);
+
+// Returns the cache file of the key, the file is shared by all sources with the same tokens
+std::filesystem::path getPath(const std::filesystem::path& cacheDir, std::uint64_t key);
+
+// Returns false if the file doesn't exist, is from a different version or is damaged
+bool load(const std::filesystem::path& path, std::uint64_t key, Kir& kir, std::string& messages);
+
+// Writes the file under a temporary name and renames it, so readers never see a partial file. The spilled KIR isn't
+// durable, it's read only by the build which wrote it.
+bool store(
+    const std::filesystem::path& path, std::uint64_t key, const Kir& kir, std::string_view messages,
+    bool isDurable = true
+);
+
+}
+
+#endif
@@ -509,6 +509,10 @@ struct Kir {
     std::vector<Index> Extra;
     std::vector<std::string> Strings;
     std::vector<Index> Imports;
+    // alias of every import, NULL_INDEX if the import has none
+    std::vector<Index> ImportAliases;
+    // hash of the tokens of every top decl, in the order of the top block
+    std::vector<std::uint64_t> DeclHashes;
 };
 
 static_assert(sizeof(InstType) == 1, "Enum InstType must have size 1 byte");
@@ -21,6 +21,9 @@ class Record {
     Record(RecordKind kind, const File* file, std::uint16_t code, std::string_view msg, const Label& label);
     void Print(std::ostream& stream);
     [[nodiscard]] RecordKind GetKind() const { return m_kind; }
+    [[nodiscard]] std::uint16_t GetCode() const { return m_code; }
+    [[nodiscard]] std::string_view GetMsg() const { return m_msg; }
+    [[nodiscard]] const Label& GetLabel() const { return m_label; }
 
 private:
     RecordKind m_kind;
@@ -28,7 +31,7 @@ class Record {
 
     Label m_label;
 
-    std::string_view m_msg;
+    std::string m_msg;
 
     const File* m_file;
 };
@@ -0,0 +1,258 @@
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <format>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace logger::stats {
+
+namespace {
+
+    struct MemoryRow {
+        std::size_t Count    = 0;
+        std::size_t Used     = 0;
+        std::size_t Reserved = 0;
+    };
+
+    struct PhaseRow {
+        std::string_view Name;
+        std::uint64_t Allocations = 0;
+        std::uint64_t Bytes       = 0;
+        std::size_t PeakRss       = 0;
+    };
+
+    std::atomic<std::uint64_t> g_allocations    = 0;
+    std::atomic<std::uint64_t> g_allocatedBytes = 0;
+
+    std::mutex g_mutex;
+    // group -> name -> row
+    std::map<std::string, std::map<std::string, MemoryRow, std::less<>>, std::less<>> g_memory;
+    std::vector<PhaseRow> g_phases;
+    std::map<std::string, std::vector<std::size_t>, std::less<>> g_samples;
+
+    // Returns the peak resident set size of the process in bytes, 0 if unknown
+    std::size_t getPeakRss() {
+#ifdef _WIN32
+        return 0;
+#else
+        struct rusage usage { };
+        if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        // kilobytes on Linux
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    std::string formatBytes(std::size_t bytes) {
+        if (bytes < 1024) {
+            return std::format("{} B", bytes);
+        } else if (bytes < 1024 * 1024) {
+            return std::format("{:.1f} KiB", static_cast<double>(bytes) / 1024.0);
+        }
+
+        return std::format("{:.1f} MiB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+    }
+
+    void printDistribution(std::ostream& stream, std::string_view name, std::vector<std::size_t> samples) {
+        std::sort(samples.begin(), samples.end());
+
+        std::size_t total = 0;
+        for (const std::size_t sample : samples) {
+            total += sample;
+        }
+
+        stream << name << ": count " << samples.size() << ", total " << total << ", min " << samples.front()
+               << ", median " << samples[samples.size() / 2] << ", p90 " << samples[samples.size() * 9 / 10]
+               << ", max " << samples.back() << '\n';
+
+        // buckets by the powers of two: [0, 1], [2, 3], [4, 7], ...
+        std::vector<std::size_t> buckets;
+        for (const std::size_t sample : samples) {
+            const auto width         = static_cast<std::size_t>(std::bit_width(sample));
+            const std::size_t bucket = std::max(width, std::size_t { 1 }) - 1;
+            if (bucket >= buckets.size()) {
+                buckets.resize(bucket + 1);
+            }
+            buckets[bucket]++;
+        }
+
+        for (std::size_t i = 0; i < buckets.size(); i++) {
+            if (buckets[i] == 0) {
+                continue;
+            }
+
+            const std::size_t low  = (i == 0) ? 0 : (std::size_t { 1 } << i);
+            const std::size_t high = (std::size_t { 1 } << (i + 1)) - 1;
+            stream << "  " << std::right << std::setw(10) << std::format("{}-{}", low, high) << ' '
+                   << std::setw(8) << buckets[i] << '\n';
+        }
+    }
+
+}
+
+void addMemory(
+    std::string_view group, std::string_view name, std::size_t count, std::size_t used, std::size_t reserved
+) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    auto groupIter = g_memory.find(group);
+    if (groupIter == g_memory.end()) {
+        groupIter = g_memory.emplace(std::string(group), std::map<std::string, MemoryRow, std::less<>>()).first;
+    }
+
+    auto rowIter = groupIter->second.find(name);
+    if (rowIter == groupIter->second.end()) {
+        rowIter = groupIter->second.emplace(std::string(name), MemoryRow()).first;
+    }
+
+    rowIter->second.Count += count;
+    rowIter->second.Used += used;
+    rowIter->second.Reserved += reserved;
+}
+
+void addStrings(std::string_view group, std::string_view name, const std::vector<std::string>& strings) {
+    // the characters of the short strings are stored in the string object
+    const std::size_t inlineCapacity = std::string().capacity();
+
+    std::size_t used     = strings.size() * sizeof(std::string);
+    std::size_t reserved = strings.capacity() * sizeof(std::string);
+
+    for (const std::string& str : strings) {
+        if (str.capacity() > inlineCapacity) {
+            used += str.size() + 1;
+            reserved += str.capacity() + 1;
+        }
+    }
+
+    addMemory(group, name, strings.size(), used, reserved);
+}
+
+void addSample(std::string_view distribution, std::size_t value) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    auto iter = g_samples.find(distribution);
+    if (iter == g_samples.end()) {
+        iter = g_samples.emplace(std::string(distribution), std::vector<std::size_t>()).first;
+    }
+
+    iter->second.push_back(value);
+}
+
+Phase::Phase(std::string_view name) {
+    if (g_enabled) [[unlikely]] {
+        m_name        = name;
+        m_allocations = g_allocations.load(std::memory_order_relaxed);
+        m_bytes       = g_allocatedBytes.load(std::memory_order_relaxed);
+        m_isActive    = true;
+    }
+}
+
+Phase::~Phase() {
+    if (!m_isActive) [[likely]] {
+        return;
+    }
+
+    const PhaseRow row {
+        .Name        = m_name,
+        .Allocations = g_allocations.load(std::memory_order_relaxed) - m_allocations,
+        .Bytes       = g_allocatedBytes.load(std::memory_order_relaxed) - m_bytes,
+        .PeakRss     = getPeakRss(),
+    };
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_phases.push_back(row);
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    g_memory.clear();
+    g_phases.clear();
+    g_samples.clear();
+}
+
+void printReport(std::ostream& stream) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    stream << std::left << std::setw(12) << "group" << std::setw(20) << "name" << std::right << std::setw(10)
+           << "count" << std::setw(14) << "used" << std::setw(14) << "reserved" << '\n';
+
+    MemoryRow total;
+    for (const auto& [group, rows] : g_memory) {
+        for (const auto& [name, row] : rows) {
+            stream << std::left << std::setw(12) << group << std::setw(20) << name << std::right << std::setw(10)
+                   << row.Count << std::setw(14) << formatBytes(row.Used) << std::setw(14)
+                   << formatBytes(row.Reserved) << '\n';
+
+            total.Used += row.Used;
+            total.Reserved += row.Reserved;
+        }
+    }
+
+    stream << std::left << std::setw(42) << "total" << std::right << std::setw(14) << formatBytes(total.Used)
+           << std::setw(14) << formatBytes(total.Reserved) << '\n';
+
+    stream << '\n' << std::left << std::setw(20) << "phase" << std::right << std::setw(14) << "allocations"
+           << std::setw(14) << "allocated" << std::setw(14) << "peak RSS" << '\n';
+    for (const PhaseRow& row : g_phases) {
+        stream << std::left << std::setw(20) << row.Name << std::right;
+#ifdef KOOLANG_COUNT_ALLOCATIONS
+        stream << std::setw(14) << row.Allocations << std::setw(14) << formatBytes(row.Bytes);
+#else
+        stream << std::setw(14) << '-' << std::setw(14) << '-';
+#endif
+        stream << std::setw(14) << formatBytes(row.PeakRss) << '\n';
+    }
+
+#ifndef KOOLANG_COUNT_ALLOCATIONS
+    stream << "(the allocations are counted only when built with KOOLANG_COUNT_ALLOCATIONS)\n";
+#endif
+
+    stream << "peak RSS: " << formatBytes(getPeakRss()) << '\n';
+
+    for (const auto& [name, samples] : g_samples) {
+        stream << '\n';
+        printDistribution(stream, name, samples);
+    }
+}
+
+}
+
+#ifdef KOOLANG_COUNT_ALLOCATIONS
+
+// The array and nothrow forms call these
+void* operator new(std::size_t size) {
+    if (logger::stats::g_enabled) [[unlikely]] {
+        logger::stats::g_allocations.fetch_add(1, std::memory_order_relaxed);
+        logger::stats::g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
+
+#endif
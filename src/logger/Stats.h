@@ -0,0 +1,68 @@
+#ifndef KOOLANG_LOGGER_STATS_H
+#define KOOLANG_LOGGER_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Memory statistics of the compiler data structures for '--stats'. The heap allocations are counted only when the
+// compiler is built with KOOLANG_COUNT_ALLOCATIONS, which replaces the global operator new and delete.
+namespace logger::stats {
+
+// Set before the threads of the build are started
+inline bool g_enabled = false;
+
+// Adds the row to the memory table, the rows with the same group and name are summed
+void addMemory(
+    std::string_view group, std::string_view name, std::size_t count, std::size_t used, std::size_t reserved
+);
+
+template <typename Type>
+inline void addVector(std::string_view group, std::string_view name, const std::vector<Type>& vec) {
+    addMemory(group, name, vec.size(), vec.size() * sizeof(Type), vec.capacity() * sizeof(Type));
+}
+
+// The nodes are estimated as the value with the next pointer and the cached hash
+template <typename Map> inline void addHashMap(std::string_view group, std::string_view name, const Map& map) {
+    constexpr std::size_t nodeSize = sizeof(typename Map::value_type) + 2 * sizeof(void*);
+
+    const std::size_t bytes = map.size() * nodeSize + map.bucket_count() * sizeof(void*);
+    addMemory(group, name, map.size(), bytes, bytes);
+}
+
+// Includes the characters of the strings that don't fit in the string object
+void addStrings(std::string_view group, std::string_view name, const std::vector<std::string>& strings);
+
+// Adds the value to the size distribution
+void addSample(std::string_view distribution, std::size_t value);
+
+// Counts the heap allocations and the peak RSS of the phase until the end of the scope. The allocations of all threads
+// are counted, so the phases must not overlap.
+class Phase {
+public:
+    explicit Phase(std::string_view name);
+
+    Phase(const Phase&)            = delete;
+    Phase& operator=(const Phase&) = delete;
+
+    ~Phase();
+
+private:
+    std::string_view m_name;
+    std::uint64_t m_allocations = 0;
+    std::uint64_t m_bytes       = 0;
+    bool m_isActive             = false;
+};
+
+// Removes the collected statistics, every build of the long-running modes is reported alone
+void clear();
+
+// Prints the memory table, the phases and the distributions
+void printReport(std::ostream& stream);
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "Trace.h"
+#include "util/Index.h"
+#include "util/file.h"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace logger::trace {
+
+namespace {
+
+    struct Event {
+        std::string_view Phase;
+        std::string Module;
+        std::string Detail;
+        // nanoseconds since the start of the process
+        std::int64_t Start;
+        std::int64_t Duration;
+    };
+
+    // events of one thread, only the thread writes them
+    struct Buffer {
+        std::uint32_t Thread = 0;
+        std::string Name;
+        std::vector<Event> Events;
+    };
+
+    const Clock::time_point g_epoch = Clock::now();
+
+    // the buffers outlive their threads
+    std::mutex g_mutex;
+    std::vector<std::unique_ptr<Buffer>> g_buffers;
+
+    thread_local Buffer* t_buffer = nullptr;
+
+    Buffer& getBuffer() {
+        if (isNull(t_buffer)) {
+            std::lock_guard<std::mutex> lock(g_mutex);
+
+            auto& buffer   = g_buffers.emplace_back(std::make_unique<Buffer>());
+            buffer->Thread = static_cast<std::uint32_t>(g_buffers.size() - 1);
+            buffer->Name   = std::format("thread {}", buffer->Thread);
+            t_buffer       = buffer.get();
+        }
+
+        return *t_buffer;
+    }
+
+    std::int64_t toNanoseconds(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    double toMilliseconds(std::int64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1e6; }
+
+    // Returns the time of the events without their nested events, the events of one thread never overlap partially
+    std::vector<std::int64_t> computeSelfTimes(const std::vector<Event>& events) {
+        std::vector<std::int64_t> self(events.size());
+        std::vector<std::size_t> order(events.size());
+
+        for (std::size_t i = 0; i < events.size(); i++) {
+            self[i]  = events[i].Duration;
+            order[i] = i;
+        }
+
+        // the outer event first when the events start together
+        std::sort(order.begin(), order.end(), [&events](std::size_t lhs, std::size_t rhs) {
+            if (events[lhs].Start != events[rhs].Start) {
+                return events[lhs].Start < events[rhs].Start;
+            }
+            return events[lhs].Duration > events[rhs].Duration;
+        });
+
+        std::vector<std::size_t> open;
+        for (const std::size_t index : order) {
+            const Event& event = events[index];
+
+            while (!open.empty() && events[open.back()].Start + events[open.back()].Duration <= event.Start) {
+                open.pop_back();
+            }
+
+            if (!open.empty()) {
+                self[open.back()] -= event.Duration;
+            }
+            open.push_back(index);
+        }
+
+        return self;
+    }
+
+    void dumpString(std::string& out, std::string_view str) {
+        out += '"';
+
+        for (const char character : str) {
+            if (character == '"' || character == '\\') {
+                out += '\\';
+                out += character;
+            } else if (static_cast<unsigned char>(character) < 0x20) {
+                out += std::format("\\u{:04x}", static_cast<unsigned>(character));
+            } else {
+                out += character;
+            }
+        }
+
+        out += '"';
+    }
+
+}
+
+void record(
+    std::string_view phase, std::string_view module, std::string_view detail, Clock::time_point start,
+    Clock::time_point end
+) {
+    getBuffer().Events.push_back(Event {
+        .Phase    = phase,
+        .Module   = std::string(module),
+        .Detail   = std::string(detail),
+        .Start    = toNanoseconds(start - g_epoch),
+        .Duration = toNanoseconds(end - start),
+    });
+}
+
+void nameThread(std::string name) { getBuffer().Name = std::move(name); }
+
+void clear() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    for (auto& buffer : g_buffers) {
+        buffer->Events.clear();
+    }
+}
+
+void printReport(std::ostream& stream) {
+    struct PhaseTotal {
+        std::size_t Count  = 0;
+        std::int64_t Total = 0;
+        std::int64_t Self  = 0;
+    };
+
+    std::map<std::string_view, PhaseTotal> phases;
+    std::map<std::string_view, std::int64_t> modules;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    for (const auto& buffer : g_buffers) {
+        const std::vector<std::int64_t> self = computeSelfTimes(buffer->Events);
+
+        for (std::size_t i = 0; i < buffer->Events.size(); i++) {
+            const Event& event = buffer->Events[i];
+
+            PhaseTotal& total = phases[event.Phase];
+            total.Count++;
+            total.Total += event.Duration;
+            total.Self += self[i];
+
+            if (!event.Module.empty()) {
+                modules[event.Module] += self[i];
+            }
+        }
+    }
+
+    // the slowest first
+    std::vector<std::pair<std::string_view, PhaseTotal>> phaseRows(phases.begin(), phases.end());
+    std::sort(phaseRows.begin(), phaseRows.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.Self > rhs.second.Self;
+    });
+
+    std::vector<std::pair<std::string_view, std::int64_t>> moduleRows(modules.begin(), modules.end());
+    std::sort(moduleRows.begin(), moduleRows.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second > rhs.second;
+    });
+
+    stream << std::fixed << std::setprecision(3);
+
+    stream << std::left << std::setw(20) << "phase" << std::right << std::setw(8) << "count" << std::setw(14)
+           << "total [ms]" << std::setw(14) << "self [ms]" << '\n';
+    for (const auto& [phase, total] : phaseRows) {
+        stream << std::left << std::setw(20) << phase << std::right << std::setw(8) << total.Count << std::setw(14)
+               << toMilliseconds(total.Total) << std::setw(14) << toMilliseconds(total.Self) << '\n';
+    }
+
+    stream << '\n' << std::left << std::setw(42) << "module" << std::right << std::setw(14) << "self [ms]" << '\n';
+    for (const auto& [module, self] : moduleRows) {
+        stream << std::left << std::setw(42) << module << std::right << std::setw(14) << toMilliseconds(self) << '\n';
+    }
+
+    stream << std::defaultfloat;
+}
+
+bool writeChromeTrace(const std::filesystem::path& path) {
+    std::string out = "{\"traceEvents\":[";
+    bool isFirst    = true;
+
+    const auto separate = [&out, &isFirst]() {
+        if (!isFirst) {
+            out += ",\n";
+        }
+        isFirst = false;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        for (const auto& buffer : g_buffers) {
+            const std::string thread = std::to_string(buffer->Thread);
+
+            separate();
+            out += R"({"name":"thread_name","ph":"M","pid":1,"tid":)" + thread + R"(,"args":{"name":)";
+            dumpString(out, buffer->Name);
+            out += "}}";
+
+            // the timestamps are in microseconds
+            for (const Event& event : buffer->Events) {
+                separate();
+                out += R"({"name":)";
+                dumpString(out, event.Phase);
+                out += R"(,"cat":"koolang","ph":"X","pid":1,"tid":)" + thread;
+                out += std::format(R"(,"ts":{:.3f},"dur":{:.3f})", static_cast<double>(event.Start) / 1e3,
+                                   static_cast<double>(event.Duration) / 1e3);
+                out += R"(,"args":{"module":)";
+                dumpString(out, event.Module);
+                out += R"(,"detail":)";
+                dumpString(out, event.Detail);
+                out += "}}";
+            }
+        }
+    }
+
+    out += "]}\n";
+
+    return writeFileAtomic(path, out);
+}
+
+}
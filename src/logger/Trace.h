@@ -0,0 +1,77 @@
+#ifndef KOOLANG_LOGGER_TRACE_H
+#define KOOLANG_LOGGER_TRACE_H
+
+#include <chrono>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Scoped timers of the compiler phases. The events are collected per thread when '--time-report' or '--trace' is
+// given, otherwise the timer costs one predictable branch.
+namespace logger::trace {
+
+using Clock = std::chrono::steady_clock;
+
+// Set before the threads of the build are started
+inline bool g_enabled = false;
+
+// Records the finished event of the calling thread, the module and the detail are copied
+void record(
+    std::string_view phase, std::string_view module, std::string_view detail, Clock::time_point start,
+    Clock::time_point end
+);
+
+// Names the calling thread in the trace
+void nameThread(std::string name);
+
+// Times the phase until the end of the scope. The module and the detail must outlive the scope, they are shown in the
+// trace and the report is aggregated by the modules.
+class Scope {
+public:
+    explicit Scope(std::string_view phase, std::string_view module = {}, std::string_view detail = {}) {
+        if (g_enabled) [[unlikely]] {
+            m_phase    = phase;
+            m_module   = module;
+            m_detail   = detail;
+            m_start    = Clock::now();
+            m_isActive = true;
+        }
+    }
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() { Stop(); }
+
+    // Records the event now instead of at the end of the scope
+    void Stop() {
+        if (m_isActive) [[unlikely]] {
+            record(m_phase, m_module, m_detail, m_start, Clock::now());
+            m_isActive = false;
+        }
+    }
+
+    // The event isn't recorded
+    void Cancel() { m_isActive = false; }
+
+private:
+    std::string_view m_phase;
+    std::string_view m_module;
+    std::string_view m_detail;
+    Clock::time_point m_start;
+    bool m_isActive = false;
+};
+
+// Removes the recorded events, every build of the long-running modes is reported alone
+void clear();
+
+// Prints the total and self time of the phases and the self time of the modules
+void printReport(std::ostream& stream);
+
+// Writes the events in the trace event format of Chrome, returns false if the file can't be written
+bool writeChromeTrace(const std::filesystem::path& path);
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include "Document.h"
+#include <algorithm>
+#include <cctype>
+
+namespace lsp {
+
+namespace {
+
+    // Returns the number of UTF-16 code units of the UTF-8 sequence starting with the byte, 0 for continuation bytes
+    std::uint32_t utf16Units(unsigned char lead) {
+        if ((lead & 0xc0) == 0x80) {
+            return 0;
+        }
+
+        return lead >= 0xf0 ? 2 : 1;
+    }
+
+    int hexValue(char character) {
+        if (character >= '0' && character <= '9') {
+            return character - '0';
+        }
+        if (character >= 'a' && character <= 'f') {
+            return character - 'a' + 10;
+        }
+        if (character >= 'A' && character <= 'F') {
+            return character - 'A' + 10;
+        }
+
+        return -1;
+    }
+
+}
+
+Position toPosition(std::string_view text, std::size_t offset) {
+    Position position;
+    offset = std::min(offset, text.size());
+
+    for (std::size_t i = 0; i < offset; i++) {
+        if (text[i] == '\n') {
+            position.Line++;
+            position.Character = 0;
+        } else {
+            position.Character += utf16Units(static_cast<unsigned char>(text[i]));
+        }
+    }
+
+    return position;
+}
+
+std::size_t toOffset(std::string_view text, Position position) {
+    std::size_t offset = 0;
+
+    for (std::uint32_t line = 0; line < position.Line; line++) {
+        const std::size_t end = text.find('\n', offset);
+        if (end == std::string_view::npos) {
+            return text.size();
+        }
+
+        offset = end + 1;
+    }
+
+    std::uint32_t units = 0;
+    while (offset < text.size() && text[offset] != '\n') {
+        const std::uint32_t size = utf16Units(static_cast<unsigned char>(text[offset]));
+        if (size != 0 && units + size > position.Character) {
+            break;
+        }
+
+        units += size;
+        offset++;
+    }
+
+    return offset;
+}
+
+Position parsePosition(const json::Value& position) {
+    return Position {
+        .Line      = static_cast<std::uint32_t>(position["line"].AsInt()),
+        .Character = static_cast<std::uint32_t>(position["character"].AsInt()),
+    };
+}
+
+json::Value dumpPosition(Position position) {
+    return json::Value::Object().Set("line", position.Line).Set("character", position.Character);
+}
+
+json::Value dumpRange(std::string_view text, std::size_t start, std::size_t end) {
+    return json::Value::Object()
+        .Set("start", dumpPosition(toPosition(text, start)))
+        .Set("end", dumpPosition(toPosition(text, end)));
+}
+
+std::filesystem::path uriToPath(std::string_view uri) {
+    constexpr std::string_view SCHEME = "file://";
+
+    if (!uri.starts_with(SCHEME)) {
+        return {};
+    }
+    uri.remove_prefix(SCHEME.size());
+
+    std::string path;
+    for (std::size_t i = 0; i < uri.size(); i++) {
+        if (uri[i] == '%' && i + 2 < uri.size() && hexValue(uri[i + 1]) >= 0 && hexValue(uri[i + 2]) >= 0) {
+            path += static_cast<char>(hexValue(uri[i + 1]) * 16 + hexValue(uri[i + 2]));
+            i += 2;
+        } else {
+            path += uri[i];
+        }
+    }
+
+    return std::filesystem::path(path).lexically_normal();
+}
+
+std::string pathToUri(const std::filesystem::path& path) {
+    constexpr std::string_view HEX = "0123456789ABCDEF";
+
+    std::string uri = "file://";
+    for (const char character : path.generic_string()) {
+        const auto byte = static_cast<unsigned char>(character);
+
+        if (std::isalnum(byte) != 0 || character == '/' || character == '-' || character == '_' || character == '.'
+            || character == '~') {
+            uri += character;
+        } else {
+            uri += '%';
+            uri += HEX[byte >> 4];
+            uri += HEX[byte & 0xf];
+        }
+    }
+
+    return uri;
+}
+
+void Document::ApplyChange(const json::Value& change) {
+    const json::Value& range = change["range"];
+
+    if (range.IsNull()) {
+        Text = change["text"].AsString();
+        return;
+    }
+
+    const std::size_t start = toOffset(Text, parsePosition(range["start"]));
+    const std::size_t end   = std::max(start, toOffset(Text, parsePosition(range["end"])));
+
+    Text.replace(start, end - start, change["text"].AsString());
+}
+
+}
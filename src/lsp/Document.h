@@ -0,0 +1,48 @@
+#ifndef KOOLANG_LSP_DOCUMENT_H
+#define KOOLANG_LSP_DOCUMENT_H
+
+#include "Json.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace lsp {
+
+// Position of the protocol, the characters are counted in UTF-16 code units
+struct Position {
+    std::uint32_t Line      = 0;
+    std::uint32_t Character = 0;
+};
+
+// Converts the byte offset of the text to the position
+Position toPosition(std::string_view text, std::size_t offset);
+
+// Converts the position to the byte offset of the text, positions past the line end are clamped
+std::size_t toOffset(std::string_view text, Position position);
+
+[[nodiscard]] Position parsePosition(const json::Value& position);
+[[nodiscard]] json::Value dumpPosition(Position position);
+[[nodiscard]] json::Value dumpRange(std::string_view text, std::size_t start, std::size_t end);
+
+// Returns the path of the 'file://' URI, empty for the other schemes
+std::filesystem::path uriToPath(std::string_view uri);
+std::string pathToUri(const std::filesystem::path& path);
+
+// Open file of the editor
+struct Document {
+    std::string Uri;
+    // normalized path
+    std::filesystem::path Path;
+    std::string Text;
+    std::int64_t Version = 0;
+    // the diagnostics are not published for the current text yet
+    bool IsDirty = true;
+
+    // Applies the 'TextDocumentContentChangeEvent', the change without a range replaces the whole text
+    void ApplyChange(const json::Value& change);
+};
+
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include "Json.h"
+#include <cctype>
+#include <charconv>
+#include <format>
+
+namespace lsp::json {
+
+namespace {
+
+    // Nesting limit of the parsed values
+    constexpr int MAX_DEPTH = 128;
+
+    class Reader {
+    public:
+        explicit Reader(std::string_view text)
+            : m_text(text) { }
+
+        bool ParseDocument(Value& value) {
+            if (!ParseValue(value, 0)) {
+                return false;
+            }
+
+            SkipSpace();
+            return m_pos == m_text.size();
+        }
+
+    private:
+        std::string_view m_text;
+        std::size_t m_pos = 0;
+
+        void SkipSpace() {
+            while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])) != 0) {
+                m_pos++;
+            }
+        }
+
+        bool Eat(char character) {
+            SkipSpace();
+            if (m_pos < m_text.size() && m_text[m_pos] == character) {
+                m_pos++;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool EatWord(std::string_view word) {
+            if (m_text.substr(m_pos, word.size()) != word) {
+                return false;
+            }
+
+            m_pos += word.size();
+            return true;
+        }
+
+        bool ParseValue(Value& value, int depth) {
+            if (depth > MAX_DEPTH) {
+                return false;
+            }
+
+            SkipSpace();
+            if (m_pos == m_text.size()) {
+                return false;
+            }
+
+            switch (m_text[m_pos]) {
+            case '{':
+                return ParseObject(value, depth);
+            case '[':
+                return ParseArray(value, depth);
+            case '"': {
+                std::string str;
+                if (!ParseString(str)) {
+                    return false;
+                }
+                value = Value(std::move(str));
+                return true;
+            }
+            case 't':
+                value = Value(true);
+                return EatWord("true");
+            case 'f':
+                value = Value(false);
+                return EatWord("false");
+            case 'n':
+                value = Value(nullptr);
+                return EatWord("null");
+            default:
+                return ParseNumber(value);
+            }
+        }
+
+        bool ParseObject(Value& value, int depth) {
+            value = Value::Object();
+            m_pos++;
+
+            if (Eat('}')) {
+                return true;
+            }
+
+            do {
+                SkipSpace();
+
+                std::string key;
+                Value member;
+                if (!ParseString(key) || !Eat(':') || !ParseValue(member, depth + 1)) {
+                    return false;
+                }
+
+                value.Set(key, std::move(member));
+            } while (Eat(','));
+
+            return Eat('}');
+        }
+
+        bool ParseArray(Value& value, int depth) {
+            value = Value::Array();
+            m_pos++;
+
+            if (Eat(']')) {
+                return true;
+            }
+
+            do {
+                Value item;
+                if (!ParseValue(item, depth + 1)) {
+                    return false;
+                }
+
+                value.Push(std::move(item));
+            } while (Eat(','));
+
+            return Eat(']');
+        }
+
+        bool ParseNumber(Value& value) {
+            const std::size_t start = m_pos;
+            while (m_pos < m_text.size()
+                   && (std::isdigit(static_cast<unsigned char>(m_text[m_pos])) != 0 || m_text[m_pos] == '-'
+                       || m_text[m_pos] == '+' || m_text[m_pos] == '.' || m_text[m_pos] == 'e'
+                       || m_text[m_pos] == 'E')) {
+                m_pos++;
+            }
+
+            if (start == m_pos) {
+                return false;
+            }
+
+            const char* first = m_text.data() + start;
+            const char* last  = m_text.data() + m_pos;
+
+            // the integers out of the range are read as doubles
+            std::int64_t integer        = 0;
+            const auto [intEnd, intErr] = std::from_chars(first, last, integer);
+            if (intErr == std::errc() && intEnd == last) {
+                value = Value(integer);
+                return true;
+            }
+
+            double number         = 0;
+            const auto [end, err] = std::from_chars(first, last, number);
+
+            if (err != std::errc() || end != last) {
+                return false;
+            }
+
+            value = Value(number);
+            return true;
+        }
+
+        bool ParseHex4(std::uint32_t& code) {
+            if (m_pos + 4 > m_text.size()) {
+                return false;
+            }
+
+            const auto [end, err] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + 4, code, 16);
+            if (err != std::errc() || end != m_text.data() + m_pos + 4) {
+                return false;
+            }
+
+            m_pos += 4;
+            return true;
+        }
+
+        static void AppendUtf8(std::string& out, std::uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xc0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xe0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else {
+                out += static_cast<char>(0xf0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            }
+        }
+
+        bool ParseString(std::string& out) {
+            if (m_pos == m_text.size() || m_text[m_pos] != '"') {
+                return false;
+            }
+            m_pos++;
+
+            while (m_pos < m_text.size()) {
+                const char character = m_text[m_pos++];
+
+                if (character == '"') {
+                    return true;
+                }
+
+                if (character != '\\') {
+                    out += character;
+                    continue;
+                }
+
+                if (m_pos == m_text.size()) {
+                    return false;
+                }
+
+                switch (m_text[m_pos++]) {
+                case '"':
+                    out += '"';
+                    break;
+                case '\\':
+                    out += '\\';
+                    break;
+                case '/':
+                    out += '/';
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u': {
+                    std::uint32_t code = 0;
+                    if (!ParseHex4(code)) {
+                        return false;
+                    }
+
+                    // surrogate pair
+                    if (code >= 0xd800 && code < 0xdc00 && EatWord("\\u")) {
+                        std::uint32_t low = 0;
+                        if (!ParseHex4(low) || low < 0xdc00 || low >= 0xe000) {
+                            return false;
+                        }
+
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    }
+
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+
+            return false;
+        }
+    };
+
+    void dumpString(std::string& out, std::string_view str) {
+        out += '"';
+
+        for (const char character : str) {
+            switch (character) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(character) < 0x20) {
+                    out += std::format("\\u{:04x}", static_cast<unsigned>(character));
+                } else {
+                    out += character;
+                }
+            }
+        }
+
+        out += '"';
+    }
+
+}
+
+Value Value::Array() {
+    Value value;
+    value.m_kind = Kind::ARRAY;
+    return value;
+}
+
+Value Value::Object() {
+    Value value;
+    value.m_kind = Kind::OBJECT;
+    return value;
+}
+
+const std::string& Value::AsString() const {
+    static const std::string EMPTY;
+    return m_kind == Kind::STRING ? m_string : EMPTY;
+}
+
+const Value& Value::operator[](std::string_view key) const {
+    static const Value NUL;
+
+    if (m_kind != Kind::OBJECT) {
+        return NUL;
+    }
+
+    for (std::size_t i = 0; i < m_keys.size(); i++) {
+        if (m_keys[i] == key) {
+            return m_items[i];
+        }
+    }
+
+    return NUL;
+}
+
+Value& Value::Set(std::string_view key, Value value) {
+    for (std::size_t i = 0; i < m_keys.size(); i++) {
+        if (m_keys[i] == key) {
+            m_items[i] = std::move(value);
+            return *this;
+        }
+    }
+
+    m_keys.emplace_back(key);
+    m_items.push_back(std::move(value));
+    return *this;
+}
+
+Value& Value::Push(Value value) {
+    m_items.push_back(std::move(value));
+    return *this;
+}
+
+std::string Value::Dump() const {
+    std::string out;
+    Dump(out);
+    return out;
+}
+
+void Value::Dump(std::string& out) const {
+    switch (m_kind) {
+    case Kind::NUL:
+        out += "null";
+        break;
+    case Kind::BOOL:
+        out += m_bool ? "true" : "false";
+        break;
+    case Kind::NUMBER:
+        if (m_isInt) {
+            out += std::to_string(m_int);
+        } else {
+            out += std::format("{}", m_number);
+        }
+        break;
+    case Kind::STRING:
+        dumpString(out, m_string);
+        break;
+    case Kind::ARRAY:
+        out += '[';
+        for (std::size_t i = 0; i < m_items.size(); i++) {
+            if (i != 0) {
+                out += ',';
+            }
+            m_items[i].Dump(out);
+        }
+        out += ']';
+        break;
+    case Kind::OBJECT:
+        out += '{';
+        for (std::size_t i = 0; i < m_items.size(); i++) {
+            if (i != 0) {
+                out += ',';
+            }
+            dumpString(out, m_keys[i]);
+            out += ':';
+            m_items[i].Dump(out);
+        }
+        out += '}';
+        break;
+    }
+}
+
+bool Value::Parse(std::string_view text, Value& value) { return Reader(text).ParseDocument(value); }
+
+}
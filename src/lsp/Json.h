@@ -0,0 +1,98 @@
+#ifndef KOOLANG_LSP_JSON_H
+#define KOOLANG_LSP_JSON_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lsp::json {
+
+// JSON value of the protocol messages. Objects keep the order of their keys.
+class Value {
+public:
+    enum class Kind : std::uint8_t {
+        NUL,
+        BOOL,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT,
+    };
+
+    Value() = default;
+    Value(std::nullptr_t) { }
+    Value(bool value)
+        : m_kind(Kind::BOOL)
+        , m_bool(value) { }
+    Value(double value)
+        : m_kind(Kind::NUMBER)
+        , m_number(value) { }
+    Value(int value)
+        : Value(static_cast<std::int64_t>(value)) { }
+    Value(std::uint32_t value)
+        : Value(static_cast<std::int64_t>(value)) { }
+    Value(std::int64_t value)
+        : m_kind(Kind::NUMBER)
+        , m_isInt(true)
+        , m_int(value) { }
+    Value(std::size_t value)
+        : Value(static_cast<std::int64_t>(value)) { }
+    Value(std::string value)
+        : m_kind(Kind::STRING)
+        , m_string(std::move(value)) { }
+    Value(std::string_view value)
+        : Value(std::string(value)) { }
+    Value(const char* value)
+        : Value(std::string(value)) { }
+
+    static Value Array();
+    static Value Object();
+
+    [[nodiscard]] Kind GetKind() const { return m_kind; }
+    [[nodiscard]] bool IsNull() const { return m_kind == Kind::NUL; }
+
+    [[nodiscard]] bool AsBool() const { return m_kind == Kind::BOOL && m_bool; }
+    [[nodiscard]] std::int64_t AsInt() const {
+        if (m_kind != Kind::NUMBER) {
+            return 0;
+        }
+        return m_isInt ? m_int : static_cast<std::int64_t>(m_number);
+    }
+    // Returns an empty string for the other kinds
+    [[nodiscard]] const std::string& AsString() const;
+    // Returns the items of the array, empty for the other kinds
+    [[nodiscard]] const std::vector<Value>& Items() const { return m_items; }
+
+    // Returns the member of the object, null if it doesn't exist
+    [[nodiscard]] const Value& operator[](std::string_view key) const;
+
+    // Sets the member of the object, returns the object
+    Value& Set(std::string_view key, Value value);
+
+    // Appends the item to the array, returns the array
+    Value& Push(Value value);
+
+    [[nodiscard]] std::string Dump() const;
+    void Dump(std::string& out) const;
+
+    // Returns false if the text isn't a valid JSON
+    [[nodiscard]] static bool Parse(std::string_view text, Value& value);
+
+private:
+    Kind m_kind = Kind::NUL;
+    bool m_bool = false;
+    // the integers are kept exact, the other numbers are doubles
+    bool m_isInt       = false;
+    std::int64_t m_int = 0;
+    double m_number    = 0;
+    std::string m_string;
+
+    // items of the array or values of the object
+    std::vector<Value> m_items;
+    std::vector<std::string> m_keys;
+};
+
+}
+
+#endif
@@ -0,0 +1,614 @@
+#include "Server.h"
+#include "ast/Tokenizer.h"
+#include "terminal/globals.h"
+#include <array>
+#include <charconv>
+#include <format>
+#include <thread>
+#include <vector>
+
+namespace lsp {
+
+namespace {
+
+    constexpr std::string_view CONTENT_LENGTH = "Content-Length:";
+
+    // Kinds of the completion items
+    constexpr int KIND_FUNCTION  = 3;
+    constexpr int KIND_INTERFACE = 8;
+    constexpr int KIND_MODULE    = 9;
+    constexpr int KIND_ENUM      = 13;
+    constexpr int KIND_KEYWORD   = 14;
+    constexpr int KIND_CONSTANT  = 21;
+    constexpr int KIND_STRUCT    = 22;
+
+    constexpr std::array<std::string_view, 20> KEYWORDS = {
+        "break", "cast", "const", "continue", "else", "enum", "fn", "for", "if", "impl",
+        "import", "in", "mut", "pub", "return", "static", "struct", "trait", "variant", "while",
+    };
+
+    // Reads one message of the transport, returns false at the end of the input
+    bool readMessage(std::istream& input, std::string& content) {
+        std::size_t length = 0;
+        bool hasLength     = false;
+
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            // the empty line ends the header
+            if (line.empty()) {
+                if (hasLength) {
+                    break;
+                }
+                continue;
+            }
+
+            if (line.starts_with(CONTENT_LENGTH)) {
+                std::string_view value(line);
+                value.remove_prefix(CONTENT_LENGTH.size());
+                while (value.starts_with(' ')) {
+                    value.remove_prefix(1);
+                }
+
+                hasLength = std::from_chars(value.data(), value.data() + value.size(), length).ec == std::errc();
+            }
+        }
+
+        if (!hasLength) {
+            return false;
+        }
+
+        content.resize(length);
+        input.read(content.data(), static_cast<std::streamsize>(length));
+
+        return static_cast<std::size_t>(input.gcount()) == length;
+    }
+
+    ast::TokenList tokenize(File& file) {
+        ast::Tokenizer tokenizer(file);
+        return tokenizer.Tokenize();
+    }
+
+    bool isDeclKeyword(ast::TokenTag tag) {
+        using ast::TokenTag;
+
+        return tag == TokenTag::K_CONST || tag == TokenTag::K_FN || tag == TokenTag::K_STATIC
+            || tag == TokenTag::K_STRUCT || tag == TokenTag::K_ENUM || tag == TokenTag::K_VARIANT
+            || tag == TokenTag::K_TRAIT;
+    }
+
+    // Returns the identifier at the offset, the cursor right after the identifier belongs to it
+    Index findIdent(const ast::TokenList& tokens, std::size_t offset) {
+        for (Index i = 1; i < tokens.TokenTags.size(); i++) {
+            if (tokens.GetTokStart(i) > offset) {
+                break;
+            }
+
+            if (tokens.TokenTags[i] == ast::TokenTag::IDENT && offset <= tokens.GetTokEnd(i)) {
+                return i;
+            }
+        }
+
+        return NULL_INDEX;
+    }
+
+    // Returns the qualifier 'a::b::' ending with the token
+    std::vector<std::string> collectQualifier(const ast::TokenList& tokens, Index last) {
+        std::vector<std::string> path;
+
+        while (last >= 2 && tokens.TokenTags[last] == ast::TokenTag::COLON2
+               && tokens.TokenTags[last - 1] == ast::TokenTag::IDENT) {
+            path.insert(path.begin(), std::string(tokens.GetTokContent(last - 1)));
+            last -= 2;
+        }
+
+        return path;
+    }
+
+    // Returns the namespace of the qualifier seen from the module, MAX_INDEX if it doesn't exist. The first part is
+    // searched in the namespace of the module and then in the root namespace.
+    Index resolveNamespace(air::symbol::SymbolMap& map, const air::Module* mod, const std::vector<std::string>& path) {
+        Index scope = MAX_INDEX;
+
+        for (const Index start : { mod->NamespaceIndex, NULL_INDEX }) {
+            const auto& subNamespaces = map.GetNamespace(start).SubNamespaces;
+            const auto iter           = subNamespaces.find(path.front());
+
+            if (iter != subNamespaces.end()) {
+                scope = iter->second;
+                break;
+            }
+        }
+
+        for (std::size_t i = 1; i < path.size() && scope != MAX_INDEX; i++) {
+            const auto& subNamespaces = map.GetNamespace(scope).SubNamespaces;
+            const auto iter           = subNamespaces.find(path[i]);
+
+            scope = (iter == subNamespaces.end()) ? MAX_INDEX : iter->second;
+        }
+
+        return scope;
+    }
+
+    // Finds the name in the decl of the name, returns false if the content doesn't declare it
+    bool findDeclSite(const std::string& content, std::string_view name, std::size_t& start, std::size_t& end) {
+        File file;
+        file.Content                = content;
+        const ast::TokenList tokens = tokenize(file);
+
+        for (Index i = 2; i < tokens.TokenTags.size(); i++) {
+            if (tokens.TokenTags[i] == ast::TokenTag::IDENT && isDeclKeyword(tokens.TokenTags[i - 1])
+                && tokens.GetTokContent(i) == name) {
+                start = tokens.GetTokStart(i);
+                end   = tokens.GetTokEnd(i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    json::Value location(const std::filesystem::path& path, std::string_view text, std::size_t start, std::size_t end) {
+        return json::Value::Object().Set("uri", pathToUri(path)).Set("range", dumpRange(text, start, end));
+    }
+
+    int completionKind(const air::symbol::Record* rec) {
+        switch (rec->Kind) {
+        case kir::InstType::DECL_FN:
+            return KIND_FUNCTION;
+        case kir::InstType::DECL_STRUCT:
+            return KIND_STRUCT;
+        case kir::InstType::DECL_ENUM:
+        case kir::InstType::DECL_VARIANT:
+            return KIND_ENUM;
+        case kir::InstType::DECL_TRAIT:
+            return KIND_INTERFACE;
+        default:
+            return KIND_CONSTANT;
+        }
+    }
+
+    json::Value completionItem(std::string_view label, int kind) {
+        return json::Value::Object().Set("label", label).Set("kind", kind);
+    }
+
+    // Adds the decls and the modules of the namespace
+    void addNamespaceItems(json::Value& items, const air::symbol::Namespace& scope) {
+        for (const auto& [name, rec] : scope.Decls) {
+            items.Push(completionItem(name, completionKind(rec)));
+        }
+
+        for (const auto& [name, index] : scope.SubNamespaces) {
+            items.Push(completionItem(name, KIND_MODULE));
+        }
+    }
+
+}
+
+Server::Server(std::istream& input, std::ostream& output)
+    : m_input(input)
+    , m_output(output)
+    , m_hasCacheDir(!globals::g_config.CacheDir.empty()) { }
+
+int Server::Run() {
+    std::thread reader(&Server::ReadLoop, this);
+
+    int code = 1;
+    json::Value message;
+
+    while (true) {
+        // the diagnostics are computed only when no message is waiting
+        if (!Pop(message, false)) {
+            AnalyzeDirty();
+
+            if (!Pop(message, true)) {
+                break;
+            }
+        }
+
+        if (!Handle(message)) {
+            code = m_shutdown ? 0 : 1;
+            break;
+        }
+    }
+
+    reader.join();
+    return code;
+}
+
+void Server::ReadLoop() {
+    std::string content;
+
+    while (readMessage(m_input, content)) {
+        json::Value message;
+        if (!json::Value::Parse(content, message)) {
+            continue;
+        }
+
+        const std::string& method = message["method"].AsString();
+
+        if (method == "$/cancelRequest") {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled.insert(message["params"]["id"].Dump());
+            continue;
+        }
+
+        // the running analysis is stale now
+        if (method.starts_with("textDocument/did")) {
+            m_generation++;
+        }
+
+        const bool isExit = method == "exit";
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(message));
+        }
+        m_queueCV.notify_one();
+
+        if (isExit) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inputClosed = true;
+    m_queueCV.notify_one();
+}
+
+bool Server::Pop(json::Value& message, bool wait) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (wait) {
+        m_queueCV.wait(lock, [this]() -> bool { return !m_queue.empty() || m_inputClosed; });
+    }
+
+    if (m_queue.empty()) {
+        return false;
+    }
+
+    message = std::move(m_queue.front());
+    m_queue.pop_front();
+    return true;
+}
+
+bool Server::Handle(const json::Value& message) {
+    const std::string& method = message["method"].AsString();
+    const json::Value& id     = message["id"];
+    const json::Value& params = message["params"];
+
+    // responses of the client
+    if (method.empty()) {
+        return true;
+    }
+
+    if (!id.IsNull()) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_cancelled.erase(id.Dump()) != 0) {
+            lock.unlock();
+            ReplyError(id, REQUEST_CANCELLED, "Request cancelled");
+            return true;
+        }
+    }
+
+    if (method == "initialize") {
+        Reply(id, Initialize());
+    } else if (method == "shutdown") {
+        m_shutdown = true;
+        Reply(id, nullptr);
+    } else if (method == "exit") {
+        return false;
+    } else if (method == "textDocument/didOpen") {
+        DidOpen(params);
+    } else if (method == "textDocument/didChange") {
+        DidChange(params);
+    } else if (method == "textDocument/didClose") {
+        DidClose(params);
+    } else if (method == "textDocument/definition") {
+        Reply(id, Definition(params));
+    } else if (method == "textDocument/completion") {
+        Reply(id, Completion(params));
+    } else if (!id.IsNull()) {
+        ReplyError(id, METHOD_NOT_FOUND, std::format("Unknown method '{}'", method));
+    }
+
+    return true;
+}
+
+void Server::Send(const json::Value& message) {
+    const std::string content = message.Dump();
+
+    m_output << CONTENT_LENGTH << ' ' << content.size() << "\r\n\r\n" << content;
+    m_output.flush();
+}
+
+void Server::Reply(const json::Value& id, json::Value result) {
+    Send(json::Value::Object().Set("jsonrpc", "2.0").Set("id", id).Set("result", std::move(result)));
+}
+
+void Server::ReplyError(const json::Value& id, int code, std::string_view message) {
+    const json::Value error = json::Value::Object().Set("code", code).Set("message", message);
+    Send(json::Value::Object().Set("jsonrpc", "2.0").Set("id", id).Set("error", error));
+}
+
+void Server::Notify(std::string_view method, json::Value params) {
+    Send(json::Value::Object().Set("jsonrpc", "2.0").Set("method", method).Set("params", std::move(params)));
+}
+
+json::Value Server::Initialize() const {
+    // incremental sync
+    const json::Value sync = json::Value::Object().Set("openClose", true).Set("change", 2);
+    const json::Value completion
+        = json::Value::Object().Set("triggerCharacters", json::Value::Array().Push(":"));
+
+    const json::Value capabilities = json::Value::Object()
+                                         .Set("textDocumentSync", sync)
+                                         .Set("definitionProvider", true)
+                                         .Set("completionProvider", completion);
+
+    return json::Value::Object()
+        .Set("capabilities", capabilities)
+        .Set("serverInfo", json::Value::Object().Set("name", "koolang").Set("version", VERSION));
+}
+
+void Server::DidOpen(const json::Value& params) {
+    const json::Value& item = params["textDocument"];
+
+    Document doc {
+        .Uri     = item["uri"].AsString(),
+        .Path    = uriToPath(item["uri"].AsString()),
+        .Text    = item["text"].AsString(),
+        .Version = item["version"].AsInt(),
+        .IsDirty = true,
+    };
+
+    if (!doc.Path.empty()) {
+        m_sources[doc.Path.string()] = doc.Text;
+    }
+
+    m_documents[doc.Uri] = std::move(doc);
+}
+
+void Server::DidChange(const json::Value& params) {
+    const json::Value& item = params["textDocument"];
+
+    const auto iter = m_documents.find(item["uri"].AsString());
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    Document& doc = iter->second;
+    for (const auto& change : params["contentChanges"].Items()) {
+        doc.ApplyChange(change);
+    }
+
+    doc.Version = item["version"].AsInt();
+    doc.IsDirty = true;
+
+    if (!doc.Path.empty()) {
+        m_sources[doc.Path.string()] = doc.Text;
+    }
+}
+
+void Server::DidClose(const json::Value& params) {
+    const std::string& uri = params["textDocument"]["uri"].AsString();
+
+    const auto iter = m_documents.find(uri);
+    if (iter == m_documents.end()) {
+        return;
+    }
+
+    m_sources.erase(iter->second.Path.string());
+    m_documents.erase(iter);
+
+    Notify(
+        "textDocument/publishDiagnostics",
+        json::Value::Object().Set("uri", uri).Set("diagnostics", json::Value::Array())
+    );
+}
+
+Document* Server::GetAnalyzed(const json::Value& params) {
+    const auto iter = m_documents.find(params["textDocument"]["uri"].AsString());
+    if (iter == m_documents.end()) {
+        return nullptr;
+    }
+
+    // the request is answered for the text it was sent for, the later edits are still queued
+    Document& doc = iter->second;
+    if (doc.IsDirty) {
+        Analyze(doc, false);
+    }
+
+    // the symbols of the last analysis without errors are used while the document doesn't parse
+    if (!m_manager || m_analyzedUri != doc.Uri) {
+        return nullptr;
+    }
+
+    return &doc;
+}
+
+json::Value Server::Definition(const json::Value& params) {
+    Document* doc = GetAnalyzed(params);
+    if (isNull(doc)) {
+        return nullptr;
+    }
+
+    File file;
+    file.Content                = doc->Text;
+    const ast::TokenList tokens = tokenize(file);
+
+    const Index tok = findIdent(tokens, toOffset(doc->Text, parsePosition(params["position"])));
+    if (isNull(tok)) {
+        return nullptr;
+    }
+
+    const std::string name(tokens.GetTokContent(tok));
+    const auto qualifier = collectQualifier(tokens, tok - 1);
+
+    auto& map         = m_manager->Map;
+    const Index scope = qualifier.empty() ? m_module->NamespaceIndex : resolveNamespace(map, m_module, qualifier);
+    if (scope == MAX_INDEX) {
+        return nullptr;
+    }
+
+    const auto& decls = map.GetNamespace(scope).Decls;
+    if (const auto decl = decls.find(name); decl != decls.end()) {
+        const air::Module* mod = decl->second->Mod;
+
+        // the modules release their sources, the database keeps them
+        const auto content = m_database.GetContent(mod->SystemPath.lexically_normal().string());
+        if (isNull(content.get())) {
+            return nullptr;
+        }
+
+        std::size_t start = 0;
+        std::size_t end   = 0;
+        if (!findDeclSite(*content, name, start, end)) {
+            return nullptr;
+        }
+
+        return location(mod->SystemPath, *content, start, end);
+    }
+
+    // the name of the imported module goes to its file
+    std::vector<std::string> path = qualifier;
+    path.push_back(name);
+
+    const Index import = resolveNamespace(map, m_module, path);
+    if (import == MAX_INDEX || isNull(map.GetNamespace(import).Mod)) {
+        return nullptr;
+    }
+
+    return location(map.GetNamespace(import).Mod->SystemPath, {}, 0, 0);
+}
+
+json::Value Server::Completion(const json::Value& params) {
+    json::Value items = json::Value::Array();
+
+    Document* doc = GetAnalyzed(params);
+    if (isNull(doc)) {
+        return items;
+    }
+
+    File file;
+    file.Content                = doc->Text;
+    const ast::TokenList tokens = tokenize(file);
+    const std::size_t offset    = toOffset(doc->Text, parsePosition(params["position"]));
+
+    // the last token before the cursor, the identifier being typed is skipped
+    Index last = 0;
+    for (Index i = 1; i < tokens.TokenTags.size() && tokens.GetTokStart(i) < offset; i++) {
+        last = i;
+    }
+
+    if (tokens.TokenTags[last] == ast::TokenTag::IDENT && offset <= tokens.GetTokEnd(last)) {
+        last--;
+    }
+
+    auto& map            = m_manager->Map;
+    const auto qualifier = collectQualifier(tokens, last);
+
+    if (!qualifier.empty()) {
+        const Index scope = resolveNamespace(map, m_module, qualifier);
+        if (scope != MAX_INDEX) {
+            addNamespaceItems(items, map.GetNamespace(scope));
+        }
+
+        return items;
+    }
+
+    addNamespaceItems(items, map.GetNamespace(m_module->NamespaceIndex));
+
+    // modules imported from the import paths
+    for (const auto& [name, index] : map.GetNamespace(NULL_INDEX).SubNamespaces) {
+        if (index != m_module->NamespaceIndex) {
+            items.Push(completionItem(name, KIND_MODULE));
+        }
+    }
+
+    for (const auto keyword : KEYWORDS) {
+        items.Push(completionItem(keyword, KIND_KEYWORD));
+    }
+
+    return items;
+}
+
+bool Server::Analyze(Document& doc, bool isCancellable) {
+    const std::uint64_t generation = m_generation.load();
+
+    if (doc.Path.empty()) {
+        doc.IsDirty = false;
+        return true;
+    }
+
+    globals::g_config.InputFile  = doc.Path.string();
+    globals::g_config.WorkingDir = doc.Path.parent_path();
+    if (!m_hasCacheDir) {
+        globals::g_config.CacheDir = globals::g_config.WorkingDir / ".koolang-cache";
+    }
+
+    auto manager = std::make_unique<air::ModuleManager>(&m_database);
+    manager->SetSources(&m_sources);
+
+    air::Module* mod = manager->GenZir();
+
+    // the document is analyzed again after the newer edit
+    if (isCancellable && m_generation.load() != generation) {
+        return false;
+    }
+
+    doc.IsDirty = false;
+    PublishDiagnostics(doc, mod);
+
+    if (!isNull(mod) && mod->CompStatus == air::Module::Status::PREPARED) {
+        m_manager     = std::move(manager);
+        m_module      = mod;
+        m_analyzedUri = doc.Uri;
+    }
+
+    return true;
+}
+
+void Server::AnalyzeDirty() {
+    for (auto& [uri, doc] : m_documents) {
+        if (doc.IsDirty && !Analyze(doc, true)) {
+            return;
+        }
+    }
+}
+
+void Server::PublishDiagnostics(const Document& doc, const air::Module* mod) {
+    json::Value diagnostics = json::Value::Array();
+
+    if (!isNull(mod)) {
+        for (const auto* records : { &mod->FileData.ErrMsgs, &mod->FileData.WarnMsgs }) {
+            for (const auto& record : *records) {
+                const auto& label = record.GetLabel();
+
+                std::string message(record.GetMsg());
+                if (!label.Msg.empty()) {
+                    message += ": " + label.Msg;
+                }
+
+                const bool isErr = record.GetKind() == logger::RecordKind::ERR;
+
+                diagnostics.Push(json::Value::Object()
+                                     .Set("range", dumpRange(doc.Text, label.StrRange.Start, label.StrRange.End))
+                                     .Set("severity", isErr ? 1 : 2)
+                                     .Set("code", std::format("{}{:03}", isErr ? 'E' : 'W', record.GetCode()))
+                                     .Set("source", "koolang")
+                                     .Set("message", message));
+            }
+        }
+    }
+
+    Notify(
+        "textDocument/publishDiagnostics",
+        json::Value::Object().Set("uri", doc.Uri).Set("version", doc.Version).Set("diagnostics", diagnostics)
+    );
+}
+
+}
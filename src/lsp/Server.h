@@ -0,0 +1,95 @@
+#ifndef KOOLANG_LSP_SERVER_H
+#define KOOLANG_LSP_SERVER_H
+
+#include "Document.h"
+#include "Json.h"
+#include "air/ModuleManager.h"
+#include "query/Database.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lsp {
+
+// Language server over the stdio transport. The documents are synced incrementally and the open documents replace the
+// files on disk. Only the edited module is tokenized and parsed again, the KIR of the other modules stays in memory.
+//
+// The messages are read on a separate thread. The diagnostics are computed when no message is waiting, and the
+// analysis is cancelled when a newer edit arrives in the meantime.
+class Server {
+public:
+    Server(std::istream& input, std::ostream& output);
+
+    // Serves until the exit notification or the end of the input, returns the exit code
+    int Run();
+
+private:
+    // Error codes of the protocol
+    static constexpr int METHOD_NOT_FOUND  = -32601;
+    static constexpr int INVALID_PARAMS    = -32602;
+    static constexpr int REQUEST_CANCELLED = -32800;
+
+    std::istream& m_input;
+    std::ostream& m_output;
+
+    // shared with the reader thread
+    std::mutex m_mutex;
+    std::condition_variable m_queueCV;
+    std::deque<json::Value> m_queue;
+    std::unordered_set<std::string> m_cancelled;
+    bool m_inputClosed = false;
+
+    // incremented by the reader for every edit, the analysis started before the edit is stale
+    std::atomic<std::uint64_t> m_generation = 0;
+
+    std::unordered_map<std::string, Document> m_documents;
+    // texts of the open documents by their paths
+    std::unordered_map<std::string, std::string> m_sources;
+    query::Database m_database;
+    bool m_hasCacheDir;
+
+    // the last successful analysis
+    std::unique_ptr<air::ModuleManager> m_manager;
+    air::Module* m_module = nullptr;
+    std::string m_analyzedUri;
+
+    bool m_shutdown = false;
+
+    void ReadLoop();
+    bool Pop(json::Value& message, bool wait);
+
+    // Returns false after the exit notification
+    bool Handle(const json::Value& message);
+
+    void Send(const json::Value& message);
+    void Reply(const json::Value& id, json::Value result);
+    void ReplyError(const json::Value& id, int code, std::string_view message);
+    void Notify(std::string_view method, json::Value params);
+
+    void DidOpen(const json::Value& params);
+    void DidChange(const json::Value& params);
+    void DidClose(const json::Value& params);
+
+    [[nodiscard]] json::Value Initialize() const;
+    json::Value Definition(const json::Value& params);
+    json::Value Completion(const json::Value& params);
+
+    // Returns the analyzed document or nullptr
+    Document* GetAnalyzed(const json::Value& params);
+
+    // Returns false if a newer edit cancelled the analysis
+    bool Analyze(Document& doc, bool isCancellable);
+    void AnalyzeDirty();
+    void PublishDiagnostics(const Document& doc, const air::Module* mod);
+};
+
+}
+
+#endif
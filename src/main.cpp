@@ -1,14 +1,204 @@
+#include "air/ModuleInterface.h"
 #include "air/ModuleManager.h"
+#include "air/Printer.h"
+#include "air/pass/PassManager.h"
+#include "codegen/CodeGen.h"
+#include "codegen/c/CBackend.h"
+#include "query/Database.h"
 #include "kir/Printer.h"
+#include "logger/Stats.h"
+#include "logger/Trace.h"
+#include "lsp/Server.h"
+#include "server/Server.h"
 #include "terminal/globals.h"
 #include "terminal/terminal.h"
+#include "util/Jobserver.h"
 #include <iostream>
 #include <iterator>
 
 constexpr int RET_OK  = 0;
 constexpr int RET_ERR = 1;
 
+air::pass::OptLevel getOptLevel(globals::Config::Options flags) {
+    using globals::Config;
+
+    if ((flags & Config::OPTIMAZE_2) != 0) {
+        return air::pass::OptLevel::O2;
+    } else if ((flags & Config::OPTIMAZE_1) != 0) {
+        return air::pass::OptLevel::O1;
+    } else if ((flags & Config::OPTIMAZE_S) != 0) {
+        return air::pass::OptLevel::OS;
+    }
+
+    return air::pass::OptLevel::O0;
+}
+
+// Runs one compilation, the loaded sources are returned for the long-running modes
+server::BuildResult build(query::Database* database) {
+    server::BuildResult result { .Code = RET_ERR, .Sources = {} };
+
+    // every build of the server counts its own errors
+    logger::g_errorCount = 0;
+
+    air::ModuleManager manager(database);
+
+    air::Module* mainModule = nullptr;
+    {
+        logger::stats::Phase phase("gen zir");
+        mainModule = manager.GenZir();
+    }
+
+    for (const auto& mod : manager.GetModules()) {
+        result.Sources.push_back(mod->SystemPath);
+    }
+
+    if (mainModule->CompStatus == air::Module::Status::ERROR) {
+        return result;
+    }
+
+    {
+        logger::stats::Phase phase("gen air");
+        manager.GenAir(mainModule);
+    }
+
+    air::pass::PassManager passes(
+        manager.InternPool,
+        air::pass::PassManager::CollectUnits(manager),
+        air::pass::PassManager::GetPipeline(getOptLevel(globals::g_config.Flags))
+    );
+    {
+        logger::stats::Phase phase("passes");
+        passes.Run();
+    }
+
+    // the data structures are complete, the backends only read them
+    if (logger::stats::g_enabled) {
+        manager.ReportStats();
+    }
+
+    // the AIR is printed as the backends see it
+    if ((globals::g_config.Flags & globals::Config::DEBUG_MODE) != 0) {
+        for (const auto& mod : manager.GetModules()) {
+            for (const auto& sema : mod->Semas) {
+                if (sema.GetRecord()->StatusBody == air::symbol::Record::State::COMPLETE) {
+                    air::Printer(&sema).Print();
+                }
+            }
+        }
+
+        passes.PrintStats(std::cout);
+    }
+
+    if (globals::g_config.Command != globals::Config::Command::BUILD_BIN) {
+        if (logger::g_errorCount != 0) {
+            std::cout << "ERROR: Analysis failed with " << logger::g_errorCount << " errors" << std::endl;
+            return result;
+        }
+
+        if (!air::kmi::write(mainModule, manager.InternPool)) {
+            KOOLANG_WARN_MSG("Cannot write the interface of '{}'", mainModule->FileData.Filepath);
+        }
+
+        result.Code = RET_OK;
+        return result;
+    }
+
+    // the binary would run with the wrong values of the decls which failed
+    if (logger::g_errorCount != 0) {
+        std::cout << "ERROR: Analysis failed with " << logger::g_errorCount << " errors" << std::endl;
+        return result;
+    }
+
+    if ((globals::g_config.Flags & globals::Config::TARGET_X86) != 0) {
+        std::cout << "ERROR: Target x86 is not supported yet" << std::endl;
+        return result;
+    }
+
+    std::filesystem::path output = globals::g_config.OutputFile;
+    if (output.empty()) {
+        output = std::filesystem::path(globals::g_config.InputFile).stem();
+    }
+
+    // optimized builds go through the C compiler
+    if ((globals::g_config.Flags & globals::Config::OPTIMAZE_2) != 0) {
+        std::filesystem::path buildDir = output;
+        buildDir += ".build";
+
+        logger::stats::Phase phase("c backend");
+        codegen::c::CBackend backend(manager, mainModule, buildDir);
+
+        if (!backend.Build()) {
+            std::cout << "ERROR: C compilation failed" << std::endl;
+            return result;
+        }
+
+        if (!backend.Link(output)) {
+            std::cout << "ERROR: Linking failed" << std::endl;
+            return result;
+        }
+
+        result.Code = RET_OK;
+        return result;
+    }
+
+    std::filesystem::path object = output;
+    object += ".o";
+
+    logger::stats::Phase phase("codegen");
+    codegen::CodeGen gen(manager, mainModule);
+    if (!gen.Generate()) {
+        std::cout << "ERROR: Code generation failed" << std::endl;
+        return result;
+    }
+
+    if (!gen.WriteObject(object)) {
+        std::cout << "ERROR: Cannot write object file '" << object.string() << '\'' << std::endl;
+        return result;
+    }
+
+    if (!codegen::CodeGen::Link(object, output)) {
+        std::cout << "ERROR: Linking failed" << std::endl;
+        return result;
+    }
+
+    result.Code = RET_OK;
+    return result;
+}
+
+// Runs the build and reports the time and memory of its phases if requested
+server::BuildResult buildProfiled(query::Database* database) {
+    if (!logger::trace::g_enabled && !logger::stats::g_enabled) {
+        return build(database);
+    }
+
+    logger::trace::clear();
+    logger::stats::clear();
+
+    server::BuildResult result { .Code = RET_ERR, .Sources = {} };
+    {
+        logger::trace::Scope scope("build");
+        result = build(database);
+    }
+
+    if ((globals::g_config.Flags & globals::Config::TIME_REPORT) != 0) {
+        logger::trace::printReport(std::cerr);
+    }
+
+    if ((globals::g_config.Flags & globals::Config::STATS) != 0) {
+        logger::stats::printReport(std::cerr);
+    }
+
+    const std::filesystem::path& tracePath = globals::g_config.TracePath;
+    if (!tracePath.empty() && !logger::trace::writeChromeTrace(tracePath)) {
+        std::cout << "ERROR: Cannot write the trace file '" << tracePath.string() << '\'' << std::endl;
+    }
+
+    return result;
+}
+
 int main(int argc, char* argv[]) {
+    using globals::Config;
+
     if (argc == 1) {
         terminal::printUsage();
         return RET_OK;
@@ -18,10 +208,24 @@ int main(int argc, char* argv[]) {
         return RET_ERR;
     }
 
-    air::ModuleManager manager;
+    // before any thread pool is created
+    jobs::init(globals::g_config.Jobs);
+
+    if (globals::g_config.Command == Config::Command::LSP) {
+        // stdout carries the protocol, the messages of the compiler go to stderr
+        std::ostream protocol(std::cout.rdbuf());
+        std::cout.rdbuf(std::cerr.rdbuf());
+
+        lsp::Server server(std::cin, protocol);
+        const int code = server.Run();
+
+        std::cout.rdbuf(protocol.rdbuf());
+        return code;
+    }
+
+    if (globals::g_config.Command == Config::Command::SHOW_KIR) {
+        air::ModuleManager manager;
 
-    switch (globals::g_config.Command) {
-    case globals::Config::Command::SHOW_KIR: {
         // Manualy create module
         std::unique_ptr<air::Module> mod
             = std::make_unique<air::Module>(globals::g_config.InputFile, manager.Map, manager.InternPool);
@@ -31,23 +235,39 @@ int main(int argc, char* argv[]) {
         // fill the module field Kir
         air::ModuleManager::GenZirJob(context);
 
-        kir::Printer(mod->Kir).Print();
+        // the errors were already reported
+        if (mod->CompStatus == air::Module::Status::ERROR || mod->Kir == nullptr) {
+            return RET_ERR;
+        }
+
+        kir::Printer(*mod->Kir).Print();
         return RET_OK;
     }
-    default:
-        break;
+
+    logger::trace::g_enabled
+        = (globals::g_config.Flags & Config::TIME_REPORT) != 0 || !globals::g_config.TracePath.empty();
+    if (logger::trace::g_enabled) {
+        logger::trace::nameThread("main");
     }
+    logger::stats::g_enabled = (globals::g_config.Flags & Config::STATS) != 0;
 
-    air::Module* mainModule = manager.GenZir();
+    const std::filesystem::path socketPath = server::getSocketPath(globals::g_config.CacheDir);
 
-    if (mainModule->CompStatus == air::Module::Status::ERROR) {
-        return RET_ERR;
+    if ((globals::g_config.Flags & Config::CONNECT) != 0) {
+        return server::connect(socketPath, "build");
     }
 
-    manager.GenAir();
+    // the long-running modes keep the KIR of the unchanged files between the builds
+    if ((globals::g_config.Flags & (Config::WATCH | Config::SERVE)) != 0) {
+        query::Database database;
+        const auto buildWarm = [&database]() { return buildProfiled(&database); };
 
-    // TODO:
-    KOOLANG_TODO();
+        if ((globals::g_config.Flags & Config::WATCH) != 0) {
+            return server::watch(buildWarm);
+        }
+
+        return server::serve(buildWarm, socketPath);
+    }
 
-    return RET_OK;
+    return buildProfiled(nullptr).Code;
 }
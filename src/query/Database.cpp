@@ -0,0 +1,376 @@
+#include "Database.h"
+#include "ast/Parser.h"
+#include "ast/Tokenizer.h"
+#include "kir/AstGen.h"
+#include "kir/Cache.h"
+#include "logger/Stats.h"
+#include "logger/Trace.h"
+#include "terminal/globals.h"
+#include "util/alias.h"
+#include "util/hash_combine.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace query {
+
+namespace {
+
+    // file of the computed query, receives the messages
+    thread_local File* t_file = nullptr;
+
+    // analysis of the build which reads the signature
+    thread_local Analyzer* t_analyzer = nullptr;
+
+    std::uint64_t identity(const std::uint64_t& value) { return value; }
+
+    bool hasMessages(const File& file) { return !file.ErrMsgs.empty() || !file.WarnMsgs.empty(); }
+
+    // The ast is freed after AstGen, so the report shows the sum of the parsed files
+    void reportAstStats(const ast::Ast& ast) {
+        logger::stats::addVector("ast", "node tags", ast.NodeTags);
+        logger::stats::addVector("ast", "node tokens", ast.NodeTokens);
+        logger::stats::addVector("ast", "nodes", ast.Nodes);
+        logger::stats::addVector("ast", "meta", ast.Meta);
+        logger::stats::addVector("ast", "imports", ast.Imports);
+        logger::stats::addVector("ast", "top", ast.Top);
+        logger::stats::addVector("ast", "top hashes", ast.TopHashes);
+        logger::stats::addVector("ast", "token tags", ast.Tokens.TokenTags);
+        logger::stats::addVector("ast", "token locs", ast.Tokens.TokenLocs);
+    }
+
+    template <typename Type> std::size_t bytesOf(const std::vector<Type>& vec) { return vec.capacity() * sizeof(Type); }
+
+    std::size_t bytesOf(const ast::TokenList& tokens) { return bytesOf(tokens.TokenTags) + bytesOf(tokens.TokenLocs); }
+
+    std::size_t bytesOf(const ast::Ast& ast) {
+        return bytesOf(ast.NodeTags) + bytesOf(ast.NodeTokens) + bytesOf(ast.Nodes) + bytesOf(ast.Meta)
+             + bytesOf(ast.Imports) + bytesOf(ast.Top) + bytesOf(ast.TopHashes) + bytesOf(ast.Tokens);
+    }
+
+    std::size_t bytesOf(const kir::Kir& kir) {
+        std::size_t bytes = bytesOf(kir.Inst) + bytesOf(kir.Type) + bytesOf(kir.Extra) + bytesOf(kir.Strings)
+                          + bytesOf(kir.Imports) + bytesOf(kir.ImportAliases) + bytesOf(kir.DeclHashes);
+
+        for (const std::string& str : kir.Strings) {
+            bytes += str.size();
+        }
+
+        return bytes;
+    }
+
+    // Position relative to the token, the cached KIR is shared by the sources which differ in whitespace. The
+    // positions between the tokens move to the end of the previous token.
+    struct TokenPos {
+        std::uint32_t Tok    = 0;
+        std::uint32_t Offset = 0;
+    };
+
+    TokenPos toTokenPos(const ast::TokenList& tokens, std::size_t pos) {
+        const auto& locs = tokens.TokenLocs;
+        const auto next  = std::upper_bound(
+            locs.begin(), locs.end(), pos, [](std::size_t value, const ast::TokenLoc& loc) { return value < loc.Start; }
+        );
+
+        if (next == locs.begin()) {
+            return {};
+        }
+
+        const auto tok    = static_cast<std::size_t>(std::distance(locs.begin(), next) - 1);
+        const auto offset = std::min<std::size_t>(pos - locs[tok].Start, locs[tok].Len);
+
+        return { static_cast<std::uint32_t>(tok), static_cast<std::uint32_t>(offset) };
+    }
+
+    template <typename T> void encodeValue(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void encodeRecord(std::string& out, const logger::Record& record, const ast::TokenList& tokens) {
+        const logger::Label& label = record.GetLabel();
+        const TokenPos start       = toTokenPos(tokens, label.StrRange.Start);
+        const TokenPos end         = toTokenPos(tokens, label.StrRange.End);
+
+        encodeValue(out, static_cast<std::uint8_t>(record.GetKind()));
+        encodeValue(out, record.GetCode());
+        encodeValue(out, static_cast<std::uint8_t>(label.Fg.Code));
+        encodeValue(out, start);
+        encodeValue(out, end);
+        encodeValue(out, static_cast<std::uint32_t>(record.GetMsg().size()));
+        out.append(record.GetMsg());
+        encodeValue(out, static_cast<std::uint32_t>(label.Msg.size()));
+        out.append(label.Msg);
+    }
+
+    // Returns the warnings and the infos added to the file since the counts were taken
+    std::string encodeMessages(
+        const File& file, std::size_t warnCount, std::size_t otherCount, const ast::TokenList& tokens
+    ) {
+        std::string out;
+
+        for (std::size_t i = warnCount; i < file.WarnMsgs.size(); i++) {
+            encodeRecord(out, file.WarnMsgs[i], tokens);
+        }
+
+        for (std::size_t i = otherCount; i < file.OtherMsgs.size(); i++) {
+            encodeRecord(out, file.OtherMsgs[i], tokens);
+        }
+
+        return out;
+    }
+
+    class MessageDecoder {
+    public:
+        explicit MessageDecoder(std::string_view data)
+            : m_data(data) { }
+
+        [[nodiscard]] bool IsEmpty() const { return m_data.empty(); }
+
+        template <typename T> bool Value(T& value) {
+            if (m_data.size() < sizeof(T)) {
+                return false;
+            }
+
+            std::memcpy(&value, m_data.data(), sizeof(T));
+            m_data.remove_prefix(sizeof(T));
+            return true;
+        }
+
+        bool String(std::string_view& str) {
+            std::uint32_t size = 0;
+            if (!Value(size) || m_data.size() < size) {
+                return false;
+            }
+
+            str = m_data.substr(0, size);
+            m_data.remove_prefix(size);
+            return true;
+        }
+
+    private:
+        std::string_view m_data;
+    };
+
+    // Adds the cached messages to the file, returns false and adds nothing if they are damaged
+    bool replayMessages(std::string_view data, const ast::TokenList& tokens, File& file) {
+        std::vector<logger::Record> records;
+        MessageDecoder decoder(data);
+
+        const auto position = [&](const TokenPos& pos, std::size_t& out) {
+            if (pos.Tok >= tokens.TokenLocs.size()) {
+                return tokens.TokenLocs.empty() && pos.Tok == 0 && pos.Offset == 0;
+            }
+
+            out = tokens.TokenLocs[pos.Tok].Start + pos.Offset;
+            return true;
+        };
+
+        while (!decoder.IsEmpty()) {
+            std::uint8_t kind  = 0;
+            std::uint16_t code = 0;
+            std::uint8_t color = 0;
+            TokenPos start;
+            TokenPos end;
+            std::string_view msg;
+            std::string_view labelMsg;
+
+            if (!decoder.Value(kind) || !decoder.Value(code) || !decoder.Value(color) || !decoder.Value(start)
+                || !decoder.Value(end) || !decoder.String(msg) || !decoder.String(labelMsg)) {
+                return false;
+            }
+
+            const auto recordKind = static_cast<logger::RecordKind>(kind);
+            if (recordKind != logger::RecordKind::WARN && recordKind != logger::RecordKind::INFO) {
+                return false;
+            }
+
+            logger::Range range;
+            if (!position(start, range.Start) || !position(end, range.End)) {
+                return false;
+            }
+
+            const auto fg = logger::Color(static_cast<logger::Color::ColorCode>(color));
+            records.emplace_back(recordKind, &file, code, msg, logger::Label(labelMsg, range).WithColor(fg));
+        }
+
+        for (auto& record : records) {
+            file.AddMsg(std::move(record));
+        }
+
+        return true;
+    }
+
+}
+
+Database::Database()
+    : m_content(m_engine, [](const std::string& content) { return std::hash<std::string_view> {}(content); })
+    , m_tokens(
+          m_engine, [this](const std::string& path) { return ComputeTokens(path); },
+          [](const ast::TokenList& tokens) { return tokens.Hash; }
+      )
+    , m_kir(
+          m_engine, [this](const std::string& path) { return ComputeKir(path); },
+          [](const Unit& unit) { return unit.IsValid ? unit.TokensHash : 0; }
+      )
+    , m_decls(m_engine, identity)
+    , m_scopes(m_engine, identity)
+    , m_signatures(m_engine, [this](const DeclKey& decl) { return ComputeSignature(decl); }, identity) { }
+
+std::size_t DeclKeyHash::operator()(const DeclKey& key) const {
+    std::size_t seed = 0;
+    hash_combine(seed, key.Path, key.Name);
+    return seed;
+}
+
+void Database::SetContent(const std::string& path, std::string content) { m_content.Set(path, std::move(content)); }
+
+void Database::Forget(const std::string& path) {
+    m_kir.Forget(path);
+    m_tokens.Forget(path);
+    m_content.Forget(path);
+}
+
+std::shared_ptr<const Unit> Database::GetKir(const std::string& path, File& file) {
+    File* const previous = std::exchange(t_file, &file);
+    auto unit            = m_kir.Get(path);
+    t_file               = previous;
+
+    return unit;
+}
+
+std::uint64_t Database::GetSignature(const DeclKey& decl, Analyzer& analyzer) {
+    Analyzer* const previous = std::exchange(t_analyzer, &analyzer);
+    const auto signature     = m_signatures.Get(decl);
+    t_analyzer               = previous;
+
+    return *signature;
+}
+
+ast::TokenList Database::ComputeTokens(const std::string& path) {
+    File& file = *t_file;
+
+    // the file has the content of the input, it's read for the dependency
+    DISCARD_VALUE(m_content.Get(path));
+
+    ast::TokenList tokens;
+    {
+        logger::trace::Scope scope("tokenize", file.Filepath);
+        ast::Tokenizer tokenizer(file);
+        tokens = tokenizer.Tokenize();
+    }
+
+    // the view would outlive the file
+    tokens.Code = {};
+
+    if (hasMessages(file)) {
+        markVolatile();
+    }
+
+    return tokens;
+}
+
+Unit Database::ComputeKir(const std::string& path) {
+    File& file = *t_file;
+
+    // the tokens are valid for the content of the file, the KIR is their only reader, so they are moved out of the memo
+    ast::TokenList tokens = m_tokens.Take(path);
+    tokens.Code           = file.Content;
+
+    Unit unit { .Kir = {}, .TokensHash = tokens.Hash, .IsValid = false, .Footprint = 0, .KirBytes = 0 };
+    unit.Footprint = file.Content.size() + bytesOf(tokens);
+
+    const bool useCache     = (globals::g_config.Flags & globals::Config::NO_CACHE) == 0;
+    const std::uint64_t key = kir::cache::computeKey(tokens.Hash);
+    const auto cachePath    = kir::cache::getPath(globals::g_config.CacheDir, key);
+
+    // the files with tokenizer messages are parsed again to report them
+    if (useCache && file.ErrMsgs.empty()) {
+        logger::trace::Scope scope("kir cache", file.Filepath);
+
+        // the warnings of the parser are stored with the KIR, so the warm build reports the same messages
+        std::string messages;
+        if (kir::cache::load(cachePath, key, unit.Kir, messages) && replayMessages(messages, tokens, file)) {
+            if (hasMessages(file)) {
+                markVolatile();
+            }
+
+            unit.KirBytes = bytesOf(unit.Kir);
+            unit.Footprint += unit.KirBytes;
+            unit.IsValid = true;
+            return unit;
+        }
+
+        unit.Kir = {};
+    }
+
+    const std::size_t warnCount  = file.WarnMsgs.size();
+    const std::size_t otherCount = file.OtherMsgs.size();
+    std::string messages;
+
+    {
+        ast::Ast ast;
+        {
+            logger::trace::Scope scope("parse", file.Filepath);
+            ast::Parser parser(file, path);
+            ast = parser.Parse(std::move(tokens));
+        } // parser lifetime
+
+        if (logger::stats::g_enabled) {
+            reportAstStats(ast);
+        }
+
+        if (file.ErrMsgs.empty()) {
+            logger::trace::Scope scope("astgen", file.Filepath);
+            kir::AstGen gen(unit.Kir, ast);
+            gen.Generate();
+        }
+
+        messages = encodeMessages(file, warnCount, otherCount, ast.Tokens);
+
+        unit.KirBytes = bytesOf(unit.Kir);
+        unit.Footprint += bytesOf(ast) + unit.KirBytes;
+    } // ast lifetime
+
+    if (hasMessages(file)) {
+        markVolatile();
+    }
+
+    if (!file.ErrMsgs.empty()) {
+        return unit;
+    }
+
+    if (useCache) {
+        logger::trace::Scope scope("kir cache", file.Filepath);
+
+        if (!kir::cache::store(cachePath, key, unit.Kir, messages)) {
+            KOOLANG_WARN_MSG("Cannot write the cache file '{}'", cachePath.string());
+        }
+    }
+
+    unit.IsValid = true;
+    return unit;
+}
+
+std::uint64_t Database::ComputeSignature(const DeclKey& decl) {
+    Analyzer& analyzer = *t_analyzer;
+
+    const auto fingerprint = m_decls.Get(decl);
+    const auto scope       = m_scopes.Get(decl.Path);
+
+    // the unknown inputs can't show that the analysis would give the same signature
+    if (isNull(fingerprint.get()) || *fingerprint == 0 || isNull(scope.get())) {
+        markVolatile();
+    }
+
+    for (const DeclKey& dependency : analyzer.GetDependencies(decl)) {
+        // the queries never read themselves, the recursive decls are reported by the analysis
+        if (dependency != decl) {
+            DISCARD_VALUE(m_signatures.Get(dependency));
+        }
+    }
+
+    return analyzer.GetSignature(decl);
+}
+
+}
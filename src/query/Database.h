@@ -0,0 +1,118 @@
+#ifndef KOOLANG_QUERY_DATABASE_H
+#define KOOLANG_QUERY_DATABASE_H
+
+#include "Engine.h"
+#include "File.h"
+#include "ast/TokenList.h"
+#include "kir/Inst.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace query {
+
+// KIR of one file
+struct Unit {
+    kir::Kir Kir;
+    // hash of the tokens of the file
+    std::uint64_t TokensHash = 0;
+    // false if the file doesn't parse, the messages are in the file
+    bool IsValid = false;
+    // bytes of the content, the tokens, the AST and the KIR held together while the unit was computed
+    std::size_t Footprint = 0;
+    // bytes of the KIR, they stay after the unit is computed
+    std::size_t KirBytes = 0;
+};
+
+// Top decl of a file
+struct DeclKey {
+    std::string Path;
+    std::string Name;
+
+    bool operator==(const DeclKey& other) const = default;
+};
+
+struct DeclKeyHash {
+    std::size_t operator()(const DeclKey& key) const;
+};
+
+// Results of the analysis of one build, read by the signature queries
+class Analyzer {
+public:
+    virtual ~Analyzer() = default;
+
+    // Returns the decls referenced by the analyzed decl
+    virtual std::vector<DeclKey> GetDependencies(const DeclKey& decl) = 0;
+
+    // Returns the hash of the type and the comptime value of the analyzed decl, 0 if it can't be computed
+    virtual std::uint64_t GetSignature(const DeclKey& decl) = 0;
+};
+
+// Queries shared by the builds of the long-running modes:
+//
+//   content(path) -> tokens(path) -> kir(path)
+//   decl(decl) + scope(path) + signature(referenced decls) -> signature(decl)
+//
+// The content is the input set for every loaded file. Edits of comments and whitespace stop at the tokens, their hash
+// is the fingerprint. The results with messages are volatile, so the messages are reported by every build.
+//
+// The decl input is the hash of the tokens of the decl and the scope input is the hash of what the names of the file
+// refer to. The signature of a decl whose tokens, scope and referenced signatures didn't change is reused, and a decl
+// whose signature didn't change keeps the signatures of its dependents valid. Sema still analyzes every decl of the
+// build, the signatures are read from its results. The body of the decl isn't a query, the statements aren't lowered
+// to AIR yet, so there is no body to compute.
+class Database {
+public:
+    Database();
+
+    // Starts the next build
+    void NewRevision() { m_engine.NewRevision(); }
+
+    // The keys are the normalized paths of the files
+    void SetContent(const std::string& path, std::string content);
+
+    // Returns the KIR of the file. The content of the file must be the one set for the path, the messages of the
+    // computed steps are added to the file.
+    std::shared_ptr<const Unit> GetKir(const std::string& path, File& file);
+
+    // Returns nullptr if the content of the file wasn't set
+    std::shared_ptr<const std::string> GetContent(const std::string& path) { return m_content.Get(path); }
+
+    // Drops the results of the file. The one-shot builds read every file once, so they don't keep the front end
+    // artifacts after the module took its KIR.
+    void Forget(const std::string& path);
+
+    // The inputs of the signatures, set before the signatures of the build are read. The fingerprint 0 is unknown and
+    // the signature of the decl is computed in every revision.
+    void SetDecl(const DeclKey& decl, std::uint64_t fingerprint) { m_decls.Set(decl, fingerprint); }
+    void SetScope(const std::string& path, std::uint64_t scope) { m_scopes.Set(path, scope); }
+
+    // Returns the signature of the decl. The decls it references must have their signatures read first, so the query
+    // doesn't recurse through the chains of the dependencies.
+    std::uint64_t GetSignature(const DeclKey& decl, Analyzer& analyzer);
+
+    [[nodiscard]] Stats GetTokensStats() { return m_tokens.GetStats(); }
+    [[nodiscard]] Stats GetKirStats() { return m_kir.GetStats(); }
+    [[nodiscard]] Stats GetSignatureStats() { return m_signatures.GetStats(); }
+
+private:
+    Engine m_engine;
+
+    Input<std::string, std::string> m_content;
+    Query<std::string, ast::TokenList> m_tokens;
+    Query<std::string, Unit> m_kir;
+
+    Input<DeclKey, std::uint64_t, DeclKeyHash> m_decls;
+    Input<std::string, std::uint64_t> m_scopes;
+    Query<DeclKey, std::uint64_t, DeclKeyHash> m_signatures;
+
+    ast::TokenList ComputeTokens(const std::string& path);
+    Unit ComputeKir(const std::string& path);
+    std::uint64_t ComputeSignature(const DeclKey& decl);
+};
+
+}
+
+#endif
@@ -0,0 +1,382 @@
+#ifndef KOOLANG_QUERY_ENGINE_H
+#define KOOLANG_QUERY_ENGINE_H
+
+#include "util/Index.h"
+#include "util/debug.h"
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Memoized queries with red/green revalidation. Every result remembers the queries read while it was computed. A new
+// revision only makes the results stale: the stale result is reused when none of its dependencies changed since it was
+// verified, otherwise it's computed again. When the new value has the same fingerprint as the old one, the result
+// keeps the revision of its last change and the results depending on it stay valid (early cutoff).
+//
+// The queries of different keys run in parallel, a thread asking for the key computed by another thread waits for it.
+// The query reading itself on the same thread is a cycle, it's reported as an error and the read returns nullptr.
+namespace query {
+
+using Revision = std::uint64_t;
+
+class Engine {
+public:
+    [[nodiscard]] Revision GetRevision() const { return m_revision.load(); }
+
+    // Starts a new revision, the volatile results are computed again
+    Revision NewRevision() { return ++m_revision; }
+
+private:
+    std::atomic<Revision> m_revision = 1;
+};
+
+class TableBase {
+public:
+    explicit TableBase(Engine& engine)
+        : m_engine(engine) { }
+
+    TableBase(const TableBase&)            = delete;
+    TableBase& operator=(const TableBase&) = delete;
+
+    virtual ~TableBase() = default;
+
+    // Brings the slot up to date and returns the revision of its last change
+    virtual Revision Validate(Index slot) = 0;
+
+protected:
+    Engine& m_engine;
+};
+
+struct Dependency {
+    TableBase* Table;
+    Index Slot;
+};
+
+struct Stats {
+    // results computed by the function
+    std::size_t Computed = 0;
+    // stale results reused after their dependencies were verified
+    std::size_t Reused = 0;
+    // reads of the queries which were running on the same thread
+    std::size_t Cycles = 0;
+};
+
+namespace detail {
+
+    // query computed by the thread
+    struct Frame {
+        std::vector<Dependency> Dependencies;
+        bool IsVolatile = false;
+    };
+
+    inline thread_local Frame* t_frame = nullptr;
+
+    inline void record(TableBase* table, Index slot, bool isVolatile) {
+        if (isNull(t_frame)) {
+            return;
+        }
+
+        t_frame->Dependencies.push_back(Dependency { .Table = table, .Slot = slot });
+        t_frame->IsVolatile = t_frame->IsVolatile || isVolatile;
+    }
+
+}
+
+// Marks the running query volatile, its result is computed again in every revision. It's used for the results with
+// side effects like the reported messages, the queries reading it are volatile as well.
+inline void markVolatile() {
+    if (!isNull(detail::t_frame)) {
+        detail::t_frame->IsVolatile = true;
+    }
+}
+
+// Values set from the outside, e.g. the file contents
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class Input : public TableBase {
+public:
+    using FingerprintFn = std::function<std::uint64_t(const Value&)>;
+
+    Input(Engine& engine, FingerprintFn fingerprint)
+        : TableBase(engine)
+        , m_fingerprint(std::move(fingerprint)) { }
+
+    // Sets the value, the new revision starts only when the fingerprint differs
+    void Set(const Key& key, Value value) {
+        const std::uint64_t fingerprint = m_fingerprint(value);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Slot& slot = m_slots[FindOrAdd(key)];
+
+        if (!isNull(slot.Result.get()) && slot.Fingerprint == fingerprint) {
+            return;
+        }
+
+        slot.Result      = std::make_shared<const Value>(std::move(value));
+        slot.Fingerprint = fingerprint;
+        slot.ChangedAt   = m_engine.NewRevision();
+    }
+
+    // Returns nullptr if the key wasn't set
+    std::shared_ptr<const Value> Get(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Index index = FindOrAdd(key);
+
+        detail::record(this, index, false);
+        return m_slots[index].Result;
+    }
+
+    Revision Validate(Index slot) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slots[slot].ChangedAt;
+    }
+
+    // Drops the value, the holders of the returned pointers keep it alive
+    void Forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (const auto iter = m_index.find(key); iter != m_index.end()) {
+            m_slots[iter->second] = Slot();
+        }
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<const Value> Result;
+        std::uint64_t Fingerprint = 0;
+        Revision ChangedAt        = 0;
+    };
+
+    FingerprintFn m_fingerprint;
+
+    std::mutex m_mutex;
+    std::unordered_map<Key, Index, Hash> m_index;
+    // the references stay valid when the slots are added
+    std::deque<Slot> m_slots;
+
+    Index FindOrAdd(const Key& key) {
+        const auto [iter, inserted] = m_index.try_emplace(key, static_cast<Index>(m_slots.size()));
+        if (inserted) {
+            m_slots.emplace_back();
+        }
+
+        return iter->second;
+    }
+};
+
+// Values computed from other queries, the function reads its dependencies through their 'Get'
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class Query : public TableBase {
+public:
+    using ComputeFn     = std::function<Value(const Key&)>;
+    using FingerprintFn = std::function<std::uint64_t(const Value&)>;
+
+    Query(Engine& engine, ComputeFn compute, FingerprintFn fingerprint)
+        : TableBase(engine)
+        , m_compute(std::move(compute))
+        , m_fingerprint(std::move(fingerprint)) { }
+
+    // Returns nullptr if the query is already running on this thread
+    std::shared_ptr<const Value> Get(const Key& key) {
+        const Index index = FindOrAdd(key);
+
+        Update(index, true);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Slot& slot = m_slots[index];
+
+        if (IsCycle(slot)) {
+            return nullptr;
+        }
+
+        detail::record(this, index, slot.IsVolatile);
+        return slot.Result;
+    }
+
+    // Returns the value and drops the memoized result when nobody else holds it, so the reader doesn't copy it. The
+    // fingerprint is kept, the next read computes the value again and the results depending on it stay valid when it
+    // didn't change. It's meant for the only reader of the query, the query must not be running on this thread.
+    Value Take(const Key& key) {
+        const Index index = FindOrAdd(key);
+
+        Update(index, true);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Slot& slot = m_slots[index];
+
+        assert(!IsCycle(slot));
+        detail::record(this, index, slot.IsVolatile);
+
+        if (slot.Result.use_count() != 1) {
+            return *slot.Result;
+        }
+
+        Value value = std::move(*slot.Result);
+        slot.Result.reset();
+
+        return value;
+    }
+
+    Revision Validate(Index index) override { return Update(index, false); }
+
+    [[nodiscard]] Stats GetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    // Drops the memoized result, the next 'Get' computes it again. The holders of the returned pointers keep it alive.
+    void Forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto iter = m_index.find(key);
+        if (iter == m_index.end() || m_slots[iter->second].State == Status::RUNNING) {
+            return;
+        }
+
+        Slot& slot    = m_slots[iter->second];
+        Key argument  = std::move(slot.Argument);
+        slot          = Slot();
+        slot.Argument = std::move(argument);
+    }
+
+private:
+    enum class Status {
+        EMPTY,
+        RUNNING,
+        MEMO,
+    };
+
+    struct Slot {
+        Key Argument;
+        Status State = Status::EMPTY;
+        // thread of the running query
+        std::thread::id Owner;
+
+        // not const, 'Take' moves the value out of it
+        std::shared_ptr<Value> Result;
+        std::uint64_t Fingerprint = 0;
+        std::vector<Dependency> Dependencies;
+        bool IsVolatile = false;
+
+        Revision VerifiedAt = 0;
+        Revision ChangedAt  = 0;
+    };
+
+    ComputeFn m_compute;
+    FingerprintFn m_fingerprint;
+
+    std::mutex m_mutex;
+    std::condition_variable m_doneCV;
+    std::unordered_map<Key, Index, Hash> m_index;
+    // the references stay valid when the slots are added
+    std::deque<Slot> m_slots;
+    Stats m_stats;
+
+    // Brings the slot up to date, the value is computed again if it was taken and the reader needs it
+    Revision Update(Index index, bool needsValue) {
+        const Revision revision = m_engine.GetRevision();
+        const auto thread       = std::this_thread::get_id();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Slot& slot = m_slots[index];
+
+        m_doneCV.wait(lock, [&slot, thread]() { return slot.State != Status::RUNNING || slot.Owner == thread; });
+
+        // waiting for itself would never end, the reader is computed again in the next revision
+        if (slot.State == Status::RUNNING) {
+            m_stats.Cycles++;
+            lock.unlock();
+
+            KOOLANG_ERR_MSG("QUERY CYCLE: the query reads itself");
+            markVolatile();
+            return revision;
+        }
+
+        // the taken result is still valid for its readers, it's computed again only for the value
+        const bool hasValue = !needsValue || !isNull(slot.Result.get());
+
+        if (slot.State == Status::MEMO && slot.VerifiedAt >= revision && hasValue) {
+            return slot.ChangedAt;
+        }
+
+        const bool hasMemo        = slot.State == Status::MEMO;
+        const bool isGreenable    = hasMemo && !slot.IsVolatile && hasValue;
+        const Revision verifiedAt = slot.VerifiedAt;
+
+        std::vector<Dependency> dependencies;
+        if (isGreenable) {
+            dependencies = slot.Dependencies;
+        }
+
+        slot.State = Status::RUNNING;
+        slot.Owner = thread;
+        lock.unlock();
+
+        // green when no dependency changed since the last verification
+        bool isGreen = isGreenable;
+        for (const Dependency& dependency : dependencies) {
+            if (!isGreen) {
+                break;
+            }
+            isGreen = dependency.Table->Validate(dependency.Slot) <= verifiedAt;
+        }
+
+        if (isGreen) {
+            lock.lock();
+            slot.State      = Status::MEMO;
+            slot.VerifiedAt = revision;
+            m_stats.Reused++;
+            m_doneCV.notify_all();
+
+            return slot.ChangedAt;
+        }
+
+        detail::Frame frame;
+        detail::Frame* parent = std::exchange(detail::t_frame, &frame);
+        Value result          = m_compute(slot.Argument);
+        detail::t_frame       = parent;
+
+        const std::uint64_t fingerprint = m_fingerprint(result);
+
+        lock.lock();
+        if (!hasMemo || slot.Fingerprint != fingerprint) {
+            slot.ChangedAt = revision;
+        }
+
+        slot.Result       = std::make_shared<Value>(std::move(result));
+        slot.Fingerprint  = fingerprint;
+        slot.Dependencies = std::move(frame.Dependencies);
+        slot.IsVolatile   = frame.IsVolatile;
+        slot.State        = Status::MEMO;
+        slot.VerifiedAt   = revision;
+        m_stats.Computed++;
+        m_doneCV.notify_all();
+
+        return slot.ChangedAt;
+    }
+
+    Index FindOrAdd(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto [iter, inserted] = m_index.try_emplace(key, static_cast<Index>(m_slots.size()));
+        if (inserted) {
+            m_slots.emplace_back().Argument = key;
+        }
+
+        return iter->second;
+    }
+
+    // the slot is computed by this thread, so the reader is the query itself or one it's reading
+    static bool IsCycle(const Slot& slot) {
+        return slot.State == Status::RUNNING && slot.Owner == std::this_thread::get_id();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,376 @@
+#include "Server.h"
+#include "Watcher.h"
+#include "terminal/globals.h"
+#include "util/Index.h"
+#include "util/alias.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace server {
+
+std::filesystem::path getSocketPath(const std::filesystem::path& cacheDir) { return cacheDir / "server.sock"; }
+
+#ifdef __linux__
+
+namespace {
+
+    // Waits for the changes of the files written in several steps
+    constexpr int SETTLE_MS = 20;
+
+    // Limit of the request line
+    constexpr std::size_t MAX_REQUEST = 64;
+
+    // The server is single-threaded, a client which doesn't send or read its data is dropped after the timeout
+    constexpr int CLIENT_TIMEOUT_MS = 2000;
+
+    struct Output {
+        int Code = 0;
+        std::string Text;
+    };
+
+    // The watched directories, new modules can appear next to the loaded ones or in the import paths
+    std::vector<std::filesystem::path> collectDirectories(const std::vector<std::filesystem::path>& sources) {
+        std::unordered_set<std::string> unique;
+        std::vector<std::filesystem::path> dirs;
+
+        const auto add = [&unique, &dirs](const std::filesystem::path& dir) {
+            if (unique.insert(dir.string()).second) {
+                dirs.push_back(dir);
+            }
+        };
+
+        add(globals::g_config.WorkingDir);
+        for (const auto& dir : globals::g_config.ImportPaths) {
+            add(dir);
+        }
+
+        for (const auto& source : sources) {
+            add(source.parent_path());
+        }
+
+        return dirs;
+    }
+
+    long long elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Runs the build with the standard output and error redirected to the temporary file, the child processes like
+    // the C compiler write there too
+    Output buildCaptured(const BuildFn& build, Watcher& watcher) {
+        Output output;
+
+        std::FILE* temp = std::tmpfile();
+        if (isNull(temp)) {
+            output.Code = 1;
+            output.Text = "ERROR: Cannot create the output file\n";
+            return output;
+        }
+
+        std::cout.flush();
+        std::fflush(stdout);
+        std::fflush(stderr);
+
+        const int savedOut = ::dup(STDOUT_FILENO);
+        const int savedErr = ::dup(STDERR_FILENO);
+        ::dup2(::fileno(temp), STDOUT_FILENO);
+        ::dup2(::fileno(temp), STDERR_FILENO);
+
+        const BuildResult result = build();
+
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(stdout);
+        std::fflush(stderr);
+
+        ::dup2(savedOut, STDOUT_FILENO);
+        ::dup2(savedErr, STDERR_FILENO);
+        ::close(savedOut);
+        ::close(savedErr);
+
+        std::rewind(temp);
+
+        char buffer[4096];
+        std::size_t size = 0;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), temp)) > 0) {
+            output.Text.append(buffer, size);
+        }
+        std::fclose(temp);
+
+        output.Code = result.Code;
+        watcher.SetDirectories(collectDirectories(result.Sources));
+
+        return output;
+    }
+
+    bool sendAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+
+            data.remove_prefix(static_cast<std::size_t>(sent));
+        }
+
+        return true;
+    }
+
+    // Applies the timeout to the blocking reads and writes of the client
+    bool setClientTimeout(int fd) {
+        const timeval timeout = {
+            .tv_sec  = CLIENT_TIMEOUT_MS / 1000,
+            .tv_usec = (CLIENT_TIMEOUT_MS % 1000) * 1000,
+        };
+
+        return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0
+            && ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+    }
+
+    // Returns false if the client timed out or closed the connection without a request
+    bool readRequest(int fd, std::string& request) {
+        char character = 0;
+
+        while (request.size() < MAX_REQUEST) {
+            const ssize_t size = ::recv(fd, &character, 1, 0);
+
+            if (size < 0 && errno == EINTR) {
+                continue;
+            } else if (size == 0) {
+                return !request.empty();
+            } else if (size != 1) {
+                return false;
+            } else if (character == '\n') {
+                return true;
+            }
+
+            request += character;
+        }
+
+        return true;
+    }
+
+    bool makeAddress(const std::filesystem::path& socketPath, sockaddr_un& address) {
+        const std::string path = socketPath.string();
+
+        address            = {};
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cout << "ERROR: Socket path is too long '" << path << '\'' << std::endl;
+            return false;
+        }
+
+        path.copy(address.sun_path, path.size());
+        return true;
+    }
+
+    int connectTo(const sockaddr_un& address) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+}
+
+int watch(const BuildFn& build) {
+    Watcher watcher;
+    if (!watcher.IsOk()) {
+        std::cout << "ERROR: Cannot watch the sources" << std::endl;
+        return 1;
+    }
+
+    while (true) {
+        const auto start          = std::chrono::steady_clock::now();
+        const BuildResult result = build();
+
+        watcher.SetDirectories(collectDirectories(result.Sources));
+
+        std::cout << "[watch] build finished with code " << result.Code << " in " << elapsedMs(start)
+                  << " ms, waiting for changes" << std::endl;
+
+        watcher.WaitChange(SETTLE_MS);
+    }
+}
+
+int serve(const BuildFn& build, const std::filesystem::path& socketPath) {
+    Watcher watcher;
+    if (!watcher.IsOk()) {
+        std::cout << "ERROR: Cannot watch the sources" << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return 1;
+    }
+
+    // the socket of a server which didn't stop properly is removed
+    if (const int running = connectTo(address); running >= 0) {
+        ::close(running);
+        std::cout << "ERROR: Server is already running on '" << socketPath.string() << '\'' << std::endl;
+        return 1;
+    }
+
+    std::error_code err;
+    std::filesystem::create_directories(socketPath.parent_path(), err);
+    std::filesystem::remove(socketPath, err);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, 8) != 0) {
+        std::cout << "ERROR: Cannot listen on '" << socketPath.string() << '\'' << std::endl;
+        if (listener >= 0) {
+            ::close(listener);
+        }
+        return 1;
+    }
+
+    const auto rebuild = [&build, &watcher]() {
+        const auto start    = std::chrono::steady_clock::now();
+        Output output       = buildCaptured(build, watcher);
+        std::cout << "[serve] build finished with code " << output.Code << " in " << elapsedMs(start) << " ms"
+                  << std::endl;
+        return output;
+    };
+
+    Output last = rebuild();
+    std::cout << "[serve] listening on '" << socketPath.string() << '\'' << std::endl;
+
+    bool running = true;
+    while (running) {
+        pollfd fds[2] = {
+            { .fd = listener, .events = POLLIN, .revents = 0 },
+            { .fd = watcher.GetFd(), .events = POLLIN, .revents = 0 },
+        };
+
+        if (::poll(fds, 2, -1) <= 0) {
+            continue;
+        }
+
+        // the sources are built before the request comes, so it gets the finished build
+        if ((fds[1].revents & POLLIN) != 0 && watcher.ReadEvents()) {
+            watcher.Settle(SETTLE_MS);
+            last = rebuild();
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+
+        std::string request;
+        if (!setClientTimeout(client) || !readRequest(client, request)) {
+            std::cout << "[serve] dropped a client without a request" << std::endl;
+            ::close(client);
+            continue;
+        }
+
+        std::string response;
+
+        if (request == "build" || request == "rebuild") {
+            if (request == "rebuild" || watcher.ReadEvents()) {
+                last = rebuild();
+            }
+
+            response = last.Text + '\0' + std::to_string(last.Code);
+        } else if (request == "stop") {
+            running  = false;
+            response = std::string("[serve] stopped\n") + '\0' + "0";
+        } else {
+            response = "ERROR: Unknown request '" + request + "'\n" + '\0' + "1";
+        }
+
+        sendAll(client, response);
+        ::close(client);
+    }
+
+    ::close(listener);
+    std::filesystem::remove(socketPath, err);
+
+    return 0;
+}
+
+int connect(const std::filesystem::path& socketPath, std::string_view request) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return 1;
+    }
+
+    const int fd = connectTo(address);
+    if (fd < 0) {
+        std::cout << "ERROR: No server is running on '" << socketPath.string() << '\'' << std::endl;
+        return 1;
+    }
+
+    sendAll(fd, std::string(request) + '\n');
+    ::shutdown(fd, SHUT_WR);
+
+    std::string response;
+    char buffer[4096];
+    ssize_t size = 0;
+
+    while ((size = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<std::size_t>(size));
+    }
+    ::close(fd);
+
+    const std::size_t separator = response.rfind('\0');
+    if (separator == std::string::npos) {
+        std::cout << "ERROR: Invalid response of the server" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::string_view(response).substr(0, separator) << std::flush;
+    return std::atoi(response.c_str() + separator + 1);
+}
+
+#else
+
+int watch(const BuildFn& build) {
+    DISCARD_VALUE(build);
+    std::cout << "ERROR: --watch is supported only on Linux" << std::endl;
+    return 1;
+}
+
+int serve(const BuildFn& build, const std::filesystem::path& socketPath) {
+    DISCARD_VALUE(build);
+    DISCARD_VALUE(socketPath);
+    std::cout << "ERROR: --serve is supported only on Linux" << std::endl;
+    return 1;
+}
+
+int connect(const std::filesystem::path& socketPath, std::string_view request) {
+    DISCARD_VALUE(socketPath);
+    DISCARD_VALUE(request);
+    std::cout << "ERROR: --connect is supported only on Linux" << std::endl;
+    return 1;
+}
+
+#endif
+
+}
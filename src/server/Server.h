@@ -0,0 +1,42 @@
+#ifndef KOOLANG_SERVER_SERVER_H
+#define KOOLANG_SERVER_SERVER_H
+
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Long-running modes of the compiler. The process stays alive between the builds, so the KIR of the unchanged files is
+// kept in memory and the caches on disk stay hot.
+//
+// The server listens on a Unix socket, the client sends one request line and reads the output of the build followed
+// by '\0' and the exit code. Requests:
+//
+//   build     output of the last build, the changed sources are built first
+//   rebuild   builds again even if no source changed
+//   stop      stops the server
+namespace server {
+
+struct BuildResult {
+    int Code;
+    // the directories of the sources are watched
+    std::vector<std::filesystem::path> Sources;
+};
+
+using BuildFn = std::function<BuildResult()>;
+
+// Returns the socket of the server for the cache directory
+std::filesystem::path getSocketPath(const std::filesystem::path& cacheDir);
+
+// Builds again after every change of the sources, the output goes to the terminal. Doesn't return unless it fails.
+int watch(const BuildFn& build);
+
+// Builds the sources as soon as they change and answers the requests on the socket
+int serve(const BuildFn& build, const std::filesystem::path& socketPath);
+
+// Sends the request to the server and prints the output, returns the exit code of the build
+int connect(const std::filesystem::path& socketPath, std::string_view request);
+
+}
+
+#endif
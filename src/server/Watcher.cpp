@@ -0,0 +1,140 @@
+#include "Watcher.h"
+#include "util/alias.h"
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace server {
+
+#ifdef __linux__
+
+namespace {
+
+    constexpr std::uint32_t EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+    bool isSourceEvent(const inotify_event* event) {
+        // new directories could contain modules, e.g. 'mod.k'
+        if ((event->mask & IN_ISDIR) != 0) {
+            return (event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM)) != 0;
+        }
+
+        if (event->len == 0) {
+            return false;
+        }
+
+        const std::string_view name(event->name);
+        return name.size() > 2 && name.ends_with(".k");
+    }
+
+}
+
+Watcher::Watcher()
+    : m_fd(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) { }
+
+Watcher::~Watcher() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void Watcher::SetDirectories(const std::vector<std::filesystem::path>& dirs) {
+    std::unordered_set<std::string> wanted;
+
+    for (const auto& dir : dirs) {
+        std::error_code err;
+        const auto canonical = std::filesystem::weakly_canonical(dir, err);
+
+        if (!err && std::filesystem::is_directory(canonical, err)) {
+            wanted.insert(canonical.string());
+        }
+    }
+
+    for (auto iter = m_watches.begin(); iter != m_watches.end();) {
+        if (wanted.contains(iter->first)) {
+            ++iter;
+            continue;
+        }
+
+        ::inotify_rm_watch(m_fd, iter->second);
+        iter = m_watches.erase(iter);
+    }
+
+    for (const auto& dir : wanted) {
+        if (m_watches.contains(dir)) {
+            continue;
+        }
+
+        const int watch = ::inotify_add_watch(m_fd, dir.c_str(), EVENTS);
+        if (watch >= 0) {
+            m_watches[dir] = watch;
+        }
+    }
+}
+
+bool Watcher::ReadEvents() {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+
+    while (true) {
+        const ssize_t size = ::read(m_fd, buffer, sizeof(buffer));
+        if (size <= 0) {
+            return changed;
+        }
+
+        for (ssize_t offset = 0; offset < size;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            // the directory was removed, the watch doesn't exist anymore
+            if ((event->mask & IN_IGNORED) != 0) {
+                std::erase_if(m_watches, [event](const auto& watch) { return watch.second == event->wd; });
+                continue;
+            }
+
+            changed = changed || isSourceEvent(event);
+        }
+    }
+}
+
+void Watcher::WaitChange(int settleMs) {
+    pollfd fd { .fd = m_fd, .events = POLLIN, .revents = 0 };
+
+    while (true) {
+        if (::poll(&fd, 1, -1) > 0 && ReadEvents()) {
+            break;
+        }
+    }
+
+    Settle(settleMs);
+}
+
+void Watcher::Settle(int settleMs) {
+    pollfd fd { .fd = m_fd, .events = POLLIN, .revents = 0 };
+
+    // editors write the file in several steps
+    while (::poll(&fd, 1, settleMs) > 0) {
+        ReadEvents();
+    }
+}
+
+#else
+
+Watcher::Watcher() = default;
+
+Watcher::~Watcher() = default;
+
+void Watcher::SetDirectories(const std::vector<std::filesystem::path>& dirs) { DISCARD_VALUE(dirs); }
+
+bool Watcher::ReadEvents() { return false; }
+
+void Watcher::WaitChange(int settleMs) { DISCARD_VALUE(settleMs); }
+
+void Watcher::Settle(int settleMs) { DISCARD_VALUE(settleMs); }
+
+#endif
+
+}
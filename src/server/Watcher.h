@@ -0,0 +1,46 @@
+#ifndef KOOLANG_SERVER_WATCHER_H
+#define KOOLANG_SERVER_WATCHER_H
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+// Reports the changes of the koolang sources inside the watched directories, uses inotify
+class Watcher {
+public:
+    Watcher();
+    ~Watcher();
+
+    Watcher(const Watcher&)            = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    [[nodiscard]] bool IsOk() const { return m_fd >= 0; }
+
+    // The descriptor is readable when there are pending events
+    [[nodiscard]] int GetFd() const { return m_fd; }
+
+    // Watches exactly the given directories, the missing directories are skipped
+    void SetDirectories(const std::vector<std::filesystem::path>& dirs);
+
+    // Reads the pending events without blocking, returns true if any source or directory changed
+    bool ReadEvents();
+
+    // Blocks until a source changes and the following events settle for the given time
+    void WaitChange(int settleMs);
+
+    // Reads the events until none comes for the given time
+    void Settle(int settleMs);
+
+private:
+    int m_fd = -1;
+
+    // directory -> watch descriptor
+    std::unordered_map<std::string, int> m_watches;
+};
+
+}
+
+#endif
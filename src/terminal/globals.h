@@ -1,6 +1,7 @@
 #ifndef KOOLANG_GLOBALS_H
 #define KOOLANG_GLOBALS_H
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -19,9 +20,15 @@ struct Config {
         OPTIMAZE_0     = 1 << 7,
         OPTIMAZE_1     = 1 << 8,
         OPTIMAZE_2     = 1 << 9,
-        OPTIMAZE_S     = 0 << 10,
+        OPTIMAZE_S     = 1 << 10,
         OPTIMAZE_RESET = OPTIMAZE_0 | OPTIMAZE_1 | OPTIMAZE_2 | OPTIMAZE_S,
         DEBUG_MODE     = 1 << 11,
+        NO_CACHE       = 1 << 12,
+        WATCH          = 1 << 13,
+        SERVE          = 1 << 14,
+        CONNECT        = 1 << 15,
+        TIME_REPORT    = 1 << 16,
+        STATS          = 1 << 17,
     };
 
     enum class Command {
@@ -32,6 +39,7 @@ struct Config {
         BUILD_DYNLIB,
         BUILD_CDYNLIB,
         SHOW_KIR,
+        LSP,
     };
 
     Options Flags   = static_cast<Options>(COLOR | ERROR_NORMAL | TARGET_X86_64 | OPTIMAZE_0);
@@ -41,6 +49,15 @@ struct Config {
     std::string InputFile;
     std::vector<std::filesystem::path> ImportPaths;
     std::filesystem::path WorkingDir;
+    // '.koolang-cache' inside the working directory by default
+    std::filesystem::path CacheDir;
+    // Chrome trace of the build, empty if not requested
+    std::filesystem::path TracePath;
+    // memory of the front end jobs running at once and of the KIR they keep in bytes, 0 if unlimited. The records and
+    // the Semas of the prepared modules aren't counted.
+    std::size_t MaxMemory = 0;
+    // threads running at once, 0 joins the make jobserver or uses the hardware threads
+    unsigned int Jobs = 0;
 };
 
 extern Config g_config;
@@ -1,5 +1,6 @@
 #include "terminal.h"
 #include "globals.h"
+#include <limits>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -7,6 +8,68 @@
 
 namespace terminal {
 
+namespace {
+
+    // Parses the size in bytes with the optional suffix K, M or G, the sizes which don't fit are rejected
+    bool parseSize(std::string_view str, std::size_t& size) {
+        constexpr std::size_t MAX = std::numeric_limits<std::size_t>::max();
+
+        std::size_t value = 0;
+        std::size_t i     = 0;
+
+        for (; i < str.size() && str[i] >= '0' && str[i] <= '9'; i++) {
+            const auto digit = static_cast<std::size_t>(str[i] - '0');
+            if (value > (MAX - digit) / 10) {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+
+        if (i == 0) {
+            return false;
+        }
+
+        std::size_t shift             = 0;
+        const std::string_view suffix = str.substr(i);
+        if (suffix == "K" || suffix == "k") {
+            shift = 10;
+        } else if (suffix == "M" || suffix == "m") {
+            shift = 20;
+        } else if (suffix == "G" || suffix == "g") {
+            shift = 30;
+        } else if (!suffix.empty()) {
+            return false;
+        }
+
+        if (value > (MAX >> shift)) {
+            return false;
+        }
+
+        size = value << shift;
+        return true;
+    }
+
+    // Parses the positive count without the suffix
+    bool parseCount(std::string_view str, unsigned int& count) {
+        unsigned int value = 0;
+
+        for (const char c : str) {
+            if (c < '0' || c > '9' || value > 1'000'000) {
+                return false;
+            }
+            value = value * 10 + static_cast<unsigned int>(c - '0');
+        }
+
+        if (value == 0) {
+            return false;
+        }
+
+        count = value;
+        return true;
+    }
+
+}
+
 void init() {
 #ifdef _WIN32
     SetConsoleCP(65001);
@@ -32,6 +95,48 @@ bool parseArgs(int argc, char** argv, globals::Config& config) {
             config.Flags = static_cast<Config::Options>(config.Flags | Config::TEST);
         } else if (arg == "-d" || arg == "--debug") {
             config.Flags = static_cast<Config::Options>(config.Flags | Config::DEBUG_MODE);
+        } else if (arg == "--no-cache") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::NO_CACHE);
+        } else if (arg == "--watch") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::WATCH);
+        } else if (arg == "--serve") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::SERVE);
+        } else if (arg == "--connect") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::CONNECT);
+        } else if (arg == "--time-report") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::TIME_REPORT);
+        } else if (arg == "--stats") {
+            config.Flags = static_cast<Config::Options>(config.Flags | Config::STATS);
+        } else if (arg == "--trace") {
+            if (i + 1 == argc) {
+                std::cout << "ERROR: Expected value after --trace" << std::endl;
+                return false;
+            }
+            config.TracePath = argv[++i];
+        } else if (arg == "--max-memory") {
+            if (i + 1 == argc) {
+                std::cout << "ERROR: Expected value after --max-memory" << std::endl;
+                return false;
+            }
+            if (!parseSize(argv[++i], config.MaxMemory)) {
+                std::cout << "ERROR: Invalid value for --max-memory" << std::endl;
+                return false;
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 == argc) {
+                std::cout << "ERROR: Expected value after --jobs" << std::endl;
+                return false;
+            }
+            if (!parseCount(argv[++i], config.Jobs)) {
+                std::cout << "ERROR: Invalid value for --jobs" << std::endl;
+                return false;
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 == argc) {
+                std::cout << "ERROR: Expected value after --cache-dir" << std::endl;
+                return false;
+            }
+            config.CacheDir = argv[++i];
         } else if (arg == "--target") {
             if (i + 1 == argc) {
                 std::cout << "ERROR: Expected value after --target" << std::endl;
@@ -54,16 +159,16 @@ bool parseArgs(int argc, char** argv, globals::Config& config) {
             arg = argv[++i];
             if (arg == "0") {
                 config.Flags
-                    = static_cast<Config::Options>((config.Flags ^ Config::OPTIMAZE_RESET) | Config::OPTIMAZE_0);
+                    = static_cast<Config::Options>((config.Flags & ~Config::OPTIMAZE_RESET) | Config::OPTIMAZE_0);
             } else if (arg == "1") {
                 config.Flags
-                    = static_cast<Config::Options>((config.Flags ^ Config::OPTIMAZE_RESET) | Config::OPTIMAZE_1);
+                    = static_cast<Config::Options>((config.Flags & ~Config::OPTIMAZE_RESET) | Config::OPTIMAZE_1);
             } else if (arg == "2") {
                 config.Flags
-                    = static_cast<Config::Options>((config.Flags ^ Config::OPTIMAZE_RESET) | Config::OPTIMAZE_2);
+                    = static_cast<Config::Options>((config.Flags & ~Config::OPTIMAZE_RESET) | Config::OPTIMAZE_2);
             } else if (arg == "s") {
                 config.Flags
-                    = static_cast<Config::Options>((config.Flags ^ Config::OPTIMAZE_RESET) | Config::OPTIMAZE_S);
+                    = static_cast<Config::Options>((config.Flags & ~Config::OPTIMAZE_RESET) | Config::OPTIMAZE_S);
             } else {
                 std::cout << "ERROR: Invalid value for --optimaze" << std::endl;
                 return false;
@@ -125,6 +230,13 @@ bool parseArgs(int argc, char** argv, globals::Config& config) {
                 return false;
             }
             config.Command = Config::Command::SHOW_KIR;
+        } else if (arg == "lsp") {
+            if (config.Command != Config::Command::NONE) {
+                // TOOD: better message
+                std::cout << "error: command is already set" << std::endl;
+                return false;
+            }
+            config.Command = Config::Command::LSP;
         } else {
             if (i + 1 == argc) {
                 std::filesystem::path path = std::filesystem::absolute(arg);
@@ -142,6 +254,11 @@ bool parseArgs(int argc, char** argv, globals::Config& config) {
         }
     }
 
+    // the language server gets the files from the editor
+    if (config.Command == Config::Command::LSP) {
+        return true;
+    }
+
     if (config.InputFile.empty()) {
         std::cout << "ERROR: Missing input file" << std::endl;
         return false;
@@ -152,11 +269,23 @@ bool parseArgs(int argc, char** argv, globals::Config& config) {
         return false;
     }
 
+    const int modes = ((config.Flags & Config::WATCH) != 0) + ((config.Flags & Config::SERVE) != 0)
+        + ((config.Flags & Config::CONNECT) != 0);
+    if (modes > 1) {
+        std::cout << "ERROR: Only one of --watch, --serve and --connect can be used" << std::endl;
+        return false;
+    }
+
+    if (config.CacheDir.empty()) {
+        config.CacheDir = config.WorkingDir / ".koolang-cache";
+    }
+
     return true;
 }
 
 void printUsage() {
     std::cout << "Usage: koolang [build|kir] [options] <file>\n"
+              << "       koolang lsp [options]\n"
               << "\n"
               << "Options:\n"
               << "  --help            get help\n"
@@ -173,6 +302,16 @@ void printUsage() {
               << "      s             optimaze for binary size\n"
               << "  -d --debug        include debug information\n"
               << "  -I                add import path\n"
+              << "  --cache-dir       directory of the compilation cache\n"
+              << "  --no-cache        don't read or write the compilation cache\n"
+              << "  --watch           rebuild when the sources change\n"
+              << "  --serve           keep the compiler running, builds are requested with --connect\n"
+              << "  --connect         request the build from the running server\n"
+              << "  --time-report     print the time of the compiler phases and modules\n"
+              << "  --trace           write the Chrome trace of the build to the file\n"
+              << "  --stats           print the memory of the compiler data structures and phases\n"
+              << "  --max-memory      limit the memory of the parsed modules, e.g. 512M [default: unlimited]\n"
+              << "  -j, --jobs        number of the threads [default: make jobserver or hardware threads]\n"
               << "Commands:"
               << "  build             specify what compiler emits\n"
               << "      bin           [default]\n"
@@ -180,7 +319,8 @@ void printUsage() {
               << "      clib          c library\n"
               << "      dylib         koolang dynamic library\n"
               << "      cdylib        c dynamic library\n"
-              << "  kir               prints KIR\n";
+              << "  kir               prints KIR\n"
+              << "  lsp               language server on stdio\n";
 }
 
 }
@@ -0,0 +1,73 @@
+#ifndef KOOLANG_UTIL_BINARYSTREAM_H
+#define KOOLANG_UTIL_BINARYSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Writes the values in the native byte order, the files are read by the same compiler only
+class BinaryWriter {
+public:
+    template <typename T> void Put(T value) { m_data.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    void PutStr(std::string_view str) {
+        Put(static_cast<std::uint32_t>(str.size()));
+        m_data.append(str);
+    }
+
+    [[nodiscard]] const std::string& GetData() const { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+// Reads the values until the first failure, then returns only zeroes
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data)
+        : m_data(data) { }
+
+    template <typename T> T Get() {
+        T value {};
+        if (!Has(sizeof(T))) {
+            return value;
+        }
+
+        std::memcpy(static_cast<void*>(&value), m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return value;
+    }
+
+    std::string GetStr() {
+        const auto size = Get<std::uint32_t>();
+        if (!Has(size)) {
+            return {};
+        }
+
+        std::string str(m_data.substr(m_offset, size));
+        m_offset += size;
+        return str;
+    }
+
+    // Reads the count of the items with the size, the count is checked against the remaining data
+    std::uint32_t GetCount(std::size_t itemSize) {
+        const auto count = Get<std::uint32_t>();
+        return Has(count * itemSize) ? count : 0;
+    }
+
+    [[nodiscard]] bool IsOk() const { return m_ok; }
+
+private:
+    std::string_view m_data;
+    std::size_t m_offset = 0;
+    bool m_ok            = true;
+
+    bool Has(std::size_t size) {
+        m_ok = m_ok && size <= m_data.size() - m_offset;
+        return m_ok;
+    }
+};
+
+#endif
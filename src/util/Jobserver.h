@@ -0,0 +1,234 @@
+#ifndef KOOLANG_UTIL_JOBSERVER_H
+#define KOOLANG_UTIL_JOBSERVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// Parallelism of the thread pools. The compiler runs '--jobs' threads at most, or joins the jobserver of GNU make when
+// it's started by 'make -j' without '--jobs'.
+namespace jobs {
+
+// Client of the GNU make jobserver. Every process owns one implicit token, the other running threads hold a token read
+// from the jobserver and write it back when they stop. The implicit token is shared by all the thread pools.
+class Jobserver {
+public:
+    enum class Token : std::uint8_t {
+        IMPLICIT,
+        SHARED,
+    };
+
+    // Returns nullptr if the flags don't name a usable jobserver
+    static std::unique_ptr<Jobserver> FromMakeflags(std::string_view makeflags) {
+#ifdef _WIN32
+        static_cast<void>(makeflags);
+        return nullptr;
+#else
+        // the last option wins, the old make versions use '--jobserver-fds'
+        std::string_view auth;
+        std::size_t authPos = 0;
+        for (const std::string_view option : { "--jobserver-auth=", "--jobserver-fds=" }) {
+            const std::size_t pos = makeflags.rfind(option);
+            if (pos != std::string_view::npos && (auth.empty() || pos > authPos)) {
+                auth    = makeflags.substr(pos + option.size());
+                auth    = auth.substr(0, auth.find(' '));
+                authPos = pos;
+            }
+        }
+
+        if (auth.empty()) {
+            return nullptr;
+        }
+
+        // fifo:PATH
+        if (auth.starts_with("fifo:")) {
+            const std::string path(auth.substr(5));
+
+            const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                return nullptr;
+            }
+
+            return std::unique_ptr<Jobserver>(new Jobserver(fd, fd, true));
+        }
+
+        // R,W
+        const std::size_t comma = auth.find(',');
+        if (comma == std::string_view::npos) {
+            return nullptr;
+        }
+
+        int readFd  = -1;
+        int writeFd = -1;
+        if (!parseFd(auth.substr(0, comma), readFd) || !parseFd(auth.substr(comma + 1), writeFd)) {
+            return nullptr;
+        }
+
+        // the descriptors are closed when the make rule isn't marked as recursive
+        if (::fcntl(readFd, F_GETFD) < 0 || ::fcntl(writeFd, F_GETFD) < 0) {
+            return nullptr;
+        }
+
+        // the own non-blocking description of the pipe, so the other processes don't block on it
+        const std::string procPath = "/dev/fd/" + std::to_string(readFd);
+        const int ownFd            = ::open(procPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (ownFd >= 0) {
+            return std::unique_ptr<Jobserver>(new Jobserver(ownFd, writeFd, true));
+        }
+
+        return std::unique_ptr<Jobserver>(new Jobserver(readFd, writeFd, false));
+#endif
+    }
+
+    Jobserver(const Jobserver&)            = delete;
+    Jobserver& operator=(const Jobserver&) = delete;
+
+    ~Jobserver() {
+#ifndef _WIN32
+        // the tokens are never lost, make would run fewer jobs otherwise
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const char token : m_tokens) {
+            writeToken(token);
+        }
+
+        if (m_ownsRead) {
+            ::close(m_readFd);
+        }
+#endif
+    }
+
+    // Waits for the implicit token of the process or for a token of the jobserver. The broken jobserver leaves only the
+    // implicit token, so the tasks run one by one instead of without a token.
+    Token Acquire() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+
+                if (m_isBroken) {
+                    m_implicitCV.wait(lock, [this]() -> bool { return !m_implicitTaken; });
+                }
+
+                if (!m_implicitTaken) {
+                    m_implicitTaken = true;
+                    return Token::IMPLICIT;
+                }
+            }
+
+#ifdef _WIN32
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+#else
+            pollfd fd { .fd = m_readFd, .events = POLLIN, .revents = 0 };
+
+            // the timeout checks the implicit token again
+            if (::poll(&fd, 1, 10) <= 0) {
+                continue;
+            }
+
+            char token       = 0;
+            const auto count = ::read(m_readFd, &token, 1);
+            if (count == 1) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tokens.push_back(token);
+                return Token::SHARED;
+            }
+
+            // other process took the token first, the closed jobserver fails
+            if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_isBroken = true;
+            }
+#endif
+        }
+    }
+
+    void Release(Token token) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (token == Token::IMPLICIT) {
+            m_implicitTaken = false;
+            m_implicitCV.notify_one();
+            return;
+        }
+
+#ifndef _WIN32
+        if (m_tokens.empty()) {
+            return;
+        }
+
+        writeToken(m_tokens.back());
+        m_tokens.pop_back();
+#endif
+    }
+
+private:
+#ifndef _WIN32
+    // Accepts only the whole non-negative number, the malformed value mustn't be read as stdin
+    static bool parseFd(std::string_view str, int& fd) {
+        const auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), fd);
+        return ec == std::errc() && end == str.data() + str.size() && fd >= 0;
+    }
+
+    void writeToken(char token) const {
+        while (::write(m_writeFd, &token, 1) < 0 && errno == EINTR) { }
+    }
+#endif
+
+    Jobserver(int readFd, int writeFd, bool ownsRead)
+        : m_readFd(readFd)
+        , m_writeFd(writeFd)
+        , m_ownsRead(ownsRead) { }
+
+    int m_readFd;
+    int m_writeFd;
+    bool m_ownsRead;
+
+    std::mutex m_mutex;
+    // the tokens are written back as they were read
+    std::vector<char> m_tokens;
+
+    bool m_implicitTaken = false;
+    bool m_isBroken      = false;
+    std::condition_variable m_implicitCV;
+};
+
+// Set by init before the pools are created
+inline unsigned int g_limit = 0;
+inline std::unique_ptr<Jobserver> g_jobserver;
+
+// The jobs 0 means the hardware threads, or the make jobserver if there is one
+inline void init(unsigned int jobs) {
+    g_limit = jobs;
+
+    if (jobs == 0) {
+        const char* makeflags = std::getenv("MAKEFLAGS");
+        g_jobserver           = Jobserver::FromMakeflags(makeflags == nullptr ? "" : makeflags);
+    }
+}
+
+// Returns the number of the worker threads of a pool, the main thread waits for the workers
+inline unsigned int getWorkerCount() {
+    const unsigned int jobs = (g_limit != 0) ? g_limit : std::thread::hardware_concurrency();
+    return std::max(jobs, 2U) - 1;
+}
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef KOOLANG_UTIL_MEMORYBUDGET_H
+#define KOOLANG_UTIL_MEMORYBUDGET_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Limits the estimated memory of the jobs running at once and of what they leave behind. The job waits until its bytes
+// fit in the budget, a job started when no other job runs never waits, so the kept bytes larger than the budget only
+// serialize the jobs. The limit 0 means no limit.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(std::size_t limit = 0)
+        : m_limit(limit) { }
+
+    void Acquire(std::size_t bytes) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_releasedCV.wait(lock, [this, bytes]() { return m_limit == 0 || m_jobs == 0 || m_used + bytes <= m_limit; });
+
+        m_used += bytes;
+        m_jobs++;
+    }
+
+    // Ends the job, the kept bytes stay in the budget until they are freed
+    void Release(std::size_t bytes, std::size_t kept = 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_used = m_used - bytes + kept;
+            m_jobs--;
+        }
+
+        m_releasedCV.notify_all();
+    }
+
+    // Keeps the bytes loaded outside of the jobs, e.g. the spilled KIR loaded again
+    void Keep(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_used += bytes;
+    }
+
+    // Returns if the used bytes are over the limit, the kept bytes should be freed then
+    [[nodiscard]] bool IsOver() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_limit != 0 && m_used > m_limit;
+    }
+
+    // Frees the bytes kept by the finished job
+    void Free(std::size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_used -= bytes;
+        }
+
+        m_releasedCV.notify_all();
+    }
+
+private:
+    std::size_t m_limit;
+    std::size_t m_used = 0;
+    std::size_t m_jobs = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_releasedCV;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef KOOLANG_UTIL_SCRATCHARENA_H
+#define KOOLANG_UTIL_SCRATCHARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Stack allocator which keeps its memory between the allocations. Spans are released in the reverse order, so nested
+// users can allocate while the outer span is still alive. Allocated spans never move.
+template <typename T> class ScratchArena {
+public:
+    // Returns the value initialized span
+    std::span<T> Push(std::size_t size);
+
+    // Releases the last pushed span
+    void Pop();
+
+    [[nodiscard]] std::size_t GetCapacity() const;
+
+    // Arena of the current thread
+    static ScratchArena& ForThread() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+private:
+    static constexpr std::size_t MIN_CHUNK_SIZE = 16 * 1024;
+
+    struct Chunk {
+        std::unique_ptr<T[]> Data;
+        std::size_t Size;
+    };
+
+    struct Mark {
+        std::size_t Chunk;
+        std::size_t Offset;
+    };
+
+    std::vector<Chunk> m_chunks;
+    std::vector<Mark> m_marks;
+
+    std::size_t m_chunk  = 0;
+    std::size_t m_offset = 0;
+};
+
+template <typename T> std::span<T> ScratchArena<T>::Push(std::size_t size) {
+    m_marks.push_back({ m_chunk, m_offset });
+
+    if (m_chunks.empty() || m_offset + size > m_chunks[m_chunk].Size) {
+        // chunks after the current one are free, too small chunk is replaced
+        const std::size_t next = m_chunks.empty() ? 0 : m_chunk + 1;
+        const std::size_t last = m_chunks.empty() ? 0 : m_chunks[m_chunk].Size;
+
+        if (next == m_chunks.size()) {
+            m_chunks.push_back({ nullptr, 0 });
+        }
+
+        if (m_chunks[next].Size < size) {
+            const std::size_t alloc = std::max({ size, MIN_CHUNK_SIZE, last * 2 });
+            m_chunks[next]          = Chunk { std::make_unique<T[]>(alloc), alloc };
+        }
+
+        m_chunk  = next;
+        m_offset = 0;
+    }
+
+    const std::span<T> span(m_chunks[m_chunk].Data.get() + m_offset, size);
+    std::fill(span.begin(), span.end(), T {});
+
+    m_offset += size;
+    return span;
+}
+
+template <typename T> void ScratchArena<T>::Pop() {
+    const Mark mark = m_marks.back();
+    m_marks.pop_back();
+
+    m_chunk  = mark.Chunk;
+    m_offset = mark.Offset;
+}
+
+template <typename T> std::size_t ScratchArena<T>::GetCapacity() const {
+    std::size_t capacity = 0;
+    for (const auto& chunk : m_chunks) {
+        capacity += chunk.Size;
+    }
+
+    return capacity;
+}
+
+#endif
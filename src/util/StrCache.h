@@ -22,6 +22,8 @@ class StrCache {
         return index;
     }
 
+    [[nodiscard]] const auto& GetMap() const { return m_map; }
+
 private:
     std::unordered_map<std::string_view, Index, string_hash> m_map;
     std::vector<std::string>& m_strings;
@@ -1,10 +1,13 @@
 #ifndef KOOLANG_UTIL_THREADPOOL_H
 #define KOOLANG_UTIL_THREADPOOL_H
 
+#include "logger/Trace.h"
+#include "util/Jobserver.h"
 #include "util/debug.h"
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
 
@@ -12,24 +15,60 @@ template <typename Arg> class ThreadPool {
 public:
     using FnType = std::function<void(Arg&)>;
 
-    ThreadPool(unsigned int numThreads = std::thread::hardware_concurrency() - 1) {
+    // The workers hold a token of the make jobserver while they run a task
+    ThreadPool(unsigned int numThreads = jobs::getWorkerCount()) {
         numThreads = std::max(numThreads, 1U);
 
-        auto worker = [this]() {
+        auto worker = [this](unsigned int index) {
+            if (logger::trace::g_enabled) {
+                logger::trace::nameThread("worker " + std::to_string(index));
+            }
+
             while (true) {
                 std::unique_lock<std::mutex> lock(m_queueMutex);
+
+                logger::trace::Scope idle("pool idle");
                 m_queueCV.wait(lock, [this]() -> bool { return !m_work.empty() || !m_running; });
 
                 if (m_work.empty() && !m_running) {
+                    idle.Cancel();
                     return;
                 }
 
+                // every running worker holds a token, the implicit one of the process is shared with the other pools
+                std::optional<jobs::Jobserver::Token> token;
+                if (jobs::g_jobserver != nullptr) {
+                    lock.unlock();
+                    idle.Stop();
+
+                    {
+                        logger::trace::Scope wait("jobserver wait");
+                        token = jobs::g_jobserver->Acquire();
+                    }
+
+                    lock.lock();
+
+                    // other worker took the task meanwhile
+                    if (m_work.empty()) {
+                        jobs::g_jobserver->Release(*token);
+                        continue;
+                    }
+                }
+
                 Work task = m_work.front();
 
                 m_work.pop();
                 lock.unlock();
+                idle.Stop();
+
+                {
+                    logger::trace::Scope job("pool job");
+                    task.Func(task.Argument);
+                }
 
-                task.Func(task.Argument);
+                if (token.has_value()) {
+                    jobs::g_jobserver->Release(*token);
+                }
 
                 lock.lock();
                 m_tasks -= 1;
@@ -39,11 +78,13 @@ template <typename Arg> class ThreadPool {
 
         m_threads.reserve(numThreads);
         for (unsigned int i = 0; i < numThreads; i++) {
-            m_threads.push_back(std::thread(worker));
+            m_threads.push_back(std::thread(worker, i));
         }
     }
 
     void Wait() {
+        logger::trace::Scope wait("pool wait");
+
         std::unique_lock<std::mutex> lock(m_queueMutex);
         m_finishedCV.wait(lock, [this]() -> bool { return m_work.empty() && m_tasks == 0; });
     }
@@ -2,6 +2,8 @@
 #define KOOLANG_UTIL_DEBUG_H
 
 #include "logger/colors.h"
+#include <atomic>
+#include <cstddef>
 #include <format>
 #include <iostream>
 #include <utility>
@@ -15,21 +17,26 @@
 #define KOOLANG_MSG(TITLE, MSG, STYLE)
 #endif
 
+namespace logger {
+// reported errors, also counted when the messages are disabled
+inline std::atomic<std::size_t> g_errorCount = 0;
+}
+
 #define STRINGIZE_UTIL(X) #X
 #define STRINGIZE(X) STRINGIZE_UTIL(X)
 #define LINE_STR STRINGIZE(__LINE__)
 
 // clang-format off
 #define KOOLANG_DEBUG_MSG(...) KOOLANG_MSG("[DEBUG](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::BRIGHT_GREEN)
-#define KOOLANG_ERR_MSG(...)   KOOLANG_MSG("[ERR](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::RED)
+#define KOOLANG_ERR_MSG(...)   do { logger::g_errorCount++; KOOLANG_MSG("[ERR](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::RED); } while (0)
 #define KOOLANG_WARN_MSG(...)  KOOLANG_MSG("[WARN](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::YELLOW)
 #define KOOLANG_INFO_MSG(...)  KOOLANG_MSG("[INFO](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::CYAN)
 #define KOOLANG_FATAL_MSG(...) KOOLANG_MSG("[FATAL](" __FILE__ ":" LINE_STR ")", std::format(__VA_ARGS__), logger::Color::BRIGHT_MAGENTA)
 
 #define KOOLANG_CUSTOM_MSG(TITLE, ...) KOOLANG_MSG(TITLE, std::format(__VA_ARGS__), logger::Color::GREEN)
 #define KOOLANG_TODO() KOOLANG_MSG("[TODO](" __FILE__ ":" LINE_STR ")", "This feature is not implemented yet", logger::Color::YELLOW)
-#define KOOLANG_UNREACHABLE() KOOLANG_FATAL_MSG("Something went wrong!"); std::unreachable()
-#define KOOLANG_TODO_EXIT(...) KOOLANG_FATAL_MSG(__VA_ARGS__); std::exit(-1)
+#define KOOLANG_UNREACHABLE() do { KOOLANG_FATAL_MSG("Something went wrong!"); std::unreachable(); } while (0)
+#define KOOLANG_TODO_EXIT(...) do { KOOLANG_FATAL_MSG(__VA_ARGS__); std::exit(-1); } while (0)
 
 // clang-format on
 
@@ -0,0 +1,141 @@
+#ifndef KOOLANG_UTIL_FILE_H
+#define KOOLANG_UTIL_FILE_H
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Writes the file under a temporary name and renames it, so readers see either the old or the new content and never
+// a partial file. The temporary name is unique for the process and the thread, and the content reaches the disk before
+// the rename, so a crash leaves the old or the new file. The files which don't outlive the process skip the sync.
+// Returns false on failure.
+inline bool writeFileAtomic(const std::filesystem::path& path, std::string_view content, bool isDurable = true) {
+    std::error_code err;
+    std::filesystem::create_directories(path.parent_path(), err);
+
+    std::filesystem::path temp = path;
+#ifdef _WIN32
+    temp += ".tmp" + std::to_string(::_getpid());
+#else
+    temp += ".tmp" + std::to_string(::getpid());
+#endif
+    temp += '-' + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id()));
+
+#ifdef _WIN32
+    static_cast<void>(isDurable);
+    {
+        std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+        output.write(content.data(), static_cast<std::streamsize>(content.size()));
+        output.flush();
+
+        if (!output.good()) {
+            output.close();
+            std::filesystem::remove(temp, err);
+            return false;
+        }
+    }
+#else
+    int file = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+
+    // left by a crashed process with the same pid, no other writer uses the name
+    if (file < 0 && errno == EEXIST) {
+        ::unlink(temp.c_str());
+        file = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    }
+
+    if (file < 0) {
+        return false;
+    }
+
+    bool isWritten = true;
+    for (std::size_t offset = 0; isWritten && offset < content.size();) {
+        const ssize_t written = ::write(file, content.data() + offset, content.size() - offset);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        isWritten = written > 0;
+        offset += isWritten ? static_cast<std::size_t>(written) : 0;
+    }
+
+    isWritten = isWritten && (!isDurable || ::fsync(file) == 0);
+
+    if (::close(file) != 0 || !isWritten) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+#endif
+
+    std::filesystem::rename(temp, path, err);
+    if (err) {
+        std::filesystem::remove(temp, err);
+        return false;
+    }
+
+    return true;
+}
+
+// Read-only view of the whole file, mapped to the memory where possible. The view is empty if the file can't be read.
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+        std::ifstream input(path, std::ios::binary);
+        m_content = std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        m_view    = m_content;
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            return;
+        }
+
+        struct stat info { };
+        if (::fstat(file, &info) == 0 && info.st_size > 0) {
+            const auto size = static_cast<std::size_t>(info.st_size);
+            void* mapped    = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+            if (mapped != MAP_FAILED) {
+                m_view = std::string_view(static_cast<const char*>(mapped), size);
+            }
+        }
+
+        ::close(file);
+#endif
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (!m_view.empty()) {
+            ::munmap(const_cast<char*>(m_view.data()), m_view.size());
+        }
+#endif
+    }
+
+    [[nodiscard]] std::string_view GetView() const { return m_view; }
+
+private:
+    std::string_view m_view;
+#ifdef _WIN32
+    std::string m_content;
+#endif
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "ast/Parser.h"
+#include "kir/AstGen.h"
+#include "test.h"
+
+TEST_CASE("AstGen - Import aliases")
+{
+    File file;
+    file.Content = "import a::{b::c = d, e};\n"
+                   "import f = g;\n";
+
+    ast::Parser parser(file, "IMPORTS");
+    const ast::Ast tree = parser.Parse();
+    REQUIRE(file.ErrMsgs.empty());
+
+    kir::Kir kir;
+    kir::AstGen(kir, tree).Generate();
+
+    REQUIRE(kir.Imports.size() == 3);
+    REQUIRE(kir.ImportAliases.size() == 3);
+
+    CHECK(kir.Strings.at(kir.Imports[0]) == "a/b/c");
+    CHECK(kir.Strings.at(kir.ImportAliases[0]) == "d");
+    CHECK(kir.Strings.at(kir.Imports[1]) == "a/e");
+    CHECK(kir.ImportAliases[1] == NULL_INDEX);
+    CHECK(kir.Strings.at(kir.Imports[2]) == "f");
+    CHECK(kir.Strings.at(kir.ImportAliases[2]) == "g");
+}
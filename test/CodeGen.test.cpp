@@ -0,0 +1,287 @@
+#include "air/Inst.h"
+#include "air/Module.h"
+#include "air/ModuleManager.h"
+#include "air/Pool.h"
+#include "air/pass/PassManager.h"
+#include "codegen/CodeGen.h"
+#include "codegen/c/CBackend.h"
+#include "codegen/elf/Object.h"
+#include "codegen/x86_64/Assembler.h"
+#include "codegen/x86_64/Lower.h"
+#include "terminal/globals.h"
+#include "test.h"
+#include <filesystem>
+#include <fstream>
+#include <sys/wait.h>
+
+using namespace air;
+using namespace codegen;
+
+namespace {
+
+struct AirBuilder {
+    Pool& InternPool;
+    Air Code;
+
+    AirBuilder(Pool& pool)
+        : InternPool(pool)
+    {
+        Code.Inst.emplace_back(NULL_INDEX);
+        Code.Type.emplace_back();
+    }
+
+    Index Add(InstType type, InstData data)
+    {
+        Code.Inst.push_back(data);
+        Code.Type.push_back(type);
+        return static_cast<Index>(Code.Inst.size() - 1);
+    }
+
+    Index Const(Index ty, std::uint64_t val)
+    {
+        const Index poolIndex = InternPool.GetOrPut(PoolKey::CreateTypeValue(ty, InternPool.AddValue(val)));
+        return Add(InstType::CONSTANT, InstData::CreatePoolIndex(poolIndex));
+    }
+
+    Index Bin(InstType type, Index lhs, Index rhs) { return Add(type, InstData::CreateBinOp(lhs, rhs)); }
+};
+
+// Compiles the AIR as 'main', links it and returns the exit code of the program.
+int run(const AirBuilder& builder, Index result, const std::string& name)
+{
+    elf::Object obj;
+    x86_64::Assembler as(obj);
+    const std::vector<Index> decls;
+
+    const Index sym = obj.GetOrAddSymbol("main");
+    obj.DefineSymbol(sym, elf::SectionKind::TEXT, true, true);
+    x86_64::Lower(as, builder.Code, builder.InternPool, decls).EmitFunction(result);
+    obj.EndSymbol(sym, as.Offset());
+
+    const auto dir    = std::filesystem::temp_directory_path();
+    const auto object = dir / (name + ".o");
+    const auto binary = dir / name;
+
+    if (!obj.Write(object) || !CodeGen::Link(object, binary)) {
+        return -1;
+    }
+
+    const int status = std::system(binary.string().c_str());
+
+    std::filesystem::remove(object);
+    std::filesystem::remove(binary);
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Builds the source as 'main.k' like 'build bin' and returns the exit code of the program, -1 if the build fails.
+// The optimized builds go through the C backend.
+int runSource(const std::string& source, air::pass::OptLevel level, const std::string& name)
+{
+    using globals::Config;
+
+    const auto dir    = std::filesystem::temp_directory_path() / name;
+    const auto binary = dir / "main";
+
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "main.k") << source;
+
+    globals::g_config.Flags      = static_cast<Config::Options>(globals::g_config.Flags | Config::NO_CACHE);
+    globals::g_config.Command    = Config::Command::BUILD_BIN;
+    globals::g_config.InputFile  = (dir / "main.k").string();
+    globals::g_config.WorkingDir = dir;
+    logger::g_errorCount         = 0;
+
+    air::ModuleManager manager;
+    air::Module* mod = manager.GenZir();
+    REQUIRE(mod != nullptr);
+
+    if (mod->CompStatus == air::Module::Status::ERROR) {
+        return -1;
+    }
+
+    manager.GenAir(mod);
+    if (logger::g_errorCount != 0) {
+        return -1;
+    }
+
+    using air::pass::PassManager;
+
+    PassManager passes(manager.InternPool, PassManager::CollectUnits(manager), PassManager::GetPipeline(level));
+    passes.Run();
+
+    bool isBuilt = false;
+
+    if (level == air::pass::OptLevel::O2) {
+        c::CBackend backend(manager, mod, dir / "main.build");
+        isBuilt = backend.Build() && backend.Link(binary);
+    } else {
+        CodeGen gen(manager, mod);
+        isBuilt = gen.Generate() && gen.WriteObject(dir / "main.o") && CodeGen::Link(dir / "main.o", binary);
+    }
+
+    const int status = isBuilt ? std::system(binary.string().c_str()) : -1;
+
+    std::filesystem::remove_all(dir);
+
+    return (isBuilt && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
+}
+
+TEST_CASE("CodeGen - Arithmetic")
+{
+    Pool pool;
+    AirBuilder b(pool);
+
+    const Index i64 = pool::keys::I64_KEY_INDEX;
+
+    // (100 / 7) * 3 + 100 % 7 - 1
+    const Index hundred = b.Const(i64, 100);
+    const Index seven   = b.Const(i64, 7);
+    const Index div     = b.Bin(InstType::DIV, hundred, seven);
+    const Index mul     = b.Bin(InstType::MUL, div, b.Const(i64, 3));
+    const Index mod     = b.Bin(InstType::MOD, hundred, seven);
+    const Index add     = b.Bin(InstType::ADD, mul, mod);
+    const Index sub     = b.Bin(InstType::SUB, add, b.Const(i64, 1));
+
+    CHECK_EQ(run(b, sub, "koolang_codegen_arith"), 43);
+}
+
+TEST_CASE("CodeGen - Spilling")
+{
+    Pool pool;
+    AirBuilder b(pool);
+
+    // all constants are alive until they are summed, so some of them must be spilled
+    std::vector<Index> values;
+    for (std::uint64_t i = 1; i <= 20; i++) {
+        values.push_back(b.Const(pool::keys::U64_KEY_INDEX, i));
+    }
+
+    Index sum = values.front();
+    for (std::size_t i = 1; i < values.size(); i++) {
+        sum = b.Bin(InstType::ADD, sum, values[i]);
+    }
+
+    CHECK_EQ(run(b, sum, "koolang_codegen_spill"), 210);
+}
+
+TEST_CASE("CodeGen - Integer width")
+{
+    Pool pool;
+    AirBuilder b(pool);
+
+    const Index i8 = pool::keys::I8_KEY_INDEX;
+
+    // (100 + 100) overflows to -56, -56 >> 4 = -4
+    const Index sum   = b.Bin(InstType::ADD, b.Const(i8, 100), b.Const(i8, 100));
+    const Index shift = b.Bin(InstType::BIT_SHR, sum, b.Const(i8, 4));
+
+    CHECK_EQ(run(b, shift, "koolang_codegen_width"), 252);
+}
+
+TEST_CASE("CodeGen - Init order")
+{
+    // the initializers run in the order of the references, not of the decls
+    const std::string source = "pub const main : i32 = A + 1;\n"
+                               "pub const A : i32 = B + 2;\n"
+                               "pub const B : i32 = C + 3;\n"
+                               "pub const C : i32 = 4;\n";
+
+    CHECK_EQ(runSource(source, air::pass::OptLevel::O0, "koolang_codegen_init"), 10);
+    CHECK_EQ(runSource(source, air::pass::OptLevel::O2, "koolang_codegen_init_c"), 10);
+}
+
+TEST_CASE("CodeGen - Build binary")
+{
+    using air::pass::OptLevel;
+
+    // the unsigned byte wraps, (100 * 3) % 256 + 49 % 5 = 48
+    const std::string globals = "pub const main : u8 = A * 3 + B % 5;\n"
+                                "pub const A : u8 = 100;\n"
+                                "pub const B : u8 = C - 1;\n"
+                                "pub const C : u8 = 50;\n";
+
+    CHECK_EQ(runSource(globals, OptLevel::O0, "koolang_codegen_bin"), 48);
+    CHECK_EQ(runSource("pub fn main() : i32 {}\n", OptLevel::O0, "koolang_codegen_bin_fn"), 0);
+
+    // the bodies aren't lowered yet, the build fails instead of emitting the empty function
+    CHECK_EQ(runSource("pub fn main() : i32 { return 3; }\n", OptLevel::O0, "koolang_codegen_bin_body"), -1);
+}
+
+TEST_CASE("CodeGen - C backend")
+{
+    using air::pass::OptLevel;
+
+    const std::string globals = "pub const main : u8 = A * 3 + B % 5;\n"
+                                "pub const A : u8 = 100;\n"
+                                "pub const B : u8 = C - 1;\n"
+                                "pub const C : u8 = 50;\n";
+
+    CHECK_EQ(runSource(globals, OptLevel::O2, "koolang_codegen_c"), 48);
+    CHECK_EQ(runSource("pub fn main() : i32 {}\n", OptLevel::O2, "koolang_codegen_c_fn"), 0);
+
+    // the chain crosses the translation units, D0 = 300 and the exit code is 300 % 256
+    std::string chain = "pub const main : i32 = D0 + 0;\n";
+    constexpr std::size_t CHAIN = c::CBackend::UNIT_DECLS + 44;
+
+    for (std::size_t i = 0; i + 1 < CHAIN; i++) {
+        chain += "pub const D" + std::to_string(i) + " : i32 = D" + std::to_string(i + 1) + " + 1;\n";
+    }
+    chain += "pub const D" + std::to_string(CHAIN - 1) + " : i32 = 1;\n";
+
+    CHECK_EQ(runSource(chain, OptLevel::O2, "koolang_codegen_c_units"), 44);
+    CHECK_EQ(runSource(chain, OptLevel::O0, "koolang_codegen_c_units_o0"), 44);
+}
+
+TEST_CASE("CodeGen - Shift and division")
+{
+    using air::pass::OptLevel;
+
+    // the shift count is masked by the width of the type, 36 & 31 = 4 and 33 & 31 = 1
+    const std::string shifts = "pub const main : i32 = R + L;\n"
+                               "pub const R : i32 = A >> S;\n"
+                               "pub const L : i32 = C << T;\n"
+                               "pub const A : i32 = 1024;\n"
+                               "pub const S : i32 = 36;\n"
+                               "pub const C : i32 = 3;\n"
+                               "pub const T : i32 = 33;\n";
+
+    CHECK_EQ(runSource(shifts, OptLevel::O0, "koolang_codegen_shift"), 70);
+    CHECK_EQ(runSource(shifts, OptLevel::O2, "koolang_codegen_shift_c"), 70);
+
+    // 9 & 7 = 1
+    const std::string bytes = "pub const main : u8 = C << T;\n"
+                              "pub const C : u8 = 3;\n"
+                              "pub const T : u8 = 9;\n";
+
+    CHECK_EQ(runSource(bytes, OptLevel::O0, "koolang_codegen_shift_u8"), 6);
+    CHECK_EQ(runSource(bytes, OptLevel::O2, "koolang_codegen_shift_u8_c"), 6);
+
+    // INT32_MIN / -1 wraps to INT32_MIN and INT32_MIN % -1 is zero
+    const std::string division = "pub const main : i32 = MIN / N + MIN % N + 7;\n"
+                                 "pub const MIN : i32 = N << 31;\n"
+                                 "pub const N : i32 = M - 65;\n"
+                                 "pub const M : i32 = 64;\n";
+
+    CHECK_EQ(runSource(division, OptLevel::O0, "koolang_codegen_div"), 7);
+    CHECK_EQ(runSource(division, OptLevel::O2, "koolang_codegen_div_c"), 7);
+
+    // 'idiv' would trap on INT64_MIN / -1 and INT64_MIN % -1
+    const std::string quotient = "pub const main : i64 = MIN / N + 7;\n"
+                                 "pub const MIN : i64 = N << 63;\n"
+                                 "pub const N : i64 = M - 65;\n"
+                                 "pub const M : i64 = 64;\n";
+
+    const std::string remainder = "pub const main : i64 = MIN % N + 7;\n"
+                                  "pub const MIN : i64 = N << 63;\n"
+                                  "pub const N : i64 = M - 65;\n"
+                                  "pub const M : i64 = 64;\n";
+
+    CHECK_EQ(runSource(quotient, OptLevel::O0, "koolang_codegen_div_i64"), 7);
+    CHECK_EQ(runSource(remainder, OptLevel::O0, "koolang_codegen_mod_i64"), 7);
+    CHECK_EQ(runSource(quotient, OptLevel::O2, "koolang_codegen_div_i64_c"), 7);
+    CHECK_EQ(runSource(remainder, OptLevel::O2, "koolang_codegen_mod_i64_c"), 7);
+}
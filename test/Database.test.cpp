@@ -0,0 +1,42 @@
+#include "Project.h"
+#include "query/Database.h"
+#include "test.h"
+
+using test::Project;
+
+TEST_CASE("Database - Decl signatures")
+{
+    Project project("koolang_decl_signatures");
+    project.Write("b.k", "pub const C : i32 = 3;\n");
+    project.Write("main.k", "import b::{C};\npub const X : i32 = A;\npub const A : i32 = C + 1;\n");
+
+    query::Database database;
+
+    CHECK(project.Build(true, &database).Errors == 0);
+    const auto first = database.GetSignatureStats();
+    CHECK(first.Computed == 3);
+
+    // the runtime value of A changed, but not its type, so X keeps its signature
+    project.Write("main.k", "import b::{C};\npub const X : i32 = A;\npub const A : i32 = C + 2;\n");
+
+    CHECK(project.Build(true, &database).Errors == 0);
+    const auto second = database.GetSignatureStats();
+    CHECK(second.Computed - first.Computed == 1);
+    CHECK(second.Reused - first.Reused == 2);
+
+    // the comptime value is the part of the signature, only the decls reading C are computed again
+    project.Write("b.k", "pub const C : i32 = 4;\n");
+
+    CHECK(project.Build(true, &database).Errors == 0);
+    const auto third = database.GetSignatureStats();
+    CHECK(third.Computed - second.Computed == 2);
+    CHECK(third.Reused - second.Reused == 1);
+
+    // the name resolves to the other decl with the same tokens, every decl of the file reads the changed scope
+    project.Write("b.k", "pub const C : i32 = 4;\npub const D : i32 = 4;\n");
+    project.Write("main.k", "import b::{D = C};\npub const X : i32 = A;\npub const A : i32 = C + 2;\n");
+
+    CHECK(project.Build(true, &database).Errors == 0);
+    const auto fourth = database.GetSignatureStats();
+    CHECK(fourth.Computed - third.Computed == 3);
+}
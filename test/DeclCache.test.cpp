@@ -0,0 +1,71 @@
+#include "Project.h"
+#include "test.h"
+
+using test::Project;
+
+TEST_CASE("DeclCache - Reuse")
+{
+    Project project("koolang_decl_cache_reuse");
+    project.Write("main.k", "pub const A : i32 = 1;\npub const B : i32 = A;\n");
+
+    const auto first = project.Build();
+    CHECK(first.Restored == 0);
+    CHECK(first.Values.at("B") == 1);
+
+    const auto second = project.Build();
+    CHECK(second.Restored == 2);
+    CHECK(second.Values.at("A") == 1);
+    CHECK(second.Values.at("B") == 1);
+
+    // the comments and the whitespace keep the tokens
+    project.Write("main.k", "// values\npub const A : i32 = 1;\n\npub const B : i32 =  A;\n");
+
+    const auto third = project.Build();
+    CHECK(third.Restored == 2);
+    CHECK(third.Values.at("B") == 1);
+}
+
+TEST_CASE("DeclCache - Invalidation")
+{
+    Project project("koolang_decl_cache_invalidation");
+    project.Write("b.k", "pub const C : i32 = 3;\n");
+    project.Write("main.k", "import b::{C};\npub const A : i32 = 1;\npub const B : i32 = C;\n");
+
+    const auto first = project.Build();
+    CHECK(first.Errors == 0);
+    CHECK(first.Values.at("B") == 3);
+
+    // the changed decl is analyzed again, the other decls are restored
+    project.Write("main.k", "import b::{C};\npub const A : i32 = 2;\npub const B : i32 = C;\n");
+
+    const auto second = project.Build();
+    CHECK(second.Values.at("A") == 2);
+    CHECK(second.Values.at("B") == 3);
+    CHECK(second.Restored == 2);
+
+    // the signature of the dependency in the other module changed
+    project.Write("b.k", "pub const C : i32 = 7;\n");
+
+    const auto third = project.Build();
+    CHECK(third.Values.at("B") == 7);
+    CHECK(third.Restored == 1);
+}
+
+TEST_CASE("DeclCache - Imports")
+{
+    Project project("koolang_decl_cache_imports");
+    project.Write("a.k", "pub const FOO : i32 = 1;\npub const BAR : i32 = 3;\n");
+    project.Write("b.k", "pub const FOO : i32 = 5;\n");
+    project.Write("main.k", "import a::{FOO, BAR};\nimport b::{FOO = Z};\npub const X : i32 = FOO;\n");
+
+    CHECK(project.Build().Values.at("X") == 1);
+    CHECK(project.Build().Values.at("X") == 1);
+
+    // the same tokens of the decl name the other decl
+    project.Write("main.k", "import a::{BAR};\nimport b::{FOO};\npub const X : i32 = FOO;\n");
+    CHECK(project.Build().Values.at("X") == 5);
+
+    // the local decl hides the imported one
+    project.Write("main.k", "import a::{BAR};\nimport b::{FOO};\npub const X : i32 = FOO;\npub const FOO : i32 = 9;\n");
+    CHECK(project.Build().Values.at("X") == 9);
+}
@@ -0,0 +1,120 @@
+#include "Project.h"
+#include "air/ImportResolver.h"
+#include "air/ModuleManager.h"
+#include "terminal/globals.h"
+#include "test.h"
+#include <string>
+
+using test::Project;
+
+TEST_CASE("ImportResolver - Resolve")
+{
+    Project project("koolang_import_resolver_resolve");
+    project.Write("a/b.k", "");
+    project.Write("a/c/mod.k", "");
+    project.Write("a/d/e.k", "");
+
+    air::ImportResolver resolver;
+    const auto& dir = project.GetDir();
+
+    CHECK(resolver.Resolve(dir, "a/b") == std::filesystem::path("a/b.k"));
+    CHECK(resolver.Resolve(dir, "a/c") == std::filesystem::path("a/c/mod.k"));
+    CHECK(resolver.Resolve(dir, "a/d/e") == std::filesystem::path("a/d/e.k"));
+
+    // the directory without 'mod.k' isn't the module
+    CHECK_FALSE(resolver.Resolve(dir, "a/d").has_value());
+    CHECK_FALSE(resolver.Resolve(dir, "a/b/c").has_value());
+    CHECK_FALSE(resolver.Resolve(dir, "missing").has_value());
+    CHECK_FALSE(resolver.Resolve(dir, "").has_value());
+
+    // the listings are read once, the file added later is found by the resolver of the next build
+    project.Write("a/f.k", "");
+    CHECK_FALSE(resolver.Resolve(dir, "a/f").has_value());
+    CHECK(air::ImportResolver().Resolve(dir, "a/f") == std::filesystem::path("a/f.k"));
+}
+
+TEST_CASE("ImportResolver - Search path order")
+{
+    Project project("koolang_import_resolver_order");
+    project.Write("first/m.k", "pub const M : i32 = 1;\n");
+    project.Write("second/m.k", "pub const M : i32 = 2;\n");
+    project.Write("second/n.k", "pub const N : i32 = 3;\n");
+    project.Write("main.k", "import m::{M};\nimport n::{N};\npub const X : i32 = M;\npub const Y : i32 = N;\n");
+
+    // the import paths are searched in their order after the working directory
+    globals::g_config.ImportPaths = { project.GetDir() / "first", project.GetDir() / "second" };
+
+    const auto result = project.Build(true);
+    CHECK(result.Errors == 0);
+    CHECK(result.Values.at("X") == 1);
+    CHECK(result.Values.at("Y") == 3);
+
+    // the working directory comes first
+    project.Write("m.k", "pub const M : i32 = 4;\n");
+    CHECK(project.Build(true).Values.at("X") == 4);
+
+    // the directory of the importer comes before the search paths
+    project.Write("sub/m.k", "pub const M : i32 = 5;\n");
+    project.Write("sub/s.k", "import m::{M};\npub const S : i32 = M;\n");
+    project.Write("main.k", "import sub::s::{S};\npub const X : i32 = S;\n");
+    CHECK(project.Build(true).Values.at("X") == 5);
+
+    globals::g_config.ImportPaths.clear();
+}
+
+TEST_CASE("ImportResolver - Decl fallback")
+{
+    Project project("koolang_import_resolver_decl_fallback");
+    project.Write("a/b.k", "pub const C : i32 = 1;\n");
+    project.Write("main.k", "import a::{b::C};\npub const X : i32 = C;\n");
+
+    project.Configure("main.k", true);
+
+    air::ModuleManager manager;
+    air::Module* mod = manager.GenZir();
+    REQUIRE(mod->CompStatus != air::Module::Status::ERROR);
+
+    // the module itself, the module of the parent path with the decl in the item, nothing
+    std::string item;
+    air::Module* module = manager.GetOrAddImport("a/b", mod->NamespaceIndex, false, item);
+    REQUIRE(module != nullptr);
+    CHECK(item.empty());
+
+    CHECK(manager.GetOrAddImport("a/b/C", mod->NamespaceIndex, false, item) == module);
+    CHECK(item == "C");
+
+    item.clear();
+    CHECK(manager.GetOrAddImport("a/missing/C", mod->NamespaceIndex, false, item) == nullptr);
+    CHECK(item.empty());
+
+    manager.GenAir(mod);
+    CHECK(logger::g_errorCount == 0);
+}
+
+TEST_CASE("ImportResolver - Unresolved import")
+{
+    Project project("koolang_import_resolver_unresolved");
+    project.Write("main.k", "import missing::{M};\npub const X : i32 = 1;\n");
+
+    // the missing module is reported once, the other decls are analyzed
+    const auto result = project.Build(true);
+    CHECK(result.Errors == 1);
+    CHECK(result.Values.at("X") == 1);
+}
+
+TEST_CASE("ImportResolver - Selective imports")
+{
+    Project project("koolang_selective_imports");
+    project.Write("a/b.k", "pub const B : i32 = 1;\npub const UNUSED : i32 = 2;\n");
+    project.Write("a/c.k", "pub const C : i32 = 3;\n");
+    project.Write("main.k", "import a::{b::B};\npub const X : i32 = B;\n");
+
+    // the sibling module isn't loaded and the sibling decl isn't analyzed
+    const auto result = project.Build(true);
+    CHECK(result.Errors == 0);
+    CHECK(result.Values.at("X") == 1);
+    CHECK(result.Modules == 2);
+    CHECK(result.Analyzed.contains("B"));
+    CHECK_FALSE(result.Analyzed.contains("UNUSED"));
+    CHECK_FALSE(result.Analyzed.contains("C"));
+}
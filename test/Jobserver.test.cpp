@@ -0,0 +1,98 @@
+#include "test.h"
+#include "util/Jobserver.h"
+#include <filesystem>
+#include <string>
+#include <sys/stat.h>
+
+using jobs::Jobserver;
+
+namespace {
+
+// Reads the tokens left in the jobserver without blocking
+int countTokens(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    int count = 0;
+    char token;
+    while (::read(fd, &token, 1) == 1) {
+        count++;
+    }
+
+    ::fcntl(fd, F_SETFL, flags);
+    return count;
+}
+
+}
+
+TEST_CASE("Jobserver - Pipe")
+{
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    REQUIRE(::write(fds[1], "++", 2) == 2);
+
+    const std::string auth = std::to_string(fds[0]) + "," + std::to_string(fds[1]);
+    {
+        auto jobserver = Jobserver::FromMakeflags("-j3 --jobserver-auth=" + auth);
+        REQUIRE(jobserver != nullptr);
+
+        // the implicit token first, then the tokens of the pipe
+        CHECK(jobserver->Acquire() == Jobserver::Token::IMPLICIT);
+        CHECK(jobserver->Acquire() == Jobserver::Token::SHARED);
+        CHECK(jobserver->Acquire() == Jobserver::Token::SHARED);
+
+        jobserver->Release(Jobserver::Token::SHARED);
+        CHECK(countTokens(fds[0]) == 1);
+    }
+
+    // the held token is written back by the destructor
+    CHECK(countTokens(fds[0]) == 1);
+
+    // the last option wins, the old make versions name it '--jobserver-fds'
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=bad --jobserver-fds=" + auth) != nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-fds=" + auth + " --jobserver-auth=bad") == nullptr);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_CASE("Jobserver - Fifo")
+{
+    const auto path = std::filesystem::temp_directory_path() / "koolang_jobserver_fifo";
+    std::filesystem::remove(path);
+    REQUIRE(::mkfifo(path.c_str(), 0600) == 0);
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+    REQUIRE(fd >= 0);
+    REQUIRE(::write(fd, "+", 1) == 1);
+    {
+        auto jobserver = Jobserver::FromMakeflags("-j2 --jobserver-auth=fifo:" + path.string());
+        REQUIRE(jobserver != nullptr);
+
+        CHECK(jobserver->Acquire() == Jobserver::Token::IMPLICIT);
+        CHECK(jobserver->Acquire() == Jobserver::Token::SHARED);
+        CHECK(countTokens(fd) == 0);
+    }
+    CHECK(countTokens(fd) == 1);
+
+    ::close(fd);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Jobserver - Missing and malformed flags")
+{
+    CHECK(Jobserver::FromMakeflags("") == nullptr);
+    CHECK(Jobserver::FromMakeflags("-j4 -k") == nullptr);
+
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=3") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=a,b") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=0x,1") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=-1,-1") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=,") == nullptr);
+
+    // the descriptors aren't open, the rule isn't marked as recursive
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=998,999") == nullptr);
+    CHECK(Jobserver::FromMakeflags("--jobserver-auth=fifo:/nonexistent/koolang_fifo") == nullptr);
+}
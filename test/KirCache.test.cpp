@@ -0,0 +1,41 @@
+#include "kir/Cache.h"
+#include "kir/Inst.h"
+#include "test.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+TEST_CASE("KirCache - Damaged header")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "koolang_kir_cache_damaged";
+    std::filesystem::remove_all(dir);
+
+    kir::Kir kir;
+    kir.Inst.resize(3);
+    kir.Type.resize(3);
+    kir.Extra      = { 1, 2, 3 };
+    kir.Strings    = { "main", "A" };
+    kir.DeclHashes = { 7 };
+
+    const std::uint64_t key = kir::cache::computeKey(42);
+    const auto path         = kir::cache::getPath(dir, key);
+    REQUIRE(kir::cache::store(path, key, kir, "", false));
+
+    kir::Kir loaded;
+    std::string messages;
+    REQUIRE(kir::cache::load(path, key, loaded, messages));
+    CHECK(loaded.Extra == kir.Extra);
+    CHECK(loaded.Strings == kir.Strings);
+
+    // the extra count times 4 wraps around to the same layout, the file is still rejected
+    constexpr std::streamoff EXTRA_COUNT = 24;
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint64_t wrapped = kir.Extra.size() + (std::uint64_t { 1 } << 62);
+        file.seekp(EXTRA_COUNT);
+        file.write(reinterpret_cast<const char*>(&wrapped), sizeof(wrapped));
+    }
+    CHECK_FALSE(kir::cache::load(path, key, loaded, messages));
+
+    std::filesystem::remove_all(dir);
+}
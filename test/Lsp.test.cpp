@@ -0,0 +1,208 @@
+#include "lsp/Document.h"
+#include "lsp/Json.h"
+#include "lsp/Server.h"
+#include "test.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace lsp;
+
+namespace {
+
+std::string frame(const json::Value& message)
+{
+    const std::string body = message.Dump();
+    return "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+void unframe(const std::string& output, std::vector<json::Value>& messages)
+{
+    std::size_t pos = 0;
+    while (pos < output.size()) {
+        const std::size_t header = output.find("\r\n\r\n", pos);
+        REQUIRE(header != std::string::npos);
+
+        const std::size_t length = std::stoul(output.substr(pos + 16, header - pos - 16));
+        json::Value message;
+        REQUIRE(json::Value::Parse(std::string_view(output).substr(header + 4, length), message));
+
+        messages.push_back(std::move(message));
+        pos = header + 4 + length;
+    }
+}
+
+json::Value request(int id, std::string_view method, json::Value params)
+{
+    return json::Value::Object()
+        .Set("jsonrpc", "2.0")
+        .Set("id", id)
+        .Set("method", method)
+        .Set("params", std::move(params));
+}
+
+json::Value notification(std::string_view method, json::Value params)
+{
+    return json::Value::Object().Set("jsonrpc", "2.0").Set("method", method).Set("params", std::move(params));
+}
+
+json::Value textPosition(const std::string& uri, std::uint32_t line, std::uint32_t character)
+{
+    return json::Value::Object()
+        .Set("textDocument", json::Value::Object().Set("uri", uri))
+        .Set("position", dumpPosition(Position { .Line = line, .Character = character }));
+}
+
+json::Value change(const std::string& uri, std::int64_t version, Position start, Position end, std::string_view text)
+{
+    json::Value range   = json::Value::Object().Set("start", dumpPosition(start)).Set("end", dumpPosition(end));
+    json::Value changes = json::Value::Array();
+    changes.Push(json::Value::Object().Set("range", std::move(range)).Set("text", text));
+
+    return json::Value::Object()
+        .Set("textDocument", json::Value::Object().Set("uri", uri).Set("version", version))
+        .Set("contentChanges", std::move(changes));
+}
+
+const json::Value* findReply(const std::vector<json::Value>& messages, int id)
+{
+    for (const json::Value& message : messages) {
+        if (message["id"].AsInt() == id && message["method"].IsNull()) {
+            return &message;
+        }
+    }
+
+    return nullptr;
+}
+
+}
+
+TEST_CASE("Json - Round trip")
+{
+    json::Value value;
+    REQUIRE(json::Value::Parse(R"({"a": [1, -2.5, true, null], "b": "x\"é😀"})", value));
+
+    CHECK(value["a"].Items().size() == 4);
+    CHECK(value["a"].Items()[0].AsInt() == 1);
+    CHECK(value["a"].Items()[2].AsBool());
+    CHECK(value["a"].Items()[3].IsNull());
+    CHECK(value["b"].AsString() == "x\"\xc3\xa9\xf0\x9f\x98\x80");
+    CHECK(value["missing"].IsNull());
+    CHECK(value.Dump() == R"({"a":[1,-2.5,true,null],"b":"x\"é😀"})");
+
+    // the integers are exact beyond the precision of double
+    REQUIRE(json::Value::Parse("[9007199254740993, 1e3, 0.5]", value));
+    CHECK(value.Items()[0].AsInt() == 9007199254740993);
+    CHECK(value.Dump() == "[9007199254740993,1000,0.5]");
+
+    CHECK_FALSE(json::Value::Parse("{\"a\":}", value));
+    CHECK_FALSE(json::Value::Parse("[1,2", value));
+    CHECK_FALSE(json::Value::Parse("1 2", value));
+}
+
+TEST_CASE("Lsp - Document positions")
+{
+    // 'é' is one UTF-16 unit, '😀' is two
+    const std::string text = "ab\n\xc3\xa9\xf0\x9f\x98\x80x\n";
+
+    CHECK(toOffset(text, Position { .Line = 1, .Character = 0 }) == 3);
+    CHECK(toOffset(text, Position { .Line = 1, .Character = 1 }) == 5);
+    CHECK(toOffset(text, Position { .Line = 1, .Character = 3 }) == 9);
+    CHECK(toOffset(text, Position { .Line = 1, .Character = 99 }) == 10);
+    CHECK(toPosition(text, 9).Character == 3);
+
+    Document doc;
+    doc.Text = "const A : i32 = 1;\n";
+    doc.ApplyChange(change("", 0, { 0, 16 }, { 0, 17 }, "42")["contentChanges"].Items()[0]);
+    CHECK(doc.Text == "const A : i32 = 42;\n");
+
+    CHECK(uriToPath("file:///tmp/a%20b/../c.k") == "/tmp/c.k");
+    CHECK(pathToUri("/tmp/a b.k") == "file:///tmp/a%20b.k");
+}
+
+TEST_CASE("Lsp - Scripted session")
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "koolang-lsp-test";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "lib.k") << "pub const X : i32 = 40;\nconst Y : i32 = 2;\n";
+
+    const std::string text = "import lib;\nconst main : i32 = A + 1;\nconst A : i32 = 41;\n";
+    std::ofstream(dir / "main.k") << text;
+
+    const std::string uri = pathToUri(dir / "main.k");
+
+    // every cycle edits the document and asks for a definition
+    constexpr int CYCLES = 50;
+
+    std::string input;
+    input += frame(request(1, "initialize", json::Value::Object()));
+    input += frame(notification("textDocument/didOpen",
+                                json::Value::Object().Set("textDocument",
+                                                          json::Value::Object()
+                                                              .Set("uri", uri)
+                                                              .Set("languageId", "koolang")
+                                                              .Set("version", 1)
+                                                              .Set("text", text))));
+    input += frame(request(2, "textDocument/definition", textPosition(uri, 1, 19)));
+    input += frame(notification("textDocument/didChange", change(uri, 2, { 1, 23 }, { 1, 24 }, "lib::X")));
+    input += frame(request(3, "textDocument/definition", textPosition(uri, 1, 28)));
+    input += frame(request(4, "textDocument/completion", textPosition(uri, 1, 28)));
+    input += frame(notification("textDocument/didChange", change(uri, 3, { 2, 15 }, { 2, 18 }, "")));
+    input += frame(request(5, "textDocument/definition", textPosition(uri, 2, 6)));
+    for (int i = 0; i < CYCLES; i++) {
+        input += frame(notification("textDocument/didChange",
+                                    change(uri, 4 + i, { 2, 15 }, { 2, i == 0 ? 15U : 17U }, std::to_string(10 + i))));
+        input += frame(request(100 + i, "textDocument/definition", textPosition(uri, 1, 19)));
+    }
+    input += frame(request(6, "shutdown", json::Value()));
+    input += frame(notification("exit", json::Value()));
+
+    std::istringstream in(input);
+    std::ostringstream out;
+
+    const auto start = std::chrono::steady_clock::now();
+    CHECK(Server(in, out).Run() == 0);
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    MESSAGE("session of " << CYCLES << " edit/definition cycles took " << elapsed.count() << " ms");
+
+    std::vector<json::Value> messages;
+    unframe(out.str(), messages);
+
+    const json::Value* init = findReply(messages, 1);
+    REQUIRE(init != nullptr);
+    CHECK((*init)["result"]["capabilities"]["definitionProvider"].AsBool());
+
+    // 'A' is declared on the third line
+    const json::Value* local = findReply(messages, 2);
+    REQUIRE(local != nullptr);
+    CHECK((*local)["result"]["range"]["start"]["line"].AsInt() == 2);
+
+    // 'lib::X' is declared in the other module
+    const json::Value* imported = findReply(messages, 3);
+    REQUIRE(imported != nullptr);
+    CHECK((*imported)["result"]["uri"].AsString() == pathToUri(dir / "lib.k"));
+    CHECK((*imported)["result"]["range"]["start"]["character"].AsInt() == 10);
+
+    const json::Value* completion = findReply(messages, 4);
+    REQUIRE(completion != nullptr);
+    CHECK((*completion)["result"].Items().size() == 2);
+
+    // the syntax error is reported, the last edit fixes it again
+    bool hasError = false;
+    for (const json::Value& message : messages) {
+        if (message["method"].AsString() == "textDocument/publishDiagnostics"
+            && !message["params"]["diagnostics"].Items().empty()) {
+            hasError = true;
+        }
+    }
+    CHECK(hasError);
+    CHECK(messages.back()["id"].AsInt() == 6);
+
+    const json::Value* last = findReply(messages, 100 + CYCLES - 1);
+    REQUIRE(last != nullptr);
+    CHECK((*last)["result"]["range"]["start"]["line"].AsInt() == 2);
+
+    std::filesystem::remove_all(dir);
+}
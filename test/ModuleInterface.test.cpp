@@ -0,0 +1,54 @@
+#include "Project.h"
+#include "test.h"
+
+using test::Project;
+
+TEST_CASE("ModuleInterface - Imports")
+{
+    Project project("koolang_module_interface_imports");
+    project.Write("c.k", "pub const C : i32 = 3;\n");
+    project.Write("lib.k", "import c::{C};\npub const L : i32 = C;\n");
+    project.Write("main.k", "import lib::{L};\npub const X : i32 = L;\n");
+
+    REQUIRE(project.BuildInterface("lib.k"));
+
+    const auto first = project.Build();
+    CHECK(first.Interfaces == 1);
+    CHECK(first.Values.at("X") == 3);
+
+    // the build without the caches reads the source of the library
+    CHECK(project.Build(true).Interfaces == 0);
+
+    // the library didn't change, but the value it imports did
+    project.Write("c.k", "pub const C : i32 = 7;\n");
+
+    const auto second = project.Build();
+    CHECK(second.Interfaces == 0);
+    CHECK(second.Values.at("X") == 7);
+
+    // the interface written again records the new tokens
+    REQUIRE(project.BuildInterface("lib.k"));
+    project.Write("c.k", "// the comments keep the tokens\npub const C : i32 = 7;\n");
+
+    const auto third = project.Build();
+    CHECK(third.Interfaces == 1);
+    CHECK(third.Values.at("X") == 7);
+}
+
+TEST_CASE("ModuleInterface - Visibility")
+{
+    Project project("koolang_module_interface_visibility");
+    project.Write("lib.k", "const P : i32 = 1;\npub const L : i32 = 2;\n");
+    project.Write("main.k", "import lib::{P};\npub const X : i32 = P;\n");
+
+    // the private decl is rejected from the source and from the interface alike
+    CHECK(project.Build().Errors != 0);
+
+    project.Write("main.k", "import lib::{L};\npub const X : i32 = L;\n");
+    REQUIRE(project.BuildInterface("lib.k"));
+    project.Write("main.k", "import lib::{P};\npub const X : i32 = P;\n");
+
+    const auto result = project.Build();
+    CHECK(result.Interfaces == 1);
+    CHECK(result.Errors != 0);
+}
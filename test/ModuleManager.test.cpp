@@ -0,0 +1,80 @@
+#include "Project.h"
+#include "air/Module.h"
+#include "air/ModuleManager.h"
+#include "terminal/globals.h"
+#include "test.h"
+#include <string>
+#include <unordered_map>
+
+using test::Project;
+
+TEST_CASE("ModuleManager - Spilled KIR")
+{
+    Project project("koolang_module_manager_spilled_kir");
+    project.Write("c.k", "pub const E : i32 = 4;\n");
+    project.Write("b.k", "import c::{E};\npub const B : i32 = E;\npub const D : i32 = 5;\n");
+    project.Write("main.k", "import b::{B};\npub const X : i32 = B;\npub const C : i32 = 2;\n");
+
+    // every KIR is over the budget of one byte
+    globals::g_config.MaxMemory = 1;
+    project.Configure("main.k", true);
+
+    air::ModuleManager manager;
+    air::Module* mod = manager.GenZir();
+    REQUIRE(mod->CompStatus != air::Module::Status::ERROR);
+
+    for (const auto& loaded : manager.GetModules()) {
+        CHECK(isNull(loaded->Kir.get()));
+        CHECK_FALSE(loaded->KirSpill.empty());
+    }
+
+    // the KIR is loaded again for the analysis and released after it
+    manager.GenAir(mod);
+
+    const auto result = Project::Collect(manager, mod);
+    CHECK(result.Errors == 0);
+    CHECK(result.Values.at("X") == 4);
+    CHECK(result.Values.at("C") == 2);
+
+    for (const auto& loaded : manager.GetModules()) {
+        CHECK(isNull(loaded->Kir.get()));
+        CHECK(loaded->KirSpill.empty());
+    }
+
+    globals::g_config.MaxMemory = 0;
+}
+
+TEST_CASE("ModuleManager - Unreached decls")
+{
+    Project project("koolang_module_manager_unreached_decls");
+    project.Write("b.k", "pub const B : i32 = 2;\npub const UNUSED_B : i32 = B;\n");
+    project.Write("main.k", "import b::{B};\npub const X : i32 = A;\nconst A : i32 = B;\nconst UNUSED : i32 = 4;\n");
+
+    project.Configure("main.k", true);
+
+    air::ModuleManager manager;
+    air::Module* mod = manager.GenZir();
+    REQUIRE(mod->CompStatus != air::Module::Status::ERROR);
+    manager.GenAir(mod);
+
+    // the pub decls of the library are the roots, the decls they don't reach keep their state and have no AIR
+    std::unordered_map<std::string, const air::Sema*> semas;
+    for (const auto& loaded : manager.GetModules()) {
+        for (const auto& sema : loaded->Semas) {
+            semas[std::string(sema.GetRecord()->Name)] = &sema;
+        }
+    }
+
+    for (const char* name : { "X", "A", "B" }) {
+        CHECK(semas.at(name)->GetRecord()->StatusBody == air::symbol::Record::State::COMPLETE);
+        CHECK_FALSE(semas.at(name)->GetAir().Inst.empty());
+    }
+
+    for (const char* name : { "UNUSED", "UNUSED_B" }) {
+        CHECK(semas.at(name)->GetRecord()->StatusDecl == air::symbol::Record::State::NOT_ANALYZED);
+        CHECK(semas.at(name)->GetRecord()->StatusBody == air::symbol::Record::State::NOT_ANALYZED);
+        CHECK(semas.at(name)->GetAir().Inst.empty());
+    }
+
+    CHECK(Project::Collect(manager, mod).Values.at("X") == 2);
+}
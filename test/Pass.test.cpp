@@ -0,0 +1,292 @@
+#include "air/CfgBuilder.h"
+#include "air/Inst.h"
+#include "air/Pool.h"
+#include "air/pass/PassManager.h"
+#include "test.h"
+#include <algorithm>
+
+using namespace air;
+using namespace air::pass;
+
+namespace {
+
+struct Function {
+    Air Code;
+    symbol::Record Rec;
+
+    Function(Pool& pool, std::uint32_t constants)
+    {
+        Code.Inst.emplace_back(NULL_INDEX);
+        Code.Type.emplace_back();
+
+        for (std::uint32_t i = 0; i < constants; i++) {
+            const Index val = pool.GetOrPut(PoolKey::CreateTypeValue(pool::keys::U8_KEY_INDEX, pool.AddValue(i)));
+            Code.Inst.push_back(InstData::CreatePoolIndex(val));
+            Code.Type.push_back(InstType::CONSTANT);
+        }
+
+        // the first constant is the result
+        Rec.AirInst    = 1;
+        Rec.Name       = "fn";
+        Rec.StatusBody = symbol::Record::State::COMPLETE;
+    }
+};
+
+// Removes the unused instructions from the end
+PassResult dropTail(FunctionContext& ctx)
+{
+    Air& air     = *ctx.Unit.Code;
+    bool changed = false;
+
+    while (air.Inst.size() > 1 && ctx.Analyses.GetUses(ctx.Unit.Rec->AirInst).at(air.Inst.size() - 1) == 0) {
+        air.Inst.pop_back();
+        air.Type.pop_back();
+        changed = true;
+    }
+
+    return changed ? PassResult::Modified() : PassResult::Unchanged();
+}
+
+PassResult queryTypes(FunctionContext& ctx)
+{
+    CHECK_EQ(ctx.Analyses.GetTypes().size(), ctx.Unit.Code->Inst.size());
+    ctx.Analyses.GetUses(ctx.Unit.Rec->AirInst);
+    return PassResult::Unchanged();
+}
+
+std::uint32_t g_moduleRuns = 0;
+
+PassResult countUnits(ModuleContext& ctx)
+{
+    g_moduleRuns += static_cast<std::uint32_t>(ctx.Units.size());
+    return PassResult::Unchanged();
+}
+
+Index addInst(Air& air, InstType type, InstData data)
+{
+    air.Inst.push_back(data);
+    air.Type.push_back(type);
+    return static_cast<Index>(air.Inst.size() - 1);
+}
+
+Index addConstant(Air& air, Pool& pool, Index ty, std::uint64_t value)
+{
+    // new pool index for every constant
+    const Index val = pool.GetOrPut(PoolKey::CreateTypeValue(ty, pool.AddValue(value)));
+    return addInst(air, InstType::CONSTANT, InstData::CreatePoolIndex(val));
+}
+
+constexpr PassInfo QUERY_TYPES = { .Name = "query-types", .Function = queryTypes };
+constexpr PassInfo DROP_TAIL   = { .Name = "drop-tail", .Function = dropTail };
+constexpr PassInfo COUNT_UNITS = { .Name = "count-units", .Module = countUnits };
+
+}
+
+TEST_CASE("Pass - Registry")
+{
+    CHECK_NE(PassManager::FindPass("verify"), nullptr);
+    CHECK_EQ(PassManager::FindPass("unknown"), nullptr);
+
+    for (const auto level : { OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::OS }) {
+        for (const auto* pass : PassManager::GetPipeline(level)) {
+            CHECK_NE(pass, nullptr);
+        }
+    }
+}
+
+TEST_CASE("Pass - Optimization levels")
+{
+    const auto names = [](OptLevel level) {
+        std::vector<std::string_view> result;
+        for (const auto* pass : PassManager::GetPipeline(level)) {
+            result.push_back(pass->Name);
+        }
+        return result;
+    };
+
+    const auto o0 = names(OptLevel::O0);
+    const auto o1 = names(OptLevel::O1);
+    const auto o2 = names(OptLevel::O2);
+    const auto os = names(OptLevel::OS);
+
+    // the cheap passes shrink the AIR even without the optimizations
+    CHECK_NE(std::find(o0.begin(), o0.end(), "canonicalize"), o0.end());
+    CHECK_NE(std::find(o0.begin(), o0.end(), "dce"), o0.end());
+
+    // every level has its own pipeline
+    CHECK_NE(o0, o1);
+    CHECK_NE(o1, o2);
+    CHECK_NE(o2, os);
+    CHECK_NE(o1, os);
+
+    // every level runs the passes of the cheaper one
+    for (const auto name : o0) {
+        CHECK_NE(std::find(o1.begin(), o1.end(), name), o1.end());
+    }
+    for (const auto name : o1) {
+        CHECK_NE(std::find(o2.begin(), o2.end(), name), o2.end());
+    }
+    CHECK(std::equal(o2.begin(), o2.end(), os.begin(), os.begin() + static_cast<std::ptrdiff_t>(o2.size())));
+    CHECK_EQ(std::find(o0.begin(), o0.end(), "gvn"), o0.end());
+    CHECK_GT(std::count(o2.begin(), o2.end(), "gvn"), std::count(o1.begin(), o1.end(), "gvn"));
+}
+
+TEST_CASE("Pass - Pipeline")
+{
+    Pool pool;
+    Function fnA(pool, 4);
+    Function fnB(pool, 1);
+
+    std::vector<FunctionUnit> units = {
+        { &fnA.Code, &fnA.Rec },
+        { &fnB.Code, &fnB.Rec },
+    };
+
+    PassManager manager(pool, units, { &QUERY_TYPES, &DROP_TAIL, &COUNT_UNITS, &QUERY_TYPES });
+    manager.Run();
+
+    CHECK_EQ(instCount(fnA.Code), 1);
+    CHECK_EQ(instCount(fnB.Code), 1);
+    CHECK_EQ(g_moduleRuns, 2);
+
+    const auto& stats = manager.GetStats();
+    REQUIRE_EQ(stats.size(), 4);
+
+    CHECK_EQ(stats[1].Runs, 2);
+    CHECK_EQ(stats[1].Changed, 1);
+    CHECK_EQ(stats[1].InstBefore, 5);
+    CHECK_EQ(stats[1].InstAfter, 2);
+
+    // types and uses of both functions and again of 'fnA' after the change, the module pass doesn't change anything
+    // so the cache of 'fnB' is reused
+    CHECK_EQ(manager.GetAnalysesComputed(), 6);
+}
+
+TEST_CASE("Pass - Optimizations")
+{
+    Pool pool;
+    const Index u8  = pool::keys::U8_KEY_INDEX;
+    const Index u16 = pool::keys::U16_KEY_INDEX;
+
+    // a + b and b + a of the equal constants with different pool indices
+    Function fnA(pool, 0);
+    const Index a = addConstant(fnA.Code, pool, u8, 3);
+    const Index b = addConstant(fnA.Code, pool, u8, 3);
+    addConstant(fnA.Code, pool, u8, 7);
+    const Index sumAB = addInst(fnA.Code, InstType::ADD, InstData::CreateBinOp(a, b));
+    const Index sumBA = addInst(fnA.Code, InstType::ADD, InstData::CreateBinOp(b, a));
+    addInst(fnA.Code, InstType::CAST, InstData::CreateTyOp(u16, a));
+    fnA.Rec.AirInst = addInst(fnA.Code, InstType::MUL, InstData::CreateBinOp(sumBA, sumAB));
+
+    // casts of the equal constants
+    Function fnB(pool, 0);
+    const Index c     = addConstant(fnB.Code, pool, u8, 300);
+    const Index d     = addConstant(fnB.Code, pool, u8, 300);
+    const Index castC = addInst(fnB.Code, InstType::CAST, InstData::CreateTyOp(u16, c));
+    const Index castD = addInst(fnB.Code, InstType::CAST, InstData::CreateTyOp(u16, d));
+    fnB.Rec.AirInst   = addInst(fnB.Code, InstType::ADD, InstData::CreateBinOp(castD, castC));
+
+    std::vector<FunctionUnit> units = {
+        { &fnA.Code, &fnA.Rec },
+        { &fnB.Code, &fnB.Rec },
+    };
+
+    PassManager manager(pool, units, PassManager::GetPipeline(OptLevel::O2));
+    manager.Run();
+
+    // constant, add and mul
+    REQUIRE_EQ(instCount(fnA.Code), 3);
+    CHECK_EQ(fnA.Code.Type[1], InstType::CONSTANT);
+    CHECK_EQ(fnA.Code.Type[2], InstType::ADD);
+    CHECK_EQ(fnA.Code.Inst[2].BinOp.Lhs, 1);
+    CHECK_EQ(fnA.Code.Inst[2].BinOp.Rhs, 1);
+    CHECK_EQ(fnA.Rec.AirInst, 3);
+    CHECK_EQ(fnA.Code.Inst[3].BinOp.Lhs, 2);
+    CHECK_EQ(fnA.Code.Inst[3].BinOp.Rhs, 2);
+
+    // the folded constant keeps the value of the source, the u8 constants are removed
+    REQUIRE_EQ(instCount(fnB.Code), 2);
+    CHECK_EQ(fnB.Code.Type[1], InstType::CONSTANT);
+    const auto folded = pool.GetTypeValue(fnB.Code.Inst[1].Data);
+    CHECK_EQ(folded.Ty, u16);
+    CHECK_EQ(pool.Values.at(folded.Val), 300);
+    CHECK_EQ(fnB.Rec.AirInst, 2);
+    CHECK_EQ(fnB.Code.Inst[2].BinOp.Lhs, 1);
+    CHECK_EQ(fnB.Code.Inst[2].BinOp.Rhs, 1);
+}
+
+TEST_CASE("Pass - Cfg")
+{
+    Pool pool;
+    Air air;
+    CfgBuilder builder(air);
+
+    const Index u8 = pool::keys::U8_KEY_INDEX;
+
+    // b0 -> b1 (outer loop) -> b2 (inner loop) -> b3 -> b1, b1 -> b4
+    const Index entry = builder.CreateBlock();
+    const Index outer = builder.CreateBlock();
+    const Index inner = builder.CreateBlock();
+    const Index latch = builder.CreateBlock();
+    const Index exit  = builder.CreateBlock();
+
+    builder.Begin(entry);
+    const Index zero = builder.Add(InstType::CONSTANT, pool.GetOrPut(PoolKey::CreateTypeValue(u8, pool.AddValue(0))));
+    const Index zeroArgs[] = { zero };
+    builder.Br(outer, zeroArgs);
+
+    builder.Begin(outer);
+    const Index counter = builder.AddParam(u8);
+    builder.CondBr(counter, inner, {}, exit, {});
+
+    builder.Begin(inner);
+    const Index next = builder.Add(InstType::ADD, InstData::CreateBinOp(counter, zero));
+    builder.CondBr(next, inner, {}, latch, {});
+
+    builder.Begin(latch);
+    const Index nextArgs[] = { next };
+    builder.Br(outer, nextArgs);
+
+    builder.Begin(exit);
+    builder.Ret(counter);
+    builder.Finish();
+
+    CHECK_EQ(air.Blocks.BlocksCount(), 5);
+    CHECK_EQ(paramsCount(air, outer), 1);
+    CHECK_EQ(air.Blocks.GetBlock(next), inner);
+    CHECK_EQ(air.Blocks.GetArgs(air.Blocks.GetFirstEdge(latch))[0], next);
+
+    SharedPool shared(pool);
+    AnalysisCache cache(air, shared);
+
+    const auto& preds = cache.GetPredecessors();
+    CHECK_EQ(preds.Get(outer).size(), 2);
+    CHECK_EQ(preds.Get(inner).size(), 2);
+
+    const auto& dom = cache.GetDominators();
+    CHECK_EQ(dom.Idom[entry], MAX_INDEX);
+    CHECK_EQ(dom.Idom[outer], entry);
+    CHECK_EQ(dom.Idom[inner], outer);
+    CHECK_EQ(dom.Idom[latch], inner);
+    CHECK_EQ(dom.Idom[exit], outer);
+    CHECK(dom.Dominates(outer, latch));
+    CHECK_FALSE(dom.Dominates(inner, exit));
+
+    const auto& loops = cache.GetLoops();
+    REQUIRE_EQ(loops.LoopsCount(), 2);
+    CHECK_EQ(loops.Header[0], outer);
+    CHECK_EQ(loops.Header[1], inner);
+    CHECK_EQ(loops.Parent[1], 0);
+    CHECK_EQ(loops.GetBlockDepth(entry), 0);
+    CHECK_EQ(loops.GetBlockDepth(latch), 1);
+    CHECK_EQ(loops.GetBlockDepth(inner), 2);
+    CHECK_EQ(loops.GetBlockDepth(exit), 0);
+
+    // cached
+    cache.GetLoops();
+    CHECK_EQ(cache.GetComputedCount(), 3);
+
+    const auto& uses = cache.GetUses(NULL_INDEX);
+    CHECK_EQ(uses[counter], 3);
+    CHECK_EQ(uses[next], 2);
+}
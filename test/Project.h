@@ -0,0 +1,136 @@
+#ifndef KOOLANG_TEST_PROJECT_H
+#define KOOLANG_TEST_PROJECT_H
+
+#include "air/Module.h"
+#include "air/ModuleInterface.h"
+#include "air/ModuleManager.h"
+#include "doctest.h"
+#include "query/Database.h"
+#include "terminal/globals.h"
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace test {
+
+// Sources in a temporary directory built as a library, so every pub decl of the entry is analyzed
+class Project {
+public:
+    explicit Project(const std::string& name)
+        : m_dir(std::filesystem::temp_directory_path() / name)
+    {
+        std::filesystem::remove_all(m_dir);
+        std::filesystem::create_directories(m_dir);
+    }
+
+    ~Project() { std::filesystem::remove_all(m_dir); }
+
+    [[nodiscard]] const std::filesystem::path& GetDir() const { return m_dir; }
+
+    void Write(const std::string& filename, const std::string& content) const
+    {
+        std::filesystem::create_directories((m_dir / filename).parent_path());
+        std::ofstream(m_dir / filename) << content;
+    }
+
+    struct Result {
+        std::size_t Restored;
+        std::size_t Errors;
+        // imports of 'main.k' loaded from their interfaces
+        std::size_t Interfaces;
+        // values of the pub decls of 'main.k'
+        std::unordered_map<std::string, std::uint64_t> Values;
+        // every loaded module
+        std::size_t Modules;
+        // names of the decls of all modules which were analyzed
+        std::unordered_set<std::string> Analyzed;
+    };
+
+    // The database of the long-running modes is shared by the builds
+    [[nodiscard]] Result Build(bool noCache = false, query::Database* database = nullptr) const
+    {
+        Configure("main.k", noCache);
+
+        air::ModuleManager manager(database);
+        air::Module* mod = manager.GenZir();
+        REQUIRE(mod->CompStatus != air::Module::Status::ERROR);
+        manager.GenAir(mod);
+
+        return Collect(manager, mod);
+    }
+
+    // Reads the result of the analyzed entry module
+    [[nodiscard]] static Result Collect(air::ModuleManager& manager, air::Module* mod)
+    {
+        Result result {
+            .Restored   = manager.GetRestoredDecls(),
+            .Errors     = logger::g_errorCount,
+            .Interfaces = 0,
+            .Values     = {},
+            .Modules    = manager.GetModules().size(),
+            .Analyzed   = {},
+        };
+
+        for (const auto& loaded : manager.GetModules()) {
+            for (const auto& sema : loaded->Semas) {
+                if (sema.GetRecord()->StatusDecl != air::symbol::Record::State::NOT_ANALYZED) {
+                    result.Analyzed.insert(std::string(sema.GetRecord()->Name));
+                }
+            }
+        }
+
+        for (const air::Module* importMod : mod->Imports) {
+            result.Interfaces += static_cast<std::size_t>(importMod->CompStatus == air::Module::Status::INTERFACE);
+        }
+
+        for (const auto& [name, rec] : mod->Map.GetNamespace(mod->NamespaceIndex).Decls) {
+            if (rec->IsPub != ast::Vis::GLOBAL || rec->Mod != mod || isNull(rec->Val)) {
+                continue;
+            }
+
+            const auto tyVal = manager.InternPool.GetTypeValue(rec->Val);
+            if (!isNull(tyVal.Ty)) {
+                result.Values[std::string(name)] = manager.InternPool.Values.at(tyVal.Val);
+            }
+        }
+
+        return result;
+    }
+
+    // Builds the library and writes its '.kmi' like the 'build lib' command
+    [[nodiscard]] bool BuildInterface(const std::string& entry) const
+    {
+        Configure(entry, false);
+
+        air::ModuleManager manager;
+        air::Module* mod = manager.GenZir();
+        REQUIRE(mod->CompStatus != air::Module::Status::ERROR);
+        manager.GenAir(mod);
+
+        return logger::g_errorCount == 0 && air::kmi::write(mod, manager.InternPool);
+    }
+
+    // Sets the config of the build like the command line
+    void Configure(const std::string& entry, bool noCache) const
+    {
+        using globals::Config;
+
+        const auto flags = noCache ? (globals::g_config.Flags | Config::NO_CACHE)
+                                   : (globals::g_config.Flags & ~Config::NO_CACHE);
+
+        globals::g_config.Flags      = static_cast<Config::Options>(flags);
+        globals::g_config.Command    = Config::Command::BUILD_LIB;
+        globals::g_config.InputFile  = (m_dir / entry).string();
+        globals::g_config.WorkingDir = m_dir;
+        globals::g_config.CacheDir   = m_dir / ".koolang-cache";
+        logger::g_errorCount         = 0;
+    }
+
+private:
+    std::filesystem::path m_dir;
+};
+
+}
+
+#endif
@@ -0,0 +1,372 @@
+#include "query/Database.h"
+#include "query/Engine.h"
+#include "terminal/globals.h"
+#include "test.h"
+#include "util/debug.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+using namespace query;
+
+namespace {
+
+std::uint64_t identity(const int& value) { return static_cast<std::uint64_t>(value); }
+
+}
+
+TEST_CASE("Query - Early cutoff")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    int parityRuns = 0;
+    int labelRuns  = 0;
+
+    Query<int, int> parity(
+        engine,
+        [&](const int& key) {
+            parityRuns++;
+            return *input.Get(key) % 2;
+        },
+        identity
+    );
+    Query<int, int> label(
+        engine,
+        [&](const int& key) {
+            labelRuns++;
+            return *parity.Get(key) * 10;
+        },
+        identity
+    );
+
+    input.Set(1, 3);
+    CHECK(*label.Get(1) == 10);
+    CHECK(parityRuns == 1);
+    CHECK(labelRuns == 1);
+
+    // nothing changed
+    engine.NewRevision();
+    CHECK(*label.Get(1) == 10);
+    CHECK(parityRuns == 1);
+    CHECK(labelRuns == 1);
+    CHECK(label.GetStats().Reused == 1);
+
+    // the parity keeps its value, so the label isn't computed again
+    input.Set(1, 5);
+    CHECK(*label.Get(1) == 10);
+    CHECK(parityRuns == 2);
+    CHECK(labelRuns == 1);
+
+    input.Set(1, 6);
+    CHECK(*label.Get(1) == 0);
+    CHECK(parityRuns == 3);
+    CHECK(labelRuns == 2);
+
+    // the other keys are independent
+    input.Set(2, 1);
+    CHECK(*label.Get(2) == 10);
+    CHECK(*label.Get(1) == 0);
+    CHECK(labelRuns == 3);
+}
+
+TEST_CASE("Query - Volatile queries")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    int runs = 0;
+    Query<int, int> reported(
+        engine,
+        [&](const int& key) {
+            runs++;
+            markVolatile();
+            return *input.Get(key);
+        },
+        identity
+    );
+    Query<int, int> reader(engine, [&](const int& key) { return *reported.Get(key); }, identity);
+
+    input.Set(0, 1);
+    CHECK(*reader.Get(0) == 1);
+    CHECK(*reader.Get(0) == 1);
+    CHECK(runs == 1);
+
+    // computed again although the input is the same
+    engine.NewRevision();
+    CHECK(*reader.Get(0) == 1);
+    CHECK(runs == 2);
+    CHECK(reader.GetStats().Computed == 2);
+}
+
+TEST_CASE("Query - Cycles")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    // the keys read each other, the second read of the first key closes the cycle
+    Query<int, int>* self = nullptr;
+    Query<int, int> mutual(
+        engine,
+        [&](const int& key) {
+            const auto other = self->Get(1 - key);
+            return *input.Get(key) + (isNull(other.get()) ? 0 : *other);
+        },
+        identity
+    );
+    self = &mutual;
+
+    const std::size_t errors = logger::g_errorCount;
+
+    input.Set(0, 1);
+    input.Set(1, 2);
+    CHECK(*mutual.Get(0) == 3);
+    CHECK(mutual.GetStats().Cycles == 1);
+    CHECK(logger::g_errorCount == errors + 1);
+
+    // the readers of the cycle are computed again
+    engine.NewRevision();
+    CHECK(*mutual.Get(0) == 3);
+    CHECK(mutual.GetStats().Cycles == 2);
+
+    logger::g_errorCount = errors;
+}
+
+TEST_CASE("Query - Cycle across queries")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    // the layout reads the size which reads the layout again
+    Query<int, int>* layoutRef = nullptr;
+    bool wasCut                = false;
+    Query<int, int> size(
+        engine,
+        [&](const int& key) {
+            const auto layout = layoutRef->Get(key);
+            wasCut            = isNull(layout.get());
+            return *input.Get(key) + (wasCut ? 0 : *layout);
+        },
+        identity
+    );
+    Query<int, int> layout(engine, [&](const int& key) { return *size.Get(key) * 2; }, identity);
+    layoutRef = &layout;
+
+    const std::size_t errors = logger::g_errorCount;
+
+    // the diagnostic is reported once, the read closing the cycle gets nothing
+    input.Set(0, 4);
+    CHECK(*layout.Get(0) == 8);
+    CHECK(wasCut);
+    CHECK(layout.GetStats().Cycles == 1);
+    CHECK(size.GetStats().Cycles == 0);
+    CHECK(logger::g_errorCount == errors + 1);
+
+    // the size read outside of the cycle is memoized
+    CHECK(*size.Get(0) == 4);
+    CHECK(logger::g_errorCount == errors + 1);
+
+    // the cycle is reported again by the next revision
+    engine.NewRevision();
+    CHECK(*layout.Get(0) == 8);
+    CHECK(layout.GetStats().Cycles == 2);
+    CHECK(logger::g_errorCount == errors + 2);
+
+    logger::g_errorCount = errors;
+}
+
+TEST_CASE("Query - Taken results")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    int runs = 0;
+    Query<int, std::vector<int>> list(
+        engine,
+        [&](const int& key) {
+            runs++;
+            return std::vector<int>(static_cast<std::size_t>(*input.Get(key)), key);
+        },
+        [](const std::vector<int>& value) { return value.size(); }
+    );
+
+    int readerRuns = 0;
+    Query<int, int> reader(
+        engine,
+        [&](const int& key) {
+            readerRuns++;
+            return static_cast<int>(list.Take(key).size());
+        },
+        identity
+    );
+
+    input.Set(0, 3);
+    CHECK(*reader.Get(0) == 3);
+    CHECK(runs == 1);
+
+    // the value was moved to the reader, the next read computes it again
+    auto held = list.Get(0);
+    CHECK(held->size() == 3);
+    CHECK(runs == 2);
+
+    // the holder keeps the value, so it's copied
+    CHECK(list.Take(0).size() == 3);
+    CHECK(held->size() == 3);
+
+    held.reset();
+    CHECK(list.Take(0).size() == 3);
+    CHECK(runs == 2);
+
+    // the taken value doesn't make its readers stale
+    engine.NewRevision();
+    CHECK(*reader.Get(0) == 3);
+    CHECK(readerRuns == 1);
+    CHECK(runs == 2);
+
+    // the value is computed again with the same fingerprint, the reader stays valid
+    CHECK(list.Get(0)->size() == 3);
+    CHECK(runs == 3);
+    CHECK(*reader.Get(0) == 3);
+    CHECK(readerRuns == 1);
+}
+
+TEST_CASE("Query - Parallel queries")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    std::atomic<int> runs = 0;
+    Query<int, int> slow(
+        engine,
+        [&](const int& key) {
+            runs++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return *input.Get(key) + 1;
+        },
+        identity
+    );
+
+    input.Set(0, 41);
+
+    // the threads asking for the running key wait for its result
+    std::vector<std::thread> threads;
+    std::atomic<int> correct = 0;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&]() {
+            if (*slow.Get(0) == 42) {
+                correct++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(runs == 1);
+    CHECK(correct == 8);
+}
+
+TEST_CASE("Query - Front end queries")
+{
+    using globals::Config;
+    globals::g_config.Flags = static_cast<Config::Options>(globals::g_config.Flags | Config::NO_CACHE);
+
+    Database database;
+    const std::string path = "/virtual/main.k";
+
+    const auto build = [&database, &path](const std::string& content) {
+        database.NewRevision();
+
+        File file;
+        file.Filepath = "main.k";
+        file.Content  = content;
+
+        database.SetContent(path, content);
+        const auto unit = database.GetKir(path, file);
+        return std::make_pair(unit->IsValid, file.ErrMsgs.size());
+    };
+
+    CHECK(build("const A : i32 = 1;\n") == std::make_pair(true, std::size_t { 0 }));
+    CHECK(database.GetKirStats().Computed == 1);
+
+    // comments and whitespace keep the tokens
+    CHECK(build("// A\nconst  A : i32 = 1;\n") == std::make_pair(true, std::size_t { 0 }));
+    CHECK(database.GetTokensStats().Computed == 2);
+    CHECK(database.GetKirStats().Computed == 1);
+    CHECK(database.GetKirStats().Reused == 1);
+
+    // the errors are reported by every build
+    CHECK(build("const A : i32 = ;\n").second > 0);
+    CHECK(build("const A : i32 = ;\n").second > 0);
+    CHECK(database.GetKirStats().Computed == 3);
+
+    CHECK(build("const A : i32 = 2;\n") == std::make_pair(true, std::size_t { 0 }));
+    CHECK(build("const A : i32 = 2;\n") == std::make_pair(true, std::size_t { 0 }));
+    CHECK(database.GetKirStats().Computed == 4);
+}
+
+TEST_CASE("Query - Cached KIR messages")
+{
+    using globals::Config;
+    globals::g_config.Flags    = static_cast<Config::Options>(globals::g_config.Flags & ~Config::NO_CACHE);
+    globals::g_config.CacheDir = std::filesystem::temp_directory_path() / "koolang-query-messages";
+    std::filesystem::remove_all(globals::g_config.CacheDir);
+
+    const std::string path = "/virtual/main.k";
+
+    // every database is a new process, the second build reads the KIR from the disk
+    const auto build = [&path](const std::string& content) {
+        Database database;
+        database.NewRevision();
+
+        File file;
+        file.Filepath = "main.k";
+        file.Content  = content;
+
+        database.SetContent(path, content);
+        const auto unit = database.GetKir(path, file);
+        return std::make_pair(unit->IsValid, file.WarnMsgs.size());
+    };
+
+    const auto cold = build("/**/ const A : i32 = 1;\n");
+    CHECK(cold.first);
+    CHECK(cold.second > 0);
+
+    CHECK(std::filesystem::exists(globals::g_config.CacheDir / "kir"));
+    CHECK(build("/**/ const A : i32 = 1;\n") == cold);
+    CHECK(build("/**/\nconst A : i32 = 1;\n") == cold);
+
+    std::filesystem::remove_all(globals::g_config.CacheDir);
+    globals::g_config.Flags = static_cast<Config::Options>(globals::g_config.Flags | Config::NO_CACHE);
+}
+
+TEST_CASE("Query - Forgotten results")
+{
+    Engine engine;
+    Input<int, int> input(engine, identity);
+
+    int runs = 0;
+    Query<int, int> square(
+        engine,
+        [&](const int& key) {
+            runs++;
+            const int value = *input.Get(key);
+            return value * value;
+        },
+        identity
+    );
+
+    input.Set(0, 3);
+    const auto result = square.Get(0);
+    CHECK(*result == 9);
+
+    // the holder keeps the value, the next 'Get' computes it again
+    square.Forget(0);
+    CHECK(*result == 9);
+    CHECK(*square.Get(0) == 9);
+    CHECK(runs == 2);
+
+    input.Forget(0);
+    CHECK(input.Get(0) == nullptr);
+}
@@ -0,0 +1,69 @@
+#include "Project.h"
+#include "test.h"
+#include <pthread.h>
+#include <string>
+
+using test::Project;
+
+namespace {
+
+struct ChainBuild {
+    const Project* Proj;
+    Project::Result Result;
+};
+
+void* buildChain(void* arg)
+{
+    auto* build   = static_cast<ChainBuild*>(arg);
+    build->Result = build->Proj->Build(true);
+    return nullptr;
+}
+
+}
+
+TEST_CASE("Sema - Long dependency chain")
+{
+    constexpr int LENGTH = 20'000;
+
+    // every decl reads the next one, only the first is the root
+    std::string source = "pub const C0 : i32 = C1;\n";
+    for (int i = 1; i < LENGTH - 1; i++) {
+        source += "const C" + std::to_string(i) + " : i32 = C" + std::to_string(i + 1) + ";\n";
+    }
+    source += "const C" + std::to_string(LENGTH - 1) + " : i32 = 7;\n";
+
+    Project project("koolang_sema_long_chain");
+    project.Write("main.k", source);
+
+    // the analysis runs on the thread with the small stack, the recursion through the chain would overflow it
+    ChainBuild build { .Proj = &project, .Result = {} };
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 256 * 1024);
+
+    pthread_t thread;
+    REQUIRE(pthread_create(&thread, &attr, buildChain, &build) == 0);
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+
+    CHECK(build.Result.Errors == 0);
+    CHECK(build.Result.Analyzed.size() == LENGTH);
+    CHECK(build.Result.Values.at("C0") == 7);
+}
+
+TEST_CASE("Sema - Dependency cycle")
+{
+    Project project("koolang_sema_cycle");
+    project.Write("main.k", "pub const X : i32 = A;\nconst A : i32 = B;\nconst B : i32 = B;\npub const Y : i32 = 3;\n");
+
+    // the cycle is reported once, B, A and X fail on the missing value and the analysis ends
+    const auto result = project.Build(true);
+    CHECK(result.Errors == 4);
+    CHECK(result.Analyzed.contains("X"));
+    CHECK(result.Analyzed.contains("B"));
+    CHECK_FALSE(result.Values.contains("X"));
+
+    // the decls outside of the cycle are still analyzed
+    CHECK(result.Values.at("Y") == 3);
+}
@@ -0,0 +1,53 @@
+#include "terminal/globals.h"
+#include "terminal/terminal.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+// The language server needs no input file, so only the option is checked
+bool parseMaxMemory(const std::string& value, std::size_t& maxMemory)
+{
+    std::vector<std::string> args = { "koolang", "lsp", "--max-memory", value };
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(arg.data());
+    }
+
+    globals::Config config;
+    const bool isValid = terminal::parseArgs(static_cast<int>(argv.size()), argv.data(), config);
+
+    maxMemory = config.MaxMemory;
+    return isValid;
+}
+
+}
+
+TEST_CASE("Terminal - Max memory")
+{
+    std::size_t size = 0;
+
+    CHECK(parseMaxMemory("4096", size));
+    CHECK(size == 4096);
+    CHECK(parseMaxMemory("64M", size));
+    CHECK(size == 64ULL << 20);
+    CHECK(parseMaxMemory("2g", size));
+    CHECK(size == 2ULL << 30);
+
+    // the largest values which fit
+    CHECK(parseMaxMemory("18446744073709551615", size));
+    CHECK(size == 18446744073709551615ULL);
+    CHECK(parseMaxMemory("17179869183G", size));
+    CHECK(size == 17179869183ULL << 30);
+
+    // the values which would wrap around
+    CHECK_FALSE(parseMaxMemory("18446744073709551616", size));
+    CHECK_FALSE(parseMaxMemory("99999999999999999999999", size));
+    CHECK_FALSE(parseMaxMemory("17179869184G", size));
+    CHECK_FALSE(parseMaxMemory("18014398509481984K", size));
+
+    CHECK_FALSE(parseMaxMemory("", size));
+    CHECK_FALSE(parseMaxMemory("M", size));
+    CHECK_FALSE(parseMaxMemory("12T", size));
+}
@@ -1,3 +1,4 @@
+#include "ast/ImportScanner.h"
 #include "ast/Tokenizer.h"
 #include "ast/Token.h"
 #include "test.h"
@@ -295,3 +296,37 @@ TEST_CASE("Tokenizer - EatTokAny")
     CHECK_NE(t.EatTokAny<2>({ TokenTag::IDENT, TokenTag::NUMBER_LIT }), NULL_INDEX);
     CHECK_EQ(t.NextTok(), TokenTag::END_OF_FILE);
 }
+
+TEST_CASE("Tokenizer - Hash")
+{
+    const auto hash = [](std::string content) {
+        gTestFile.Content = std::move(content);
+        Tokenizer tk(gTestFile);
+        return tk.Tokenize().Hash;
+    };
+
+    const auto base = hash("const a = 1;");
+
+    CHECK_EQ(hash("const  a =\n1; // comment"), base);
+    CHECK_EQ(hash("/* block */ const a = 1;"), base);
+
+    CHECK_NE(hash("const a = 2;"), base);
+    CHECK_NE(hash("const ab = 1;"), base);
+    CHECK_NE(hash("const a = 1;;"), base);
+    CHECK_NE(hash("/** doc */ const a = 1;"), base);
+}
+
+TEST_CASE("Tokenizer - ImportScanner")
+{
+    const auto scan = [](std::string_view content) { return ast::ImportScanner(content).Scan(); };
+
+    using Paths = std::vector<std::string>;
+
+    CHECK_EQ(scan(""), Paths {});
+    CHECK_EQ(scan("import a;\npub import b::c = d; // comment"), (Paths { "a", "b/c" }));
+    CHECK_EQ(scan("/** doc */ import a::{ b::c = c, d };"), (Paths { "a/b/c", "a/d" }));
+
+    // only the leading imports
+    CHECK_EQ(scan("import a; const A : i32 = 1; import b;"), (Paths { "a" }));
+    CHECK_EQ(scan("import a; import b import c;"), (Paths { "a" }));
+}